@@ -0,0 +1,277 @@
+//-----------------------------------------------------------------
+// Coroutine Scheduler
+// C++ Source - CoroutineScheduler.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "CoroutineScheduler.h"
+#include "LuaProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+extern "C"
+{
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+//-----------------------------------------------------------------
+// CoroutineScheduler Member Functions
+//-----------------------------------------------------------------
+void CoroutineScheduler::Tick(double deltaTime)
+{
+	m_Time += deltaTime;
+	++m_Frame;
+
+	// all due tasks are collected before any runs, a task that waits 0 seconds or 1 frame runs again on the next tick
+	m_DueTasks.swap(m_SpawnedTasks);
+
+	while (!m_TimeHeap.empty() && m_TimeHeap.front().key <= m_Time)
+	{
+		std::pop_heap(m_TimeHeap.begin(), m_TimeHeap.end(), std::greater<>{});
+		m_DueTasks.push_back(m_TimeHeap.back().taskId);
+		m_TimeHeap.pop_back();
+	}
+
+	while (!m_FrameHeap.empty() && m_FrameHeap.front().key <= m_Frame)
+	{
+		std::pop_heap(m_FrameHeap.begin(), m_FrameHeap.end(), std::greater<>{});
+		m_DueTasks.push_back(m_FrameHeap.back().taskId);
+		m_FrameHeap.pop_back();
+	}
+
+	size_t waitingCount{};
+	for (const uint64_t taskId : m_WaitingTasks)
+	{
+		if (IsPredicateTrue(taskId)) m_DueTasks.push_back(taskId);
+		else if (m_Tasks.count(taskId) > 0) m_WaitingTasks[waitingCount++] = taskId;
+	}
+	m_WaitingTasks.resize(waitingCount);
+
+	// cancelled tasks leave their wakeups behind, Resume skips them
+	for (const uint64_t taskId : m_DueTasks) Resume(taskId);
+	m_DueTasks.clear();
+}
+
+bool CoroutineScheduler::Cancel(uint64_t taskId)
+{
+	const auto taskIt = m_Tasks.find(taskId);
+	if (taskIt == m_Tasks.end()) return false;
+
+	// a task that cancels itself runs on until its next wait
+	if (taskId == m_RunningTaskId) taskIt->second.isCancelled = true;
+	else Remove(taskId);
+
+	return true;
+}
+
+void CoroutineScheduler::Resume(uint64_t taskId)
+{
+	const auto taskIt = m_Tasks.find(taskId);
+	if (taskIt == m_Tasks.end()) return;
+
+	lua_State* threadPtr = taskIt->second.threadPtr;
+	const int argCount{ taskIt->second.startArgCount };
+	taskIt->second.startArgCount = 0;
+
+	m_RunningTaskId = taskId;
+	int resultCount{}, status{};
+	{
+		LuaProfiler::ThreadScope threadScope{ m_ProfilerPtr, threadPtr };
+		status = lua_resume(threadPtr, m_LuaStatePtr, argCount, &resultCount);
+	}
+	m_RunningTaskId = 0;
+
+	if (status == LUA_YIELD)
+	{
+		// the wait functions already queued the wakeup
+		lua_pop(threadPtr, resultCount);
+		if (m_Tasks.at(taskId).isCancelled) Remove(taskId);
+		return;
+	}
+
+	if (status != LUA_OK)
+	{
+		const char* messagePtr = lua_tostring(threadPtr, -1);
+		luaL_traceback(m_LuaStatePtr, threadPtr, messagePtr != nullptr ? messagePtr : "(error object is not a string)", 0);
+		ReportError(taskId, lua_tostring(m_LuaStatePtr, -1));
+		lua_pop(m_LuaStatePtr, 1);
+	}
+
+	Remove(taskId);
+}
+
+void CoroutineScheduler::Remove(uint64_t taskId)
+{
+	const auto taskIt = m_Tasks.find(taskId);
+	if (taskIt == m_Tasks.end()) return;
+
+	// the thread is collected with everything its stack still holds
+	luaL_unref(m_LuaStatePtr, LUA_REGISTRYINDEX, taskIt->second.threadRef);
+	luaL_unref(m_LuaStatePtr, LUA_REGISTRYINDEX, taskIt->second.predicateRef);
+	m_Tasks.erase(taskIt);
+}
+
+bool CoroutineScheduler::IsPredicateTrue(uint64_t taskId)
+{
+	const auto taskIt = m_Tasks.find(taskId);
+	if (taskIt == m_Tasks.end()) return false;
+
+	// called on the main state, the task's own thread is suspended
+	lua_rawgeti(m_LuaStatePtr, LUA_REGISTRYINDEX, taskIt->second.predicateRef);
+	if (lua_pcall(m_LuaStatePtr, 0, 1, 0) != LUA_OK)
+	{
+		const char* messagePtr = lua_tostring(m_LuaStatePtr, -1);
+		ReportError(taskId, messagePtr != nullptr ? messagePtr : "(error object is not a string)");
+		lua_pop(m_LuaStatePtr, 1);
+		Remove(taskId);
+		return false;
+	}
+
+	const bool isTrue{ lua_toboolean(m_LuaStatePtr, -1) != 0 };
+	lua_pop(m_LuaStatePtr, 1);
+
+	// the predicate may have cancelled its own task
+	const auto waitingIt = m_Tasks.find(taskId);
+	if (waitingIt == m_Tasks.end()) return false;
+
+	if (isTrue)
+	{
+		luaL_unref(m_LuaStatePtr, LUA_REGISTRYINDEX, waitingIt->second.predicateRef);
+		waitingIt->second.predicateRef = LUA_NOREF;
+	}
+	return isTrue;
+}
+
+void CoroutineScheduler::ReportError(uint64_t taskId, const char* messagePtr) const
+{
+	printf("Lua error in task %llu: %s\n", (unsigned long long)taskId, messagePtr);
+}
+
+CoroutineScheduler* CoroutineScheduler::GetScheduler(lua_State* luaStatePtr)
+{
+	return static_cast<CoroutineScheduler*>(lua_touserdata(luaStatePtr, lua_upvalueindex(1)));
+}
+
+CoroutineScheduler* CoroutineScheduler::GetWaitingScheduler(lua_State* luaStatePtr, const char* functionNamePtr)
+{
+	CoroutineScheduler* schedulerPtr = GetScheduler(luaStatePtr);
+
+	const auto taskIt = schedulerPtr->m_Tasks.find(schedulerPtr->m_RunningTaskId);
+	if (taskIt == schedulerPtr->m_Tasks.end() || taskIt->second.threadPtr != luaStatePtr)
+	{
+		luaL_error(luaStatePtr, "%s can only be called in a task started with Engine.spawn", functionNamePtr);
+	}
+
+	// checked before the wakeup is queued, a failed yield caught by pcall would leave a second one behind
+	if (!lua_isyieldable(luaStatePtr))
+	{
+		luaL_error(luaStatePtr, "%s can not be called from a function the engine calls back, like a waitUntil predicate", functionNamePtr);
+	}
+
+	return schedulerPtr;
+}
+
+int CoroutineScheduler::Spawn(lua_State* luaStatePtr)
+{
+	luaL_checktype(luaStatePtr, 1, LUA_TFUNCTION);
+	CoroutineScheduler* schedulerPtr = GetScheduler(luaStatePtr);
+
+	// the function and the arguments it starts with move to the new thread
+	const int argCount{ lua_gettop(luaStatePtr) };
+	lua_State* threadPtr = lua_newthread(luaStatePtr);
+	lua_sethook(threadPtr, nullptr, 0, 0);		// a new thread copies the hook of its creator, a sample armed there stays with the creator
+	const int threadRef{ luaL_ref(luaStatePtr, LUA_REGISTRYINDEX) };
+	lua_xmove(luaStatePtr, threadPtr, argCount);
+
+	const uint64_t taskId{ schedulerPtr->m_NextTaskId++ };
+	schedulerPtr->m_Tasks.emplace(taskId, Task{ threadPtr, threadRef, LUA_NOREF, argCount - 1 });
+	schedulerPtr->m_SpawnedTasks.push_back(taskId);
+
+	lua_pushinteger(luaStatePtr, (lua_Integer)taskId);
+	return 1;
+}
+
+int CoroutineScheduler::CancelTask(lua_State* luaStatePtr)
+{
+	const uint64_t taskId{ (uint64_t)luaL_checkinteger(luaStatePtr, 1) };
+	lua_pushboolean(luaStatePtr, GetScheduler(luaStatePtr)->Cancel(taskId));
+	return 1;
+}
+
+int CoroutineScheduler::Wait(lua_State* luaStatePtr)
+{
+	// a NaN wake time would break the heap order and stall every later wait, a negative one waits until the next tick
+	const double seconds{ luaL_checknumber(luaStatePtr, 1) };
+	luaL_argcheck(luaStatePtr, std::isfinite(seconds), 1, "seconds must be a finite number");
+	CoroutineScheduler* schedulerPtr = GetWaitingScheduler(luaStatePtr, "wait");
+
+	schedulerPtr->m_TimeHeap.push_back(Wakeup<double>{ schedulerPtr->m_Time + std::max(seconds, 0.0), schedulerPtr->m_NextOrder++, schedulerPtr->m_RunningTaskId });
+	std::push_heap(schedulerPtr->m_TimeHeap.begin(), schedulerPtr->m_TimeHeap.end(), std::greater<>{});
+
+	return lua_yield(luaStatePtr, 0);
+}
+
+int CoroutineScheduler::WaitFrames(lua_State* luaStatePtr)
+{
+	const lua_Integer frameCount{ luaL_optinteger(luaStatePtr, 1, 1) };
+	CoroutineScheduler* schedulerPtr = GetWaitingScheduler(luaStatePtr, "waitFrames");
+
+	// at least until the next tick
+	const uint64_t wakeFrame{ schedulerPtr->m_Frame + (frameCount > 1 ? (uint64_t)frameCount : 1) };
+	schedulerPtr->m_FrameHeap.push_back(Wakeup<uint64_t>{ wakeFrame, schedulerPtr->m_NextOrder++, schedulerPtr->m_RunningTaskId });
+	std::push_heap(schedulerPtr->m_FrameHeap.begin(), schedulerPtr->m_FrameHeap.end(), std::greater<>{});
+
+	return lua_yield(luaStatePtr, 0);
+}
+
+int CoroutineScheduler::WaitUntil(lua_State* luaStatePtr)
+{
+	luaL_checktype(luaStatePtr, 1, LUA_TFUNCTION);
+	CoroutineScheduler* schedulerPtr = GetWaitingScheduler(luaStatePtr, "waitUntil");
+
+	// no need to sleep when it already holds
+	lua_pushvalue(luaStatePtr, 1);
+	lua_call(luaStatePtr, 0, 1);
+	const bool isTrue{ lua_toboolean(luaStatePtr, -1) != 0 };
+	lua_pop(luaStatePtr, 1);
+	if (isTrue) return 0;
+
+	lua_pushvalue(luaStatePtr, 1);
+	schedulerPtr->m_Tasks.at(schedulerPtr->m_RunningTaskId).predicateRef = luaL_ref(luaStatePtr, LUA_REGISTRYINDEX);
+	schedulerPtr->m_WaitingTasks.push_back(schedulerPtr->m_RunningTaskId);
+
+	return lua_yield(luaStatePtr, 0);
+}
+
+void CoroutineScheduler::CreateBindings(lua_State* luaStatePtr, CoroutineScheduler* schedulerPtr)
+{
+	// every function gets the scheduler as its upvalue
+	const luaL_Reg engineFunctions[]
+	{
+		{ "spawn", &CoroutineScheduler::Spawn },
+		{ "cancel", &CoroutineScheduler::CancelTask },
+		{ nullptr, nullptr }
+	};
+	luaL_newlibtable(luaStatePtr, engineFunctions);
+	lua_pushlightuserdata(luaStatePtr, schedulerPtr);
+	luaL_setfuncs(luaStatePtr, engineFunctions, 1);
+	lua_setglobal(luaStatePtr, "Engine");
+
+	const luaL_Reg waitFunctions[]
+	{
+		{ "wait", &CoroutineScheduler::Wait },
+		{ "waitFrames", &CoroutineScheduler::WaitFrames },
+		{ "waitUntil", &CoroutineScheduler::WaitUntil },
+		{ nullptr, nullptr }
+	};
+	lua_pushglobaltable(luaStatePtr);
+	lua_pushlightuserdata(luaStatePtr, schedulerPtr);
+	luaL_setfuncs(luaStatePtr, waitFunctions, 1);
+	lua_pop(luaStatePtr, 1);
+}
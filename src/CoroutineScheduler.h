@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------
+// Coroutine Scheduler
+// C++ Header - CoroutineScheduler.h - version v8_01
+//
+// Runs Lua functions as coroutines that can sleep: Engine.spawn(fn)
+// starts one, and inside it wait(seconds), waitFrames(n) and
+// waitUntil(predicate) suspend it. Sleeping tasks sit in two min-heaps
+// keyed by wake time and wake frame, so a tick only looks at the tasks
+// that are due. Only tasks in waitUntil are checked every tick.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+struct lua_State;
+class LuaProfiler;
+
+//-----------------------------------------------------------------
+// CoroutineScheduler Class
+//-----------------------------------------------------------------
+class CoroutineScheduler final
+{
+public:
+	// Constructor(s) and destructor
+	// The profiler, when there is one, samples the tasks while they run
+	explicit CoroutineScheduler(lua_State* luaStatePtr, LuaProfiler* profilerPtr = nullptr) : m_LuaStatePtr{ luaStatePtr }, m_ProfilerPtr{ profilerPtr } {}
+	~CoroutineScheduler() = default;
+
+	// Disabling copy/move constructors and assignment operators, the Lua functions point to the scheduler
+	CoroutineScheduler(const CoroutineScheduler& other)					= delete;
+	CoroutineScheduler(CoroutineScheduler&& other) noexcept				= delete;
+	CoroutineScheduler& operator=(const CoroutineScheduler& other)		= delete;
+	CoroutineScheduler& operator=(CoroutineScheduler&& other) noexcept	= delete;
+
+	// General Member Functions
+	void		Tick			(double deltaTime);		// seconds of game time since the previous tick
+	bool		Cancel			(uint64_t taskId);		// false when the task already ended
+	size_t		GetTaskCount	()		const	{ return m_Tasks.size(); }
+	double		GetTime			()		const	{ return m_Time; }
+
+	// Engine.spawn, Engine.cancel and the global wait, waitFrames and waitUntil
+	static void	CreateBindings	(lua_State* luaStatePtr, CoroutineScheduler* schedulerPtr);
+
+private:
+	struct Task
+	{
+		lua_State*	threadPtr		{};
+		int			threadRef		{};		// keeps the thread from being collected
+		int			predicateRef	{};		// the function of waitUntil
+		int			startArgCount	{};		// arguments of spawn waiting on the thread's stack
+		bool		isCancelled		{};
+	};
+
+	// Ties wake in the order they started waiting
+	template <typename Key>
+	struct Wakeup
+	{
+		Key			key			{};
+		uint64_t	order		{};
+		uint64_t	taskId		{};
+
+		bool operator>(const Wakeup& other) const { return key != other.key ? key > other.key : order > other.order; }
+	};
+
+	// Private Member Functions
+	void		Resume			(uint64_t taskId);
+	void		Remove			(uint64_t taskId);
+	bool		IsPredicateTrue	(uint64_t taskId);
+	void		ReportError		(uint64_t taskId, const char* messagePtr)	const;
+
+	static CoroutineScheduler*	GetScheduler		(lua_State* luaStatePtr);
+	static CoroutineScheduler*	GetWaitingScheduler	(lua_State* luaStatePtr, const char* functionNamePtr);
+	static int	Spawn			(lua_State* luaStatePtr);
+	static int	CancelTask		(lua_State* luaStatePtr);
+	static int	Wait			(lua_State* luaStatePtr);
+	static int	WaitFrames		(lua_State* luaStatePtr);
+	static int	WaitUntil		(lua_State* luaStatePtr);
+
+	// Member Variables
+	lua_State*									m_LuaStatePtr		{};
+	LuaProfiler*								m_ProfilerPtr		{};
+	std::unordered_map<uint64_t, Task>			m_Tasks				{};
+	uint64_t									m_NextTaskId		{ 1 };
+	uint64_t									m_RunningTaskId		{};
+
+	double										m_Time				{};
+	uint64_t									m_Frame				{};
+	uint64_t									m_NextOrder			{};
+
+	std::vector<Wakeup<double>>					m_TimeHeap			{};
+	std::vector<Wakeup<uint64_t>>				m_FrameHeap			{};
+	std::vector<uint64_t>						m_WaitingTasks		{};		// in waitUntil
+	std::vector<uint64_t>						m_SpawnedTasks		{};		// start on the next tick
+	std::vector<uint64_t>						m_DueTasks			{};
+};
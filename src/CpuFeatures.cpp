@@ -0,0 +1,57 @@
+//-----------------------------------------------------------------
+// CPU Feature Detection
+// C++ Source - CpuFeatures.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "CpuFeatures.h"
+
+#if defined(CPU_FEATURES_X86) && defined(_MSC_VER)
+	#include <intrin.h>
+	#include <immintrin.h>
+#endif
+
+//-----------------------------------------------------------------
+// CpuFeatures Member Functions
+//-----------------------------------------------------------------
+bool CpuFeatures::HasSSE2()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+	return true;	// part of the x64 baseline
+#elif defined(CPU_FEATURES_X86) && defined(_MSC_VER)
+	int info[4]{};
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#elif defined(CPU_FEATURES_X86)
+	return __builtin_cpu_supports("sse2");
+#else
+	return false;
+#endif
+}
+
+bool CpuFeatures::HasAVX2()
+{
+#if defined(CPU_FEATURES_X86) && defined(_MSC_VER)
+	static const bool hasAVX2 = []
+	{
+		int info[4]{};
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		// OSXSAVE and AVX, then the OS has to have enabled the XMM and YMM state
+		__cpuid(info, 1);
+		const bool osSavesYmm{ (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6 };
+		if (!osSavesYmm) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}();
+	return hasAVX2;
+#elif defined(CPU_FEATURES_X86)
+	return __builtin_cpu_supports("avx2");
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,31 @@
+//-----------------------------------------------------------------
+// CPU Feature Detection
+// C++ Header - CpuFeatures.h - version v8_01
+//
+// Runtime checks for the instruction sets the vectorized kernels use
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Instruction set defines
+//-----------------------------------------------------------------
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+	#define CPU_FEATURES_X86
+#endif
+
+// MSVC compiles AVX2 intrinsics anywhere, GCC and Clang need the target on the function
+#if defined(CPU_FEATURES_X86) && (defined(__GNUC__) || defined(__clang__))
+	#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+	#define TARGET_AVX2
+#endif
+
+//-----------------------------------------------------------------
+// CpuFeatures Class
+//-----------------------------------------------------------------
+class CpuFeatures final
+{
+public:
+	static bool HasSSE2	();
+	static bool HasAVX2	();		// also checks that the OS saves the AVX registers
+};
@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------
+// Draw Command Buffer
+// C++ Source - DrawCommandBuffer.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "DrawCommandBuffer.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------
+// DrawCommandBuffer Member Functions
+//-----------------------------------------------------------------
+void DrawCommandBuffer::Clear()
+{
+	m_Commands.clear();
+	m_Sorted.clear();
+	m_Batches.clear();
+	m_BatchBounds.clear();
+	m_BatchOf.clear();
+}
+
+void DrawCommandBuffer::Sort()
+{
+	m_Batches.clear();
+	m_BatchBounds.clear();
+	m_BatchOf.resize(m_Commands.size());
+
+	// A command joins an earlier batch with the same type and color only if it does not overlap
+	// anything drawn in between, so the grouped frame produces exactly the same pixels as the recorded one
+	for (size_t index{}; index < m_Commands.size(); ++index)
+	{
+		const DrawCommand& command = m_Commands[index];
+		const Bounds bounds = GetBounds(command);
+
+		int target{ -1 };
+		const int last{ (int)m_Batches.size() - 1 };
+		for (int batchIndex{ last }; batchIndex >= 0 && batchIndex > last - MAX_LOOKBACK; --batchIndex)
+		{
+			const DrawBatch& batch = m_Batches[batchIndex];
+			if (batch.type == command.type && batch.color == command.color && batch.opacity == command.opacity)
+			{
+				target = batchIndex;
+				break;
+			}
+
+			if (Intersects(bounds, m_BatchBounds[batchIndex])) break;
+		}
+
+		if (target == -1)
+		{
+			m_Batches.push_back(DrawBatch{ command.type, command.opacity, command.color, 0, 0 });
+			m_BatchBounds.push_back(bounds);
+			target = (int)m_Batches.size() - 1;
+		}
+		else
+		{
+			Bounds& batchBounds = m_BatchBounds[target];
+			batchBounds.left	= std::min(batchBounds.left,	bounds.left);
+			batchBounds.top		= std::min(batchBounds.top,		bounds.top);
+			batchBounds.right	= std::max(batchBounds.right,	bounds.right);
+			batchBounds.bottom	= std::max(batchBounds.bottom,	bounds.bottom);
+		}
+
+		++m_Batches[target].count;
+		m_BatchOf[index] = (uint32_t)target;
+	}
+
+	// lay the batches out back to back, the count is rebuilt while copying
+	uint32_t offset{};
+	for (DrawBatch& batch : m_Batches)
+	{
+		batch.first = offset;
+		offset += batch.count;
+		batch.count = 0;
+	}
+
+	m_Sorted.resize(m_Commands.size());
+	for (size_t index{}; index < m_Commands.size(); ++index)
+	{
+		DrawBatch& batch = m_Batches[m_BatchOf[index]];
+		m_Sorted[batch.first + batch.count++] = m_Commands[index];
+	}
+}
+
+DrawCommandBuffer::Bounds DrawCommandBuffer::GetBounds(const DrawCommand& command)
+{
+	Bounds bounds{	std::min(command.left, command.right),	std::min(command.top, command.bottom),
+					std::max(command.left, command.right),	std::max(command.top, command.bottom) };
+
+	// the extent of a text is not known without a DC, it keeps its place among everything else
+	if (command.type == DrawCommandType::Text) return Bounds{ INT32_MIN, INT32_MIN, INT32_MAX, INT32_MAX };
+
+	// a line touches both of its end points
+	if (command.type == DrawCommandType::Line)
+	{
+		++bounds.right;
+		++bounds.bottom;
+	}
+
+	return bounds;
+}
+
+bool DrawCommandBuffer::Intersects(const Bounds& first, const Bounds& second)
+{
+	return first.left < second.right && second.left < first.right && first.top < second.bottom && second.top < first.bottom;
+}
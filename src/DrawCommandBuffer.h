@@ -0,0 +1,97 @@
+//-----------------------------------------------------------------
+// Draw Command Buffer
+// C++ Header - DrawCommandBuffer.h - version v8_01
+//
+// Retained list of draw calls for one frame. The engine records into
+// it while painting and submits the whole frame in one pass, grouped
+// into batches that share their type and color.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Draw Command Types
+//-----------------------------------------------------------------
+enum class DrawCommandType : uint8_t
+{
+	Line, Rect, FillRect, RoundRect, FillRoundRect, Oval, FillOval, Arc, FillArc,
+	Text, Bitmap		// only recorded into frame snapshots, param1 indexes the snapshot's texts or bitmaps
+};
+
+// Plain data so a frame is one contiguous array, param1/param2 hold the radius or the start degree and angle
+struct DrawCommand
+{
+	DrawCommandType	type		{};
+	uint8_t			opacity		{ 255 };
+	uint32_t		color		{};			// COLORREF layout
+	int32_t			left		{};
+	int32_t			top			{};
+	int32_t			right		{};
+	int32_t			bottom		{};
+	int32_t			param1		{};
+	int32_t			param2		{};
+};
+
+// A run of commands in the sorted array that can be submitted with a single color state
+struct DrawBatch
+{
+	DrawCommandType	type		{};
+	uint8_t			opacity		{ 255 };
+	uint32_t		color		{};
+	uint32_t		first		{};
+	uint32_t		count		{};
+};
+
+//-----------------------------------------------------------------
+// DrawCommandBuffer Class
+//-----------------------------------------------------------------
+class DrawCommandBuffer final
+{
+public:
+	// Constructor(s) and destructor
+	DrawCommandBuffer()		= default;
+	~DrawCommandBuffer()	= default;
+
+	// Disabling copy/move constructors and assignment operators
+	DrawCommandBuffer(const DrawCommandBuffer& other)					= delete;
+	DrawCommandBuffer(DrawCommandBuffer&& other) noexcept				= delete;
+	DrawCommandBuffer& operator=(const DrawCommandBuffer& other)		= delete;
+	DrawCommandBuffer& operator=(DrawCommandBuffer&& other) noexcept	= delete;
+
+	// General Member Functions
+	void		Add				(const DrawCommand& command)	{ m_Commands.push_back(command); }
+	void		Clear			();								// keeps the capacity for the next frame
+	void		Sort			();								// groups the recorded commands into batches
+
+	bool		IsEmpty			()						const	{ return m_Commands.empty(); }
+	size_t		GetCommandCount	()						const	{ return m_Commands.size(); }
+
+	const std::vector<DrawBatch>&	GetBatches	()		const	{ return m_Batches; }
+	const DrawCommand*				GetSorted	()		const	{ return m_Sorted.data(); }
+
+private:
+	// Bounding box of the pixels a command can touch, right and bottom are exclusive
+	struct Bounds
+	{
+		int32_t left{}, top{}, right{}, bottom{};
+	};
+
+	static Bounds	GetBounds		(const DrawCommand& command);
+	static bool		Intersects		(const Bounds& first, const Bounds& second);
+
+	// How many batches a command may move back over, keeps Sort linear in the command count
+	static const int MAX_LOOKBACK{ 8 };
+
+	// Member Variables
+	std::vector<DrawCommand>	m_Commands		{};		// in recording order
+	std::vector<DrawCommand>	m_Sorted		{};		// grouped per batch
+	std::vector<DrawBatch>		m_Batches		{};
+	std::vector<Bounds>			m_BatchBounds	{};
+	std::vector<uint32_t>		m_BatchOf		{};		// batch index per recorded command
+};
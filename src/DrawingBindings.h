@@ -3,7 +3,10 @@
 #include <windows.h>
 #include <cstdint>
 #include <memory>
+#include <algorithm>
+#include <vector>
 #include "GameEngine.h"
+#include "FloatBuffer.h"
 
 
 class DrawBindings{
@@ -11,63 +14,136 @@ public:
     static void SetColor(Color color) {GAME_ENGINE->SetColor(color.ToColorRef());}
     static void SetFont(Font* font){ GAME_ENGINE->SetFont(font); }
     static bool FillWindowRect(Color color){return GAME_ENGINE->FillWindowRect(color.ToColorRef());}
-    static bool DrawLine(Vector2f p1, Vector2f p2){
+    static bool DrawLine(const Vector2f& p1, const Vector2f& p2){
         return GAME_ENGINE->DrawLine(static_cast<int>(p1.x),static_cast<int>(p1.y),static_cast<int>(p2.x),static_cast<int>(p2.y));
     }
-    static bool DrawRect(Vector2f p1, Vector2f p2) {
+    static bool DrawRect(const Vector2f& p1, const Vector2f& p2) {
         return GAME_ENGINE->DrawRect(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y));
     }
-    static bool FillRect(Vector2f p1, Vector2f p2, int opacity) {
+    static bool FillRect(const Vector2f& p1, const Vector2f& p2, int opacity) {
         return GAME_ENGINE->FillRect(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y), opacity);
     }
-    static bool DrawRoundRect(Vector2f p1, Vector2f p2, int radius) {
+    static bool DrawRoundRect(const Vector2f& p1, const Vector2f& p2, int radius) {
         return GAME_ENGINE->DrawRoundRect(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y), radius);
     }
-    static bool FillRoundRect(Vector2f p1, Vector2f p2, int radius) {
+    static bool FillRoundRect(const Vector2f& p1, const Vector2f& p2, int radius) {
         return GAME_ENGINE->FillRoundRect(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y), radius);
     }
-    static bool DrawOval(Vector2f p1, Vector2f p2) {
+    static bool DrawOval(const Vector2f& p1, const Vector2f& p2) {
         return GAME_ENGINE->DrawOval(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y));
     }
-    static bool FillOval(Vector2f p1, Vector2f p2, int opacity) {
+    static bool FillOval(const Vector2f& p1, const Vector2f& p2, int opacity) {
         return GAME_ENGINE->FillOval(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y), opacity);
     }
-    static bool DrawArc(Vector2f p1, Vector2f p2, int startDegree, int angle) {
+    static bool DrawArc(const Vector2f& p1, const Vector2f& p2, int startDegree, int angle) {
         return GAME_ENGINE->DrawArc(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y), startDegree, angle);
     }
-    static bool FillArc(Vector2f p1, Vector2f p2, int startDegree, int angle) {
+    static bool FillArc(const Vector2f& p1, const Vector2f& p2, int startDegree, int angle) {
         return GAME_ENGINE->FillArc(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y), startDegree, angle);
     }
-    static int DrawString(const tstring& text, Vector2f p) {
+    static int DrawString(const tstring& text, const Vector2f& p) {
         return GAME_ENGINE->DrawString(text, static_cast<int>(p.x), static_cast<int>(p.y));
     }
-    static int DrawStretchedString(const tstring& text, Vector2f p1, Vector2f p2) {
+    static int DrawStretchedString(const tstring& text, const Vector2f& p1, const Vector2f& p2) {
         return GAME_ENGINE->DrawString(text, static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y));
     }
-    
+
+    // Plain number versions of the calls above, they build no Vector2f userdata so a frame full of them leaves nothing for the Lua GC
+    static bool DrawLineXY(int x1, int y1, int x2, int y2) {return GAME_ENGINE->DrawLine(x1, y1, x2, y2);}
+    static bool DrawRectXY(int left, int top, int right, int bottom) {return GAME_ENGINE->DrawRect(left, top, right, bottom);}
+    static bool FillRectXY(int left, int top, int right, int bottom, int opacity) {return GAME_ENGINE->FillRect(left, top, right, bottom, opacity);}
+    static bool DrawOvalXY(int left, int top, int right, int bottom) {return GAME_ENGINE->DrawOval(left, top, right, bottom);}
+    static bool FillOvalXY(int left, int top, int right, int bottom, int opacity) {return GAME_ENGINE->FillOval(left, top, right, bottom, opacity);}
+    static int DrawStringXY(const tstring& text, int left, int top) {return GAME_ENGINE->DrawString(text, left, top);}
+
+    // Bulk calls: 4 numbers per line or rect from a FloatBuffer or a flat Lua table, count leaves out the ones after it
+    static bool DrawLines(const sol::object& coords, sol::optional<int> count) {
+        int lineCount{};
+        const float* coordsArr = GetCoords(coords, count, lineCount);
+        return coordsArr && GAME_ENGINE->DrawLines(coordsArr, lineCount);
+    }
+    static bool FillRects(const sol::object& coords, sol::optional<int> count, sol::optional<int> opacity) {
+        int rectCount{};
+        const float* coordsArr = GetCoords(coords, count, rectCount);
+        return coordsArr && GAME_ENGINE->FillRects(coordsArr, rectCount, opacity.value_or(255));
+    }
+
     static Color GetDrawColor(){return Color::GetColorFromColorRef(GAME_ENGINE->GetDrawColor());}
     
     static void Redraw(){GAME_ENGINE->Repaint();};
+    static void SetBuffered(bool enable){GAME_ENGINE->SetDrawBuffering(enable);}
+    static std::tuple<unsigned int, unsigned int> GetCacheStats(){
+        return {GAME_ENGINE->GetDrawObjectCacheHits(), GAME_ENGINE->GetDrawObjectCacheMisses()};
+    }
+
+    static void SetDamageTracking(bool enable){GAME_ENGINE->SetDamageTracking(enable);}
+    static void Invalidate(const Vector2f& p1, const Vector2f& p2){
+        GAME_ENGINE->Invalidate(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y));
+    }
+    static void InvalidateXY(int left, int top, int right, int bottom){GAME_ENGINE->Invalidate(left, top, right, bottom);}
+    static void InvalidateAll(){GAME_ENGINE->InvalidateAll();}
+    static void SetFrameUnchanged(){GAME_ENGINE->SetFrameUnchanged();}
+    static bool NeedsRedraw(const Vector2f& p1, const Vector2f& p2){
+        return !GAME_ENGINE->IsOutsideDamage(static_cast<int>(p1.x), static_cast<int>(p1.y), static_cast<int>(p2.x), static_cast<int>(p2.y));
+    }
+    static unsigned int GetSkippedFrames(){return GAME_ENGINE->GetSkippedFrames();}
 
-    void DrawBitmap(const Bitmap *bitmapPtr, Vector2f topLeft)
+    void DrawBitmap(const Bitmap *bitmapPtr, const Vector2f& topLeft)
     {
 	    GAME_ENGINE->DrawBitmap(bitmapPtr, topLeft.x, topLeft.y);
     }
 
-    static std::unique_ptr<Font> CreateFont(const tstring& fontName, bool bold, bool italic, bool underline, int size)
+    // Lua may collect a font or bitmap while a recorded frame still draws it, the engine deletes it once that frame is presented
+    struct FontDeleter
+    {
+        void operator()(Font* fontPtr) const { GAME_ENGINE->DeleteFont(fontPtr); }
+    };
+    struct BitmapDeleter
     {
-        return std::make_unique<Font>(fontName,bold,italic,underline,size);
+        void operator()(Bitmap* bitmapPtr) const { GAME_ENGINE->DeleteBitmap(bitmapPtr); }
+    };
+
+    static std::unique_ptr<Font, FontDeleter> CreateFont(const tstring& fontName, bool bold, bool italic, bool underline, int size)
+    {
+        return std::unique_ptr<Font, FontDeleter>{ new Font{ fontName, bold, italic, underline, size } };
     }
 
-    static std::unique_ptr<Bitmap> CreateBitmap(const tstring& filename, bool createAlphaChannel)
+    static std::unique_ptr<Bitmap, BitmapDeleter> CreateBitmap(const tstring& filename, bool createAlphaChannel)
     {
-	    return std::make_unique<Bitmap>(filename, createAlphaChannel);
+	    return std::unique_ptr<Bitmap, BitmapDeleter>{ new Bitmap{ filename, createAlphaChannel } };
     }
 
     static Vector2f GetBitMapSize(Bitmap* bitmap){
         return Vector2f{static_cast<float>(bitmap->GetWidth()),static_cast<float>(bitmap->GetHeight())};
     }
 
+    // A FloatBuffer is used in place, a table is copied into a scratch array once per call
+    static const float* GetCoords(const sol::object& coords, sol::optional<int> count, int& groupCount){
+        static std::vector<float> tableCoords;
+
+        int valueCount{};
+        const float* coordsArr{};
+        if (coords.is<FloatBuffer>()) {
+            const FloatBuffer& buffer = coords.as<FloatBuffer&>();
+            valueCount = buffer.GetSize();
+            coordsArr = buffer.GetData();
+        }
+        else if (coords.get_type() == sol::type::table) {
+            const sol::table table = coords.as<sol::table>();
+            valueCount = static_cast<int>(table.size());
+            if (count) valueCount = std::clamp(*count * 4, 0, valueCount);
+
+            tableCoords.resize(valueCount);
+            for (int index{}; index < valueCount; ++index) tableCoords[index] = table.raw_get_or(index + 1, 0.f);
+            coordsArr = tableCoords.data();
+        }
+        else return nullptr;
+
+        groupCount = valueCount / 4;
+        if (count) groupCount = std::clamp(*count, 0, groupCount);
+        return coordsArr;
+    }
+
     static void CreateBindings(sol::state& state){
         state.new_usertype<DrawBindings>(
             "Draw",
@@ -85,8 +161,25 @@ public:
             "FillArc",          &DrawBindings::FillArc,
             "DrawString",       &DrawBindings::DrawString,
             "DrawStretchedString", &DrawBindings::DrawStretchedString,
+            "DrawLineXY",       &DrawBindings::DrawLineXY,
+            "DrawRectXY",       &DrawBindings::DrawRectXY,
+            "FillRectXY",       &DrawBindings::FillRectXY,
+            "DrawOvalXY",       &DrawBindings::DrawOvalXY,
+            "FillOvalXY",       &DrawBindings::FillOvalXY,
+            "DrawStringXY",     &DrawBindings::DrawStringXY,
+            "DrawLines",        &DrawBindings::DrawLines,
+            "FillRects",        &DrawBindings::FillRects,
             "GetDrawColor",     &DrawBindings::GetDrawColor,
             "Redraw",           &DrawBindings::Redraw,
+            "SetBuffered",      &DrawBindings::SetBuffered,
+            "GetCacheStats",    &DrawBindings::GetCacheStats,
+            "SetDamageTracking", &DrawBindings::SetDamageTracking,
+            "Invalidate",       &DrawBindings::Invalidate,
+            "InvalidateXY",     &DrawBindings::InvalidateXY,
+            "InvalidateAll",    &DrawBindings::InvalidateAll,
+            "SetFrameUnchanged", &DrawBindings::SetFrameUnchanged,
+            "NeedsRedraw",      &DrawBindings::NeedsRedraw,
+            "GetSkippedFrames", &DrawBindings::GetSkippedFrames,
             "DrawBitmap",       &DrawBindings::DrawBitmap
         );
 
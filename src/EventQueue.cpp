@@ -0,0 +1,34 @@
+//-----------------------------------------------------------------
+// Event Queue
+// C++ Source - EventQueue.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "EventQueue.h"
+
+//-----------------------------------------------------------------
+// EventQueue Member Functions
+//-----------------------------------------------------------------
+void EventQueue::Push(const EngineEvent& event)
+{
+	// only happens when the game thread stalls for thousands of events, a later move supersedes a dropped one anyway
+	if (!m_Ring.TryPush(event)) m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EventQueue::Drain(std::vector<EngineEvent>& events)
+{
+	events.clear();
+
+	EngineEvent event{};
+	while (m_Ring.TryPop(event))
+	{
+		// a move right after a move only updates the position, a click or a key in between keeps both
+		if (event.type == EngineEvent::Type::MouseMove && !events.empty() && events.back().type == EngineEvent::Type::MouseMove)
+		{
+			events.back() = event;
+		}
+		else events.push_back(event);
+	}
+}
@@ -0,0 +1,67 @@
+//-----------------------------------------------------------------
+// Event Queue
+// C++ Header - EventQueue.h - version v8_01
+//
+// Input and window events on their way from the window procedure to
+// the game thread. The window thread pushes compact 14 byte events
+// into a lock-free ring, the game thread drains it once per tick.
+// Draining merges every run of mouse moves into its last one, so a
+// fast mouse costs one move per tick however many messages it sent.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "SpscQueue.h"
+
+//-----------------------------------------------------------------
+// EngineEvent Struct
+//-----------------------------------------------------------------
+struct EngineEvent
+{
+	enum class Type : uint8_t { MouseMove, MouseButton, MouseWheel, KeyDown, KeyUp, FocusGained, FocusLost };
+
+	Type		type		{};
+	bool		isLeft		{};		// MouseButton
+	bool		isDown		{};		// MouseButton
+	bool		isRepeat	{};		// KeyDown, held down long enough to auto repeat
+	int16_t		x			{};		// mouse events, client coordinates
+	int16_t		y			{};
+	int16_t		distance	{};		// MouseWheel, WHEEL_DELTA per notch
+	uint16_t	modifiers	{};		// mouse events, the MK_ flags
+	uint16_t	key			{};		// KeyDown and KeyUp, virtual key code
+};
+
+//-----------------------------------------------------------------
+// EventQueue Class
+//-----------------------------------------------------------------
+class EventQueue final
+{
+public:
+	// Constructor(s) and destructor
+	explicit EventQueue(size_t capacity) : m_Ring{ capacity } {}
+	~EventQueue() = default;
+
+	// Disabling copy/move constructors and assignment operators, the threads hold references to the ring
+	EventQueue(const EventQueue& other)					= delete;
+	EventQueue(EventQueue&& other) noexcept				= delete;
+	EventQueue& operator=(const EventQueue& other)		= delete;
+	EventQueue& operator=(EventQueue&& other) noexcept	= delete;
+
+	// Producer side, a full queue drops the event
+	void		Push			(const EngineEvent& event);
+
+	// Consumer side, replaces the contents of events with everything queued since the last drain
+	void		Drain			(std::vector<EngineEvent>& events);
+
+	uint64_t	GetDroppedCount	()		const	{ return m_DroppedCount.load(std::memory_order_relaxed); }
+
+private:
+	// Member Variables
+	SpscQueue<EngineEvent>		m_Ring			;
+	std::atomic<uint64_t>		m_DroppedCount	{};
+};
@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------
+// Float Buffer
+// C++ Source - FloatBuffer.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "FloatBuffer.h"
+
+//-----------------------------------------------------------------
+// FloatBuffer Constructor(s)
+//-----------------------------------------------------------------
+FloatBuffer::FloatBuffer(int capacity)
+{
+	if (capacity > 0) m_Values.reserve((size_t)capacity);
+}
+
+//-----------------------------------------------------------------
+// FloatBuffer Member Functions
+//-----------------------------------------------------------------
+float FloatBuffer::Get(int index) const
+{
+	if (index < 1 || index > GetSize()) return 0.f;
+
+	return m_Values[index - 1];
+}
+
+void FloatBuffer::Set(int index, float value)
+{
+	if (index == GetSize() + 1) m_Values.push_back(value);
+	else if (index >= 1 && index <= GetSize()) m_Values[index - 1] = value;
+}
+
+void FloatBuffer::CreateBindings(sol::state& state)
+{
+	state.new_usertype<FloatBuffer>(
+		"FloatBuffer",
+		sol::constructors<FloatBuffer(), FloatBuffer(int)>(),
+		"Clear", &FloatBuffer::Clear,
+		"Push", [](FloatBuffer& buffer, sol::variadic_args values)
+		{
+			// any number of values per call, so a rect or a line is one call
+			for (float value : values) buffer.Push(value);
+		},
+		"Get", &FloatBuffer::Get,
+		"Set", &FloatBuffer::Set,
+		"GetSize", &FloatBuffer::GetSize
+	);
+}
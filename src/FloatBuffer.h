@@ -0,0 +1,49 @@
+//-----------------------------------------------------------------
+// Float Buffer
+// C++ Header - FloatBuffer.h - version v8_01
+//
+// Growable array of floats that lives on the C++ side. Scripts fill it
+// once and hand it to the bulk Draw calls, which read it directly
+// instead of going back into Lua for every number.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+#include <sol/sol.hpp>
+
+//-----------------------------------------------------------------
+// FloatBuffer Class
+//-----------------------------------------------------------------
+class FloatBuffer final
+{
+public:
+	// Constructor(s) and destructor
+	FloatBuffer()							= default;
+	explicit FloatBuffer(int capacity);		// reserves room for capacity values
+	~FloatBuffer()							= default;
+
+	FloatBuffer(const FloatBuffer& other)					= default;
+	FloatBuffer(FloatBuffer&& other) noexcept				= default;
+	FloatBuffer& operator=(const FloatBuffer& other)		= default;
+	FloatBuffer& operator=(FloatBuffer&& other) noexcept	= default;
+
+	// General Member Functions, indices are 1 based like a Lua array
+	void		Clear		()							{ m_Values.clear(); }		// keeps the capacity
+	void		Push		(float value)				{ m_Values.push_back(value); }
+	float		Get			(int index)		const;	// 0 outside the buffer
+	void		Set			(int index, float value);	// grows the buffer when index is one past the end
+	int			GetSize		()				const	{ return (int)m_Values.size(); }
+
+	const float*			GetData		()		const	{ return m_Values.data(); }
+	std::vector<float>&		GetValues	()				{ return m_Values; }
+
+	static void	CreateBindings	(sol::state& state);
+
+private:
+	// Member Variables
+	std::vector<float>	m_Values	{};
+};
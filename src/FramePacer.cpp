@@ -0,0 +1,130 @@
+//-----------------------------------------------------------------
+// Frame Pacer
+// C++ Source - FramePacer.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "FramePacer.h"
+
+#include <Mmsystem.h>		// timeBeginPeriod when there is no high resolution timer
+#include <cmath>
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+
+//-----------------------------------------------------------------
+// FramePacer Constructor(s) and Destructor
+//-----------------------------------------------------------------
+FramePacer::FramePacer()
+{
+	LARGE_INTEGER frequency{};
+	QueryPerformanceFrequency(&frequency);
+	m_Frequency = frequency.QuadPart;
+}
+
+FramePacer::~FramePacer()
+{
+	if (m_Timer == NULL) return;
+
+	CloseHandle(m_Timer);
+	if (!m_IsHighResolution) timeEndPeriod(1);
+}
+
+//-----------------------------------------------------------------
+// FramePacer Member Functions
+//-----------------------------------------------------------------
+void FramePacer::WaitUntil(LONGLONG deadline)
+{
+	if (!m_HasTriedTimer) CreateTimer();
+
+	LARGE_INTEGER now{};
+	QueryPerformanceCounter(&now);
+
+	// sleep until shortly before the deadline, a message wakes the thread up early
+	const LONGLONG sleepCounts{ deadline - now.QuadPart - m_SpinCounts };
+	if (sleepCounts > 0)
+	{
+		if (m_Timer != NULL)
+		{
+			LARGE_INTEGER dueTime{};
+			dueTime.QuadPart = -(sleepCounts * 10'000'000 / m_Frequency);		// relative, in 100 ns units
+			SetWaitableTimer(m_Timer, &dueTime, 0, nullptr, nullptr, FALSE);
+
+			if (MsgWaitForMultipleObjectsEx(1, &m_Timer, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE) != WAIT_OBJECT_0) return;
+		}
+		else
+		{
+			const DWORD sleepMs{ (DWORD)(sleepCounts * 1000 / m_Frequency) };
+			if (MsgWaitForMultipleObjectsEx(0, nullptr, sleepMs, QS_ALLINPUT, MWMO_INPUTAVAILABLE) != WAIT_TIMEOUT) return;
+		}
+	}
+
+	// the last bit is too short to sleep precisely
+	do
+	{
+		YieldProcessor();
+		QueryPerformanceCounter(&now);
+	} while (now.QuadPart < deadline);
+}
+
+void FramePacer::AddFrame(double frameTime, double targetTime)
+{
+	m_FrameTimes[m_NextFrame]	= frameTime;
+	m_IsLate[m_NextFrame]		= frameTime > targetTime * 1.5;
+
+	m_NextFrame = (m_NextFrame + 1) % STATS_FRAMES;
+	if (m_FrameCount < STATS_FRAMES) ++m_FrameCount;
+}
+
+FramePacer::JitterStats FramePacer::GetJitterStats() const
+{
+	JitterStats stats{};
+	stats.frameCount = m_FrameCount;
+	if (m_FrameCount == 0) return stats;
+
+	double sum{}, sumSquares{};
+	stats.minMs = m_FrameTimes[0] * 1000;
+	for (int index{}; index < m_FrameCount; ++index)
+	{
+		const double frameMs{ m_FrameTimes[index] * 1000 };
+		sum			+= frameMs;
+		sumSquares	+= frameMs * frameMs;
+		if (frameMs < stats.minMs) stats.minMs = frameMs;
+		if (frameMs > stats.maxMs) stats.maxMs = frameMs;
+		if (m_IsLate[index]) ++stats.lateFrames;
+	}
+
+	stats.meanMs	= sum / m_FrameCount;
+	const double variance{ sumSquares / m_FrameCount - stats.meanMs * stats.meanMs };
+	stats.stdDevMs	= variance > 0 ? std::sqrt(variance) : 0.0;
+	return stats;
+}
+
+void FramePacer::ResetStats()
+{
+	m_NextFrame		= 0;
+	m_FrameCount	= 0;
+}
+
+bool FramePacer::CreateTimer()
+{
+	m_HasTriedTimer = true;
+
+	// the high resolution timer exists since Windows 10 1803, older versions get a normal one at 1 ms resolution
+	m_Timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	m_IsHighResolution = m_Timer != NULL;
+
+	if (m_Timer == NULL)
+	{
+		m_Timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+		if (m_Timer != NULL) timeBeginPeriod(1);
+	}
+
+	// stop sleeping a little earlier than the timer can be late
+	m_SpinCounts = m_Frequency * (m_IsHighResolution ? 500 : 2000) / 1'000'000;
+
+	return m_Timer != NULL;
+}
@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------
+// Frame Pacer
+// C++ Header - FramePacer.h - version v8_01
+//
+// Waits for the next frame without burning a core: the thread sleeps
+// on a high resolution waitable timer together with the message queue
+// and only spins for the last fraction of a millisecond. Also keeps
+// statistics on how evenly the frames came out.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+//-----------------------------------------------------------------
+// FramePacer Class
+//-----------------------------------------------------------------
+class FramePacer final
+{
+public:
+	// Constructor(s) and destructor
+	FramePacer();
+	~FramePacer();
+
+	// Disabling copy/move constructors and assignment operators, the pacer owns the timer handle
+	FramePacer(const FramePacer& other)					= delete;
+	FramePacer(FramePacer&& other) noexcept				= delete;
+	FramePacer& operator=(const FramePacer& other)		= delete;
+	FramePacer& operator=(FramePacer&& other) noexcept	= delete;
+
+	// General Member Functions
+	// Returns when the performance counter reaches deadline, or earlier when a message arrives
+	void		WaitUntil		(LONGLONG deadline);
+
+	// Frame times over the last STATS_FRAMES frames, in milliseconds
+	struct JitterStats
+	{
+		int			frameCount		{};
+		double		meanMs			{};
+		double		stdDevMs		{};		// the jitter
+		double		minMs			{};
+		double		maxMs			{};
+		int			lateFrames		{};		// took more than one and a half frame periods
+	};
+
+	void		AddFrame		(double frameTime, double targetTime);		// in seconds
+	JitterStats	GetJitterStats	()		const;
+	void		ResetStats		();
+
+private:
+	// Private Member Functions
+	bool		CreateTimer		();
+
+	static const int STATS_FRAMES{ 240 };
+
+	// Member Variables
+	HANDLE		m_Timer				{};
+	bool		m_IsHighResolution	{};		// otherwise the timer resolution is raised to 1 ms with timeBeginPeriod
+	bool		m_HasTriedTimer		{};
+	LONGLONG	m_Frequency			{};
+	LONGLONG	m_SpinCounts		{};		// how long before the deadline the pacer stops sleeping
+
+	double		m_FrameTimes[STATS_FRAMES]	{};
+	bool		m_IsLate[STATS_FRAMES]		{};
+	int			m_NextFrame					{};
+	int			m_FrameCount				{};
+};
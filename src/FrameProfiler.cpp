@@ -0,0 +1,91 @@
+//-----------------------------------------------------------------
+// Frame Profiler
+// C++ Source - FrameProfiler.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "FrameProfiler.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------
+// FrameProfiler Member Functions
+//-----------------------------------------------------------------
+thread_local FrameProfiler::Scope* FrameProfiler::Scope::s_InnermostPtr{};
+
+void FrameProfiler::AddTime(Phase phase, std::chrono::steady_clock::duration time)
+{
+	m_PhaseTimes[(int)phase].fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(), std::memory_order_relaxed);
+}
+
+void FrameProfiler::EndFrame(double frameTime)
+{
+	m_PhaseTimes[(int)Phase::Frame].store(int64_t(frameTime * 1e9), std::memory_order_relaxed);
+
+	for (int phase{}; phase < PHASE_COUNT; ++phase)
+	{
+		m_History[phase][m_NextFrame] = float(m_PhaseTimes[phase].exchange(0, std::memory_order_relaxed) / 1e6);
+	}
+	m_NextFrame = (m_NextFrame + 1) % HISTORY_FRAMES;
+	if (m_FrameCount < HISTORY_FRAMES) ++m_FrameCount;
+
+	std::copy(std::begin(m_DrawCalls), std::end(m_DrawCalls), m_LastDrawCalls);
+	std::fill(std::begin(m_DrawCalls), std::end(m_DrawCalls), 0);
+}
+
+FrameProfiler::PhaseStats FrameProfiler::GetPhaseStats(Phase phase) const
+{
+	PhaseStats stats{};
+	if (m_FrameCount == 0) return stats;
+
+	// the history is not kept sorted, a copy of 240 floats is cheap enough to select from
+	float sortedArr[HISTORY_FRAMES];
+	std::copy(m_History[(int)phase], m_History[(int)phase] + m_FrameCount, sortedArr);
+	std::sort(sortedArr, sortedArr + m_FrameCount);
+
+	double sum{};
+	for (int index{}; index < m_FrameCount; ++index) sum += sortedArr[index];
+
+	// nearest rank, the 99th percentile of fewer than 100 frames is the worst one
+	const int p99Rank{ (m_FrameCount * 99 + 99) / 100 };
+
+	stats.p50Ms		= sortedArr[(m_FrameCount - 1) / 2];
+	stats.p99Ms		= sortedArr[p99Rank - 1];
+	stats.maxMs		= sortedArr[m_FrameCount - 1];
+	stats.meanMs	= sum / m_FrameCount;
+
+	return stats;
+}
+
+int FrameProfiler::GetTotalDrawCalls() const
+{
+	int total{};
+	for (int count : m_LastDrawCalls) total += count;
+
+	return total;
+}
+
+const char* FrameProfiler::GetPhaseName(Phase phase)
+{
+	static const char* namesArr[PHASE_COUNT]{ "frame", "pump", "update", "draw", "flush", "present", "checkKeyboard", "monitorKeyboard" };
+	return namesArr[(int)phase];
+}
+
+const char* FrameProfiler::GetDrawCallName(DrawCall drawCall)
+{
+	static const char* namesArr[DRAW_CALL_COUNT]{ "line", "rect", "fillRect", "roundRect", "fillRoundRect", "oval", "fillOval", "arc", "fillArc",
+												  "polygon", "fillPolygon", "string", "bitmap" };
+	return namesArr[(int)drawCall];
+}
+
+void FrameProfiler::Reset()
+{
+	for (std::atomic<int64_t>& time : m_PhaseTimes) time.store(0, std::memory_order_relaxed);
+	m_NextFrame		= 0;
+	m_FrameCount	= 0;
+
+	std::fill(std::begin(m_DrawCalls), std::end(m_DrawCalls), 0);
+	std::fill(std::begin(m_LastDrawCalls), std::end(m_LastDrawCalls), 0);
+}
@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------
+// Frame Profiler
+// C++ Header - FrameProfiler.h - version v8_01
+//
+// Times the phases of every frame and counts the draw calls the game
+// made in it. The last HISTORY_FRAMES frames are kept per phase, so
+// the median, the 99th percentile and the worst frame can be read at
+// any time. Phases may be timed on another thread than the one that
+// ends the frames, the draw calls are counted on the painting thread.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//-----------------------------------------------------------------
+// FrameProfiler Class
+//-----------------------------------------------------------------
+class FrameProfiler final
+{
+public:
+	enum class Phase : int
+	{
+		Frame,				// the whole frame, from the frame time the game loop measured
+		Pump,				// message handling, without the phases a message runs such as a WM_PAINT
+		Update,				// AbstractGame::Tick, the timers and the queued input callbacks
+		Draw,				// AbstractGame::Paint
+		Flush,				// drawing the recorded draw commands
+		Present,			// copying the buffer to the window
+		CheckKeyboard,		// AbstractGame::CheckKeyboard
+		MonitorKeyboard,	// key press detection and AbstractGame::KeyPressed
+		Count
+	};
+
+	enum class DrawCall : int
+	{
+		Line, Rect, FillRect, RoundRect, FillRoundRect, Oval, FillOval, Arc, FillArc,
+		Polygon, FillPolygon, String, Bitmap,
+		Count
+	};
+
+	static const int PHASE_COUNT	{ (int)Phase::Count };
+	static const int DRAW_CALL_COUNT{ (int)DrawCall::Count };
+	static const int HISTORY_FRAMES	{ 240 };
+
+	// Constructor(s) and destructor
+	FrameProfiler()		= default;
+	~FrameProfiler()	= default;
+
+	// Disabling copy/move constructors and assignment operators, the phase times are atomics
+	FrameProfiler(const FrameProfiler& other)					= delete;
+	FrameProfiler(FrameProfiler&& other) noexcept				= delete;
+	FrameProfiler& operator=(const FrameProfiler& other)		= delete;
+	FrameProfiler& operator=(FrameProfiler&& other) noexcept	= delete;
+
+	// Times the phase from construction to destruction, a phase can be timed several times per frame.
+	// A scope opened inside another one on the same thread is taken out of the outer phase,
+	// so every nanosecond counts for one phase only.
+	class Scope final
+	{
+	public:
+		Scope(FrameProfiler& profiler, Phase phase) : m_Profiler{ profiler }, m_Phase{ phase }, m_OuterPtr{ s_InnermostPtr }, m_Start{ Clock::now() }
+		{
+			s_InnermostPtr = this;
+		}
+		~Scope()
+		{
+			const Clock::duration time{ Clock::now() - m_Start };
+			m_Profiler.AddTime(m_Phase, time - m_NestedTime);
+
+			s_InnermostPtr = m_OuterPtr;
+			if (m_OuterPtr != nullptr) m_OuterPtr->m_NestedTime += time;
+		}
+
+		Scope(const Scope& other)				= delete;
+		Scope& operator=(const Scope& other)	= delete;
+
+	private:
+		FrameProfiler&			m_Profiler;
+		Phase					m_Phase;
+		Scope*					m_OuterPtr;
+		std::chrono::steady_clock::time_point	m_Start;
+		std::chrono::steady_clock::duration		m_NestedTime	{};
+
+		static thread_local Scope*	s_InnermostPtr;
+	};
+
+	// General Member Functions
+	void		AddTime			(Phase phase, std::chrono::steady_clock::duration time);
+	void		CountDrawCall	(DrawCall drawCall, int count = 1)	{ if (!m_IsCountingPaused) m_DrawCalls[(int)drawCall] += count; }
+	void		PauseCounting	(bool isPaused)						{ m_IsCountingPaused = isPaused; }
+
+	// Moves the times and counts gathered since the previous call into the history
+	void		EndFrame		(double frameTime);		// in seconds
+
+	// Over the frames in the history, in milliseconds
+	struct PhaseStats
+	{
+		double		p50Ms	{};
+		double		p99Ms	{};
+		double		maxMs	{};
+		double		meanMs	{};
+	};
+
+	PhaseStats	GetPhaseStats	(Phase phase)				const;
+	int			GetFrameCount	()							const	{ return m_FrameCount; }
+	int			GetDrawCalls	(DrawCall drawCall)			const	{ return m_LastDrawCalls[(int)drawCall]; }	// in the last frame
+	int			GetTotalDrawCalls	()						const;
+
+	static const char*	GetPhaseName	(Phase phase);
+	static const char*	GetDrawCallName	(DrawCall drawCall);
+
+	void		Reset			();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	// Member Variables
+	std::atomic<int64_t>	m_PhaseTimes[PHASE_COUNT]			{};		// nanoseconds since the last EndFrame
+	float					m_History[PHASE_COUNT][HISTORY_FRAMES]	{};		// milliseconds
+	int						m_NextFrame							{};
+	int						m_FrameCount						{};
+
+	int						m_DrawCalls[DRAW_CALL_COUNT]		{};
+	int						m_LastDrawCalls[DRAW_CALL_COUNT]	{};
+	bool					m_IsCountingPaused					{};
+};
@@ -7,16 +7,25 @@
 // Include Files
 //-----------------------------------------------------------------
 #include "Game.h"
+#include <chrono>
+#include <filesystem>
 #include <sol/sol.hpp>
 #include "Vector.h"
 #include "Color.h"
+#include "LifeGrid.h"
+#include "HashLife.h"
+#include "FloatBuffer.h"
+#include "ScriptCache.h"
 #include "DrawingBindings.h"
 #include "UtilsBindings.h"
+#include "ProfilerBindings.h"
+#include "InputBindings.h"
 //-----------------------------------------------------------------
 // Game Member Functions																				
 //-----------------------------------------------------------------
 
-Game::Game() 																	
+Game::Game(const tstring& scriptFilename) 
+	: scriptFilename{ scriptFilename }
 {
 	// nothing to create
 }
@@ -35,65 +44,78 @@ void Game::Initialize()
 	GAME_ENGINE->SetWidth(1024);
 	GAME_ENGINE->SetHeight(1024);
     GAME_ENGINE->SetFrameRate(50);
-	state.script_file("lua/GameOfLife.lua");
-	sol::function solSetup{ state["Init"] };
-	solUpdate = sol::function{state["Update"]};
-	solDraw = sol::function{state["DrawFunc"]};
-	solStart = sol::function{state["Start"]};
-	solEnd = sol::function{state["End"]};
-	solMouseAction = sol::function{state["MouseButtonAction"]};
-	solMouseMove = sol::function{state["MouseMove"]};
-	solMouseWheelAction = sol::function{state["MouseWheelAction"]};
-	solCheckKeyboard = sol::function{state["CheckKeyboard"]};
-	solSetup.call();
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	// from the bytecode cache when it matches the source, parse errors throw like script_file does
+	if (ScriptCache::LoadFile(state.lua_state(), std::filesystem::path{ scriptFilename }) != LUA_OK) throw sol::error{ sol::stack::pop<std::string>(state.lua_state()) };
+	sol::stack::pop<sol::function>(state.lua_state()).call();
+	ResolveCallbacks();
+	solInit.Call();
+
+	// saving the script reloads it into the running game, see ReloadScript
+	scriptWatcher.Watch(GetScriptSourcePath());
 
 
 }
 
 void Game::Start()
 {
-	solStart.call();
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	solStart.Call();
 }
 
 void Game::End()
 {
-	solEnd.call();
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	solEnd.Call();
 	printf("endTest\n");
 }
 
 void Game::Paint(RECT rect) const
 {
-	
-	solDraw.call();
+	// the interpolation alpha, games without a fixed timestep always get 1
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	solDraw.Call(GAME_ENGINE->GetInterpolationAlpha());
 }
 
 void Game::Tick()
 {
-	
-	
-	//why does this engine use milliseconds for deltatime, the fuck
-	float deltaTime = static_cast<float>(GAME_ENGINE->GetFrameDelay());
-	solUpdate.call(deltaTime/1000.f);
+	if (scriptWatcher.HasChanged()) ReloadScript();
+
+	// seconds, the measured frame time or the fixed timestep
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	solUpdate.Call(static_cast<float>(GAME_ENGINE->GetDeltaTime()));
+
+	// the tasks of Engine.spawn that are due, after Update so both see the same tick
+	scheduler.Tick(GAME_ENGINE->GetDeltaTime());
 }
 
 void Game::MouseButtonAction(bool isLeft, bool isDown, int x, int y, WPARAM wParam)
 {	
-	solMouseAction.call(isLeft,isDown,Vector2f{static_cast<float>(x),static_cast<float>(y)});
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	solMouseAction.Call(isLeft,isDown,Vector2f{static_cast<float>(x),static_cast<float>(y)});
 }
 
 void Game::MouseWheelAction(int x, int y, int distance, WPARAM wParam)
 {	
-	solMouseWheelAction.call(Vector2f(static_cast<float>(x),static_cast<float>(y)),distance);
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	solMouseWheelAction.Call(Vector2f(static_cast<float>(x),static_cast<float>(y)),distance);
 }
 
 void Game::MouseMove(int x, int y, WPARAM wParam)
 {	
-	solMouseMove.call(Vector2f(static_cast<float>(x),static_cast<float>(y)));
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	solMouseMove.Call(Vector2f(static_cast<float>(x),static_cast<float>(y)));
 }
 
 void Game::CheckKeyboard()
 {	
-	solCheckKeyboard.call();
+	// F9 starts and stops the Lua profiler, checked here because the key list only holds character keys
+	const bool isProfilerKeyDown{ GAME_ENGINE->IsKeyDown(VK_F9) && GetForegroundWindow() == GAME_ENGINE->GetWindow() };
+	if (isProfilerKeyDown && !wasProfilerKeyDown) ToggleLuaProfiler();
+	wasProfilerKeyDown = isProfilerKeyDown;
+
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	solCheckKeyboard.Call();
 }
 
 void Game::KeyPressed(TCHAR key)
@@ -105,14 +127,122 @@ void Game::CallAction(Caller* callerPtr)
 {
 }
 
+void Game::ResolveCallbacks()
+{
+	for (LuaCallback* callbackPtr : { &solInit, &solUpdate, &solDraw, &solStart, &solEnd, &solMouseAction, &solMouseWheelAction, &solMouseMove,
+									  &solCheckKeyboard })
+	{
+		callbackPtr->Resolve(state);
+	}
+}
+
+std::filesystem::path Game::GetScriptSourcePath() const
+{
+	const std::filesystem::path scriptPath{ scriptFilename };
+
+#ifdef GAME_SCRIPT_SOURCE_DIR
+	// the game runs the copy of the lua folder the build puts next to the executable, the edits are made to the sources
+	const std::filesystem::path sourcePath{ std::filesystem::path{ GAME_SCRIPT_SOURCE_DIR } / scriptPath.filename() };
+	std::error_code error{};
+	if (std::filesystem::exists(sourcePath, error)) return sourcePath;
+#endif
+
+	return scriptPath;
+}
+
+void Game::ReloadScript()
+{
+	LuaProfiler::ScriptScope scriptScope{ luaProfiler };
+	const std::string scriptPath{ std::filesystem::path{ scriptFilename }.string() };
+	const auto startTime{ std::chrono::steady_clock::now() };
+
+	// a saved source replaces the build copy first, the copy keeps the chunk name and its bytecode cache the game uses
+	std::error_code error{};
+	if (!std::filesystem::equivalent(scriptWatcher.GetScriptPath(), std::filesystem::path{ scriptFilename }, error))
+	{
+		std::filesystem::copy_file(scriptWatcher.GetScriptPath(), std::filesystem::path{ scriptFilename }, std::filesystem::copy_options::overwrite_existing, error);
+		if (error)
+		{
+			printf("Reload of %s failed: cannot copy %s: %s\n", scriptPath.c_str(), scriptWatcher.GetScriptPath().string().c_str(), error.message().c_str());
+			return;
+		}
+	}
+
+	// the old script hands over what it wants to keep, locals would be lost otherwise
+	sol::object reloadState{};
+	sol::protected_function solGetReloadState{ state["GetReloadState"] };
+	if (solGetReloadState.valid())
+	{
+		sol::protected_function_result result{ solGetReloadState() };
+		if (result.valid()) reloadState = result;
+		else printf("GetReloadState failed: %s\n", result.get<sol::error>().what());
+	}
+
+	// an error leaves the game running on the functions it already had, the next save tries again
+	lua_State* luaStatePtr = state.lua_state();
+	if (ScriptCache::LoadFile(luaStatePtr, std::filesystem::path{ scriptFilename }) != LUA_OK)
+	{
+		printf("Reload of %s failed: %s\n", scriptPath.c_str(), sol::stack::pop<std::string>(luaStatePtr).c_str());
+		return;
+	}
+
+	sol::protected_function_result chunkResult{ sol::stack::pop<sol::protected_function>(luaStatePtr)() };
+	if (!chunkResult.valid())
+	{
+		printf("Reload of %s failed: %s\n", scriptPath.c_str(), chunkResult.get<sol::error>().what());
+		return;
+	}
+
+	// Init and Start are not run again, the window and the game state stay as they are
+	ResolveCallbacks();
+
+	sol::protected_function solOnReload{ state["OnReload"] };
+	if (solOnReload.valid())
+	{
+		sol::protected_function_result result{ solOnReload(reloadState) };
+		if (!result.valid()) printf("OnReload failed: %s\n", result.get<sol::error>().what());
+	}
+
+	GAME_ENGINE->InvalidateAll();
+
+	const std::chrono::duration<double, std::milli> reloadTime{ std::chrono::steady_clock::now() - startTime };
+	printf("Reloaded %s in %.2f ms\n", scriptPath.c_str(), reloadTime.count());
+}
+
+void Game::ToggleLuaProfiler()
+{
+	if (!luaProfiler.IsRunning())
+	{
+		printf("Lua profiler started, F9 stops it\n");
+		luaProfiler.Reset();
+		luaProfiler.Start();
+		return;
+	}
+
+	luaProfiler.Stop();
+	luaProfiler.PrintFlatProfile(20);
+	if (luaProfiler.SaveCollapsedStacks("lua_profile.folded")) printf("Collapsed stacks written to lua_profile.folded\n");
+}
+
 
 
 void Game::CreateBindings(){
 	state.open_libraries(sol::lib::base);
+	ScriptCache::CreateBindings(state.lua_state());
 
 	Vector2<float>::CreateBindings(state,_T("Vector2f"));
+	LifeGrid::CreateBindings(state, GAME_ENGINE->GetThreadPool());
+	HashLife::CreateBindings(state);
+	FloatBuffer::CreateBindings(state);
 	Color::CreateBindings(state);
 	DrawBindings::CreateBindings(state);
 	UtilsBindings::CreateBindings(state);
+	ProfilerBindings::CreateBindings(state);
+	InputBindings::CreateBindings(state);
+	LuaProfiler::CreateBindings(state, &luaProfiler);
+	LuaAllocator::CreateBindings(state, &luaAllocator);
+	CoroutineScheduler::CreateBindings(state.lua_state(), &scheduler);
+	LuaCallback::CreateBindings(state, { &solInit, &solUpdate, &solDraw, &solStart, &solEnd, &solMouseAction, &solMouseWheelAction, &solMouseMove,
+										 &solCheckKeyboard });
 
 }
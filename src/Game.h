@@ -12,6 +12,11 @@
 #include "Resource.h"	
 #include "GameEngine.h"
 #include "AbstractGame.h"
+#include "CoroutineScheduler.h"
+#include "LuaAllocator.h"
+#include "LuaCallback.h"
+#include "LuaProfiler.h"
+#include "ScriptWatcher.h"
 #include <sol/sol.hpp>
 
 //-----------------------------------------------------------------
@@ -23,7 +28,7 @@ public:
 	//---------------------------
 	// Constructor(s) and Destructor
 	//---------------------------
-	Game();
+	explicit Game(const tstring& scriptFilename = _T("lua/GameOfLife.lua"));
 
 	virtual ~Game() override;
 
@@ -55,16 +60,27 @@ private:
 	// -------------------------
 	// Datamembers
 	// -------------------------
-	sol::state state;
+	LuaAllocator luaAllocator;		// before state, it has to outlive every block the state allocated
+	sol::state state{ sol::default_at_panic, &LuaAllocator::Allocate, &luaAllocator };
+	LuaProfiler luaProfiler{ state.lua_state() };	// after state, it removes its hook from the state when destroyed
+	bool wasProfilerKeyDown{};
+	CoroutineScheduler scheduler{ state.lua_state(), &luaProfiler };
+	tstring scriptFilename;
+	ScriptWatcher scriptWatcher;
 	void CreateBindings();
-	sol::function solUpdate;
-	sol::function solDraw;
-	sol::function solStart;
-	sol::function solEnd;
-	sol::function solMouseAction;
-	sol::function solMouseWheelAction;
-	sol::function solMouseMove;
-	sol::function solCheckKeyboard;
+	void ResolveCallbacks();
+	void ReloadScript();
+	std::filesystem::path GetScriptSourcePath() const;		// the script the watcher watches
+	void ToggleLuaProfiler();
+	LuaCallback solInit{ "Init" };
+	LuaCallback solUpdate{ "Update" };
+	LuaCallback solDraw{ "DrawFunc" };
+	LuaCallback solStart{ "Start" };
+	LuaCallback solEnd{ "End" };
+	LuaCallback solMouseAction{ "MouseButtonAction" };
+	LuaCallback solMouseWheelAction{ "MouseWheelAction" };
+	LuaCallback solMouseMove{ "MouseMove" };
+	LuaCallback solCheckKeyboard{ "CheckKeyboard" };
 
 
 
@@ -7,6 +7,8 @@
 // Include Files
 //-----------------------------------------------------------------
 #include "GameEngine.h"
+#include "SoftwareRenderer.h"
+#include "PixelKernels.h"
 
 #define _USE_MATH_DEFINES	// necessary for including (among other values) PI  - see math.h
 #include <math.h>			// used in various draw member functions
@@ -18,6 +20,11 @@
 
 using namespace std;
 
+// POINT arrays are handed to the render backend without copying
+static_assert(sizeof(POINT) == sizeof(RenderPoint), "POINT and RenderPoint must have the same layout");
+
+thread_local bool GameEngine::s_IsSimulationThread{};
+
 //-----------------------------------------------------------------
 // Windows Functions
 //-----------------------------------------------------------------
@@ -40,7 +47,7 @@ GameEngine::GameEngine()
 GameEngine::~GameEngine()
 {
 	// clean up keyboard monitor buffer 
-	delete m_KeyListPtr;
+	delete[] m_KeyListPtr;
 
 	// clean up the font
 	if (m_FontDraw != 0)
@@ -63,8 +70,17 @@ void GameEngine::SetGame(AbstractGame* gamePtr)
 	m_GamePtr = gamePtr;
 }
 
+ThreadPool* GameEngine::GetThreadPool()
+{
+	if (!m_ThreadPoolPtr) m_ThreadPoolPtr = std::make_unique<ThreadPool>(ThreadPool::GetDefaultWorkerCount());
+
+	return m_ThreadPoolPtr.get();
+}
+
 void GameEngine::MonitorKeyboard()
 {
+	FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::MonitorKeyboard };
+
 	if (m_KeyListPtr != nullptr && GetForegroundWindow() == m_Window)
 	{
 		int count{};
@@ -114,12 +130,20 @@ bool GameEngine::Run(HINSTANCE hInstance, int cmdShow)
 	m_HdcDraw = hBufferDC;
 	GetClientRect(m_Window, &m_RectDraw);
 
+	// The pen and brush for the draw color stay selected in the buffer from now on
+	SelectDrawObjects();
+
+	// Threaded mode: from here on the game only runs on the simulation thread
+	if (m_IsThreaded)
+	{
+		m_SnapshotReady = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+		m_StopSimulation = false;
+		m_SimulationThread = thread{ &GameEngine::SimulationLoop, this };
+	}
+
 	// Framerate control
-	LARGE_INTEGER tickFrequency, tickTrigger, currentTick;
-	QueryPerformanceFrequency(&tickFrequency);
-	int countsPerMillisecond{ int(tickFrequency.LowPart) / 1000};
-	QueryPerformanceCounter(&currentTick);
-	tickTrigger = currentTick;
+	FrameClock clock{};
+	StartFrameClock(clock);
 
 	// Enter the main message loop
 	MSG msg;
@@ -129,33 +153,51 @@ bool GameEngine::Run(HINSTANCE hInstance, int cmdShow)
 		{
 			// Process the message
 			if (msg.message == WM_QUIT) break;
+
+			FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Pump };
 			TranslateMessage(&msg);
 			DispatchMessage(&msg);
 		}
-		else
+		else if (m_IsThreaded)
 		{
-			// Get current time stamp
-			QueryPerformanceCounter(&currentTick);
-			if (currentTick.QuadPart >= tickTrigger.QuadPart)
+			// present the newest snapshot, or sleep until there is one or a message comes in
+			if (m_Snapshots.Acquire())
 			{
-				// Paint the window
 				HDC hDC = GetDC(m_Window);
-				PaintDoubleBuffered(hDC);
+				PresentSnapshot(hDC);
 				ReleaseDC(m_Window, hDC);
-
-				// Call the game tick
-				m_GamePtr->Tick();
+			}
+			else MsgWaitForMultipleObjectsEx(1, &m_SnapshotReady, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+		}
+		else
+		{
+			double frameTime{};
+			if (IsFrameDue(clock, frameTime))
+			{
+				// Paint the window and tick the game
+				RunFrame(frameTime);
 
 				// Process user input
-				m_GamePtr->CheckKeyboard();
 				MonitorKeyboard();
-
-				// update the tick trigger
-				tickTrigger.QuadPart = currentTick.QuadPart + m_FrameDelay * countsPerMillisecond;
 			}
+			else m_FramePacer.WaitUntil(clock.trigger);		// sleeps until the frame is due or a message comes in
 		}
 	}
 
+	// Normally stopped at WM_DESTROY already
+	StopSimulation();
+	if (m_SnapshotReady != NULL)
+	{
+		CloseHandle(m_SnapshotReady);
+		m_SnapshotReady = NULL;
+	}
+
+	// Put back the original pen and brush and delete the cached ones
+	ReleaseDrawObjects();
+
+	// Kill the alpha fill surface
+	ReleaseScratchSurface();
+
 	// Reset the old bmp of the buffer
 	SelectObject(hBufferDC, hOldBmp);
 
@@ -167,14 +209,458 @@ bool GameEngine::Run(HINSTANCE hInstance, int cmdShow)
 	return msg.wParam?true:false;
 }
 
+void GameEngine::StartFrameClock(FrameClock& clock) const
+{
+	LARGE_INTEGER frequency, now;
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&now);
+
+	// the first frame covers one frame period
+	clock.frequency	= frequency.QuadPart;
+	clock.trigger	= now.QuadPart;
+	clock.lastFrame	= now.QuadPart - clock.frequency / m_FrameRate;
+}
+
+bool GameEngine::IsFrameDue(FrameClock& clock, double& frameTime)
+{
+	LARGE_INTEGER now;
+	QueryPerformanceCounter(&now);
+	if (now.QuadPart < clock.trigger) return false;
+
+	frameTime = double(now.QuadPart - clock.lastFrame) / clock.frequency;
+	clock.lastFrame = now.QuadPart;
+	m_FramePacer.AddFrame(frameTime, 1.0 / m_FrameRate);
+
+	// the next frame is due one period after this one was due, so late frames do not make the rate drift,
+	// after a hitch of more than a frame the schedule starts over from now instead of rushing frames out
+	const LONGLONG countsPerFrame{ clock.frequency / m_FrameRate };
+	clock.trigger += countsPerFrame;
+	if (clock.trigger <= now.QuadPart) clock.trigger = now.QuadPart + countsPerFrame;
+
+	return true;
+}
+
+void GameEngine::RunFrame(double frameTime)
+{
+	m_FrameTime = frameTime;
+
+	// the timers that came due, their listeners run here on the game thread
+	{
+		FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Update };
+		m_TimerWheel.Advance(frameTime);
+	}
+
+	if (m_TickRate <= 0)
+	{
+		// one tick per frame, after the paint, covering the time since the previous frame
+		PaintFrame();
+
+		m_DeltaTime = frameTime;
+		m_InterpolationAlpha = 1.0;
+		TickGame();
+	}
+	else
+	{
+		// Fixed timestep: run the ticks the elapsed time holds, then paint in between the last two
+		const double tickTime{ 1.0 / m_TickRate };
+		m_DeltaTime = tickTime;
+		m_TickAccumulator += frameTime;
+
+		for (int tick{}; tick < m_MaxCatchUpTicks && m_TickAccumulator >= tickTime; ++tick)
+		{
+			TickGame();
+			m_TickAccumulator -= tickTime;
+		}
+
+		// too far behind, the game time that did not fit is dropped
+		if (m_TickAccumulator >= tickTime) m_TickAccumulator = fmod(m_TickAccumulator, tickTime);
+
+		m_InterpolationAlpha = m_TickAccumulator / tickTime;
+		PaintFrame();
+	}
+
+	m_Profiler.EndFrame(frameTime);
+}
+
+void GameEngine::TickGame()
+{
+	{
+		FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Update };
+		DispatchEvents();
+		m_GamePtr->Tick();
+	}
+
+	FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::CheckKeyboard };
+	m_GamePtr->CheckKeyboard();
+}
+
+void GameEngine::PaintFrame()
+{
+	// the simulation thread only records, the window thread presents
+	if (IsSimulationThread())
+	{
+		RecordSnapshot();
+		return;
+	}
+
+	// headless runs have no window to paint to, the render backend holds the frame
+	if (!m_Window)
+	{
+		PaintDoubleBuffered(NULL);
+		return;
+	}
+
+	HDC hDC = GetDC(m_Window);
+	PaintDoubleBuffered(hDC);
+	ReleaseDC(m_Window, hDC);
+}
+
+bool GameEngine::RunHeadless(int frameCount, const tstring& outputFilename)
+{
+	AllocateConsole();
+
+	// Game initialization
+	m_GamePtr->Initialize();
+
+	// Without a window everything is drawn by the software renderer
+	if (!m_RenderBackendPtr) SetRenderBackend(make_unique<SoftwareRenderer>(m_Width, m_Height));
+	m_RectDraw = { 0, 0, m_Width, m_Height };
+
+	// There is no WM_CREATE, so seed and start the game here
+	srand((unsigned int) GetTickCount64());
+	m_GamePtr->Start();
+
+	LARGE_INTEGER tickFrequency, startTick, endTick;
+	QueryPerformanceFrequency(&tickFrequency);
+	QueryPerformanceCounter(&startTick);
+
+	// Every frame covers exactly one frame period, so headless runs do not depend on the machine's speed
+	for (int frame{}; frame < frameCount; ++frame) RunFrame(1.0 / m_FrameRate);
+
+	QueryPerformanceCounter(&endTick);
+
+	m_GamePtr->End();
+
+	const double seconds{ double(endTick.QuadPart - startTick.QuadPart) / tickFrequency.QuadPart };
+	printf("Headless run: %d frames in %.3f s (%.1f frames per second)\n", frameCount, seconds, seconds > 0 ? frameCount / seconds : 0.0);
+
+	// Dump the last frame for regression checks
+	if (!outputFilename.empty())
+	{
+		SoftwareRenderer* rendererPtr = dynamic_cast<SoftwareRenderer*>(m_RenderBackendPtr.get());
+		if (rendererPtr == nullptr || !rendererPtr->SaveToFile(outputFilename)) return false;
+	}
+
+	return true;
+}
+
 void GameEngine::PaintDoubleBuffered(HDC hDC)
 {
+	// the overlay changes every frame and sits on top of whatever the game draws
+	if (m_ShowProfilerOverlay) m_DamageFull = true;
+
+	// with damage tracking a frame the game declared and left clean needs no paint and no copy,
+	// the buffer and the window still hold the previous frame
+	const bool isDamageDeclared{ m_DamageTracking && m_DamageDeclared && !m_DamageFull };
+	if (isDamageDeclared && m_DamageRects.empty())
+	{
+		++m_SkippedFrames;
+		ResetDamage();
+		return;
+	}
+
+	// GDI clips to the damaged rectangles, the software renderer has no clipping and redraws everything
+	m_IsClippingDamage = isDamageDeclared && !m_RenderBackendPtr;
+	if (m_IsClippingDamage)
+	{
+		HRGN hDamageRgn = CreateRectRgnIndirect(&m_DamageRects[0]);
+		for (size_t index{ 1 }; index < m_DamageRects.size(); ++index)
+		{
+			HRGN hRectRgn = CreateRectRgnIndirect(&m_DamageRects[index]);
+			CombineRgn(hDamageRgn, hDamageRgn, hRectRgn, RGN_OR);
+			DeleteObject(hRectRgn);
+		}
+		SelectClipRgn(m_HdcDraw, hDamageRgn);	// the DC keeps its own copy
+		DeleteObject(hDamageRgn);
+	}
+
 	m_IsPainting = true;
-	m_GamePtr->Paint(m_RectDraw);
+	{
+		FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Draw };
+		m_GamePtr->Paint(m_RectDraw);
+	}
+	if (m_ShowProfilerOverlay) DrawProfilerOverlay();
+	{
+		FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Flush };
+		FlushDrawCommands();
+	}
 	m_IsPainting = false;
 
-	// As a last step copy the buffer DC to the window DC
-	BitBlt(hDC, 0, 0, m_Width, m_Height, m_HdcDraw, 0, 0, SRCCOPY);
+	if (m_IsClippingDamage) SelectClipRgn(m_HdcDraw, NULL);
+
+	const bool isPartial{ m_IsClippingDamage };
+	m_IsClippingDamage = false;
+
+	if (hDC == NULL)
+	{
+		ResetDamage();
+		return;
+	}
+
+	if (isPartial)
+	{
+		FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Present };
+		for (const RECT& rect : m_DamageRects)
+		{
+			BitBlt(hDC, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top, m_HdcDraw, rect.left, rect.top, SRCCOPY);
+		}
+		ResetDamage();
+		return;
+	}
+	ResetDamage();
+
+	// As a last step copy the buffer to the window DC
+	PresentBuffer(hDC);
+}
+
+void GameEngine::PresentBuffer(HDC hDC)
+{
+	FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Present };
+
+	if (m_RenderBackendPtr)
+	{
+		BITMAPINFO bmi{};
+		bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+		bmi.bmiHeader.biWidth		= m_RenderBackendPtr->GetWidth();
+		bmi.bmiHeader.biHeight		= -m_RenderBackendPtr->GetHeight();		// top-down framebuffer
+		bmi.bmiHeader.biPlanes		= 1;
+		bmi.bmiHeader.biBitCount	= 32;
+		bmi.bmiHeader.biCompression = BI_RGB;
+
+		SetDIBitsToDevice(hDC, 0, 0, m_RenderBackendPtr->GetWidth(), m_RenderBackendPtr->GetHeight(), 0, 0, 0, m_RenderBackendPtr->GetHeight(), 
+			m_RenderBackendPtr->GetFramebuffer(), &bmi, DIB_RGB_COLORS);
+	}
+	else BitBlt(hDC, 0, 0, m_Width, m_Height, m_HdcDraw, 0, 0, SRCCOPY);
+}
+
+void GameEngine::SimulationLoop()
+{
+	s_IsSimulationThread = true;
+
+	FrameClock clock{};
+	StartFrameClock(clock);
+
+	while (!m_StopSimulation.load(memory_order_acquire))
+	{
+		double frameTime{};
+		if (!IsFrameDue(clock, frameTime))
+		{
+			m_FramePacer.WaitUntil(clock.trigger);
+			continue;
+		}
+
+		RunFrame(frameTime);
+		MonitorKeyboard();
+	}
+}
+
+void GameEngine::StopSimulation()
+{
+	if (!IsSimulationRunning()) return;
+
+	m_StopSimulation.store(true, memory_order_release);
+
+	// SetWindowText, SetWindowPos and MoveWindow from the simulation thread send a message to this window and wait
+	// for this thread to handle it, so a plain join could deadlock: sent messages are handled until the thread is gone
+	HANDLE hThread = m_SimulationThread.native_handle();
+	while (MsgWaitForMultipleObjects(1, &hThread, FALSE, INFINITE, QS_SENDMESSAGE) == WAIT_OBJECT_0 + 1)
+	{
+		MSG msg;
+		PeekMessage(&msg, NULL, 0, 0, PM_NOREMOVE | PM_QS_SENDMESSAGE);
+	}
+
+	m_SimulationThread.join();
+
+	// nothing is presented any more
+	DeletePendingObjects(UINT64_MAX);
+}
+
+bool GameEngine::QueueEvent(UINT msg, WPARAM wParam, LPARAM lParam)
+{
+	EngineEvent event{};
+	event.x			= (int16_t) GET_X_LPARAM(lParam);
+	event.y			= (int16_t) GET_Y_LPARAM(lParam);
+	event.modifiers	= LOWORD(wParam);
+
+	// the mouse is handled here, keys and focus still go on to DefWindowProc
+	bool isHandled{ true };
+	switch (msg)
+	{
+		case WM_LBUTTONDOWN:	event.type = EngineEvent::Type::MouseButton;	event.isLeft = true;	event.isDown = true;	break;
+		case WM_LBUTTONUP:		event.type = EngineEvent::Type::MouseButton;	event.isLeft = true;							break;
+		case WM_RBUTTONDOWN:	event.type = EngineEvent::Type::MouseButton;							event.isDown = true;	break;
+		case WM_RBUTTONUP:		event.type = EngineEvent::Type::MouseButton;													break;
+		case WM_MOUSEWHEEL:		event.type = EngineEvent::Type::MouseWheel;		event.distance = (int16_t) HIWORD(wParam);		break;
+		case WM_MOUSEMOVE:		event.type = EngineEvent::Type::MouseMove;														break;
+		case WM_KEYDOWN:
+		case WM_KEYUP:
+			event = EngineEvent{};
+			event.type		= msg == WM_KEYDOWN ? EngineEvent::Type::KeyDown : EngineEvent::Type::KeyUp;
+			event.key		= (uint16_t) wParam;
+			event.isRepeat	= msg == WM_KEYDOWN && (lParam & (1 << 30)) != 0;		// bit 30 holds the previous key state
+			isHandled		= false;
+			break;
+		case WM_SETFOCUS:
+		case WM_KILLFOCUS:
+			event = EngineEvent{};
+			event.type		= msg == WM_SETFOCUS ? EngineEvent::Type::FocusGained : EngineEvent::Type::FocusLost;
+			isHandled		= false;
+			break;
+		default:				return false;
+	}
+
+	m_EventQueue.Push(event);
+	return isHandled;
+}
+
+void GameEngine::DispatchEvents()
+{
+	m_EventQueue.Drain(m_TickEvents);
+
+	// the game gets the mouse as before, only less of it, the keys and the focus are only in GetEvents
+	for (const EngineEvent& event : m_TickEvents)
+	{
+		const WPARAM wParam{ MAKEWPARAM(event.modifiers, event.distance) };
+		switch (event.type)
+		{
+			case EngineEvent::Type::MouseButton:	m_GamePtr->MouseButtonAction(event.isLeft, event.isDown, event.x, event.y, wParam);		break;
+			case EngineEvent::Type::MouseWheel:		m_GamePtr->MouseWheelAction(event.x, event.y, event.distance, wParam);					break;
+			case EngineEvent::Type::MouseMove:		m_GamePtr->MouseMove(event.x, event.y, wParam);											break;
+			default:																														break;
+		}
+	}
+}
+
+void GameEngine::RecordSnapshot()
+{
+	if (m_ShowProfilerOverlay) m_DamageFull = true;
+
+	// a frame the game declared unchanged is not recorded, the window keeps showing the last one
+	const bool isUnchanged{ m_DamageTracking && m_DamageDeclared && !m_DamageFull && m_DamageRects.empty() };
+	ResetDamage();
+	if (isUnchanged)
+	{
+		++m_SkippedFrames;
+		return;
+	}
+
+	FrameSnapshot& snapshot = m_Snapshots.GetBack();
+	snapshot.sequence = ++m_RecordSequence;
+	snapshot.commands.Clear();
+	snapshot.texts.clear();
+	snapshot.bitmaps.clear();
+
+	m_RecordSnapshotPtr = &snapshot;
+	{
+		FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Draw };
+		m_GamePtr->Paint(m_RectDraw);
+	}
+	if (m_ShowProfilerOverlay) DrawProfilerOverlay();
+	m_RecordSnapshotPtr = nullptr;
+
+	m_Snapshots.Publish();
+	SetEvent(m_SnapshotReady);
+}
+
+void GameEngine::PresentSnapshot(HDC hDC)
+{
+	// snapshots always hold a whole frame, there is no damage to clip to
+	FrameSnapshot& snapshot = m_Snapshots.GetFront();
+
+	m_ReplaySnapshotPtr = &snapshot;
+	m_IsPainting = true;
+	{
+		FrameProfiler::Scope scope{ m_Profiler, FrameProfiler::Phase::Flush };
+		SubmitDrawCommands(snapshot.commands);
+	}
+	m_IsPainting = false;
+	m_ReplaySnapshotPtr = nullptr;
+
+	PresentBuffer(hDC);
+
+	// snapshots older than this one are never presented any more, the triple buffer drops them
+	DeletePendingObjects(snapshot.sequence);
+}
+
+bool GameEngine::RecordToSnapshot(DrawCommandType type, int left, int top, int right, int bottom, int param1, int param2, int opacity) const
+{
+	if (m_RecordSnapshotPtr == nullptr) return false;		// not painting
+
+	m_RecordSnapshotPtr->commands.Add(DrawCommand{ type, (uint8_t)clamp(opacity, 0, 255), m_RecordColor, left, top, right, bottom, param1, param2 });
+	return true;
+}
+
+int GameEngine::RecordText(const tstring& text, int left, int top, int right, int bottom, bool isRect) const
+{
+	if (m_RecordSnapshotPtr == nullptr) return -1;
+
+	m_RecordSnapshotPtr->texts.push_back(RecordedText{ text, m_RecordFont });
+	RecordToSnapshot(DrawCommandType::Text, left, top, right, bottom, (int)m_RecordSnapshotPtr->texts.size() - 1, isRect ? 1 : 0);
+
+	return 1;		// the real result is only known when the text is drawn
+}
+
+bool GameEngine::RecordBitmap(const Bitmap* bitmapPtr, int left, int top, RECT sourceRect) const
+{
+	if (m_RecordSnapshotPtr == nullptr) return false;
+
+	// the destination rectangle lets the batching move other commands around the bitmap
+	m_RecordSnapshotPtr->bitmaps.push_back(RecordedBitmap{ bitmapPtr, sourceRect });
+	return RecordToSnapshot(DrawCommandType::Bitmap, left, top, left + sourceRect.right - sourceRect.left, top + sourceRect.bottom - sourceRect.top,
+							(int)m_RecordSnapshotPtr->bitmaps.size() - 1);
+}
+
+void GameEngine::DeleteBitmap(const Bitmap* bitmapPtr)
+{
+	// only the simulation thread records bitmaps, on any other thread no snapshot can refer to this one
+	if (!IsSimulationThread())
+	{
+		delete bitmapPtr;
+		return;
+	}
+
+	lock_guard<mutex> lock{ m_PendingObjectsMutex };
+	m_PendingObjects.push_back(PendingObject{ bitmapPtr, nullptr, m_RecordSequence });
+}
+
+void GameEngine::DeleteFont(const Font* fontPtr)
+{
+	// the font set on this thread falls back to the default, the handle is about to die
+	HFONT& fontDraw = IsSimulationThread() ? m_RecordFont : m_FontDraw;
+	if (fontDraw == fontPtr->GetHandle()) fontDraw = NULL;
+
+	// recorded texts hold the handle, same as the bitmaps
+	if (!IsSimulationThread())
+	{
+		delete fontPtr;
+		return;
+	}
+
+	lock_guard<mutex> lock{ m_PendingObjectsMutex };
+	m_PendingObjects.push_back(PendingObject{ nullptr, fontPtr, m_RecordSequence });
+}
+
+void GameEngine::DeletePendingObjects(uint64_t presentedSequence)
+{
+	lock_guard<mutex> lock{ m_PendingObjectsMutex };
+	erase_if(m_PendingObjects, [presentedSequence](const PendingObject& pending)
+	{
+		if (pending.sequence > presentedSequence) return false;
+
+		delete pending.bitmapPtr;
+		delete pending.fontPtr;
+		return true;
+	});
 }
 
 void GameEngine::ShowMousePointer(bool value)
@@ -357,12 +843,15 @@ bool GameEngine::IsKeyDown(int vKey) const
 
 void GameEngine::SetKeyList(const tstring& keyList)
 {
-	delete m_KeyListPtr; // clear list if one already exists
+	// clear list if one already exists, the monitor bits belonged to its keys
+	delete[] m_KeyListPtr;
+	m_KeyListPtr = nullptr;
+	m_KeybMonitor = 0;
 
 	// make keylist if needed
 	if (keyList.size() > 0)
 	{
-		m_KeyListPtr = (TCHAR*)malloc((keyList.size() + 1) * sizeof(TCHAR)); // make place for this amount of keys + 1
+		m_KeyListPtr = new TCHAR[keyList.size() + 1]; // make place for this amount of keys + 1
 
 		for (int count{}; count < (int)keyList.size() + 1; ++count)
 		{
@@ -378,6 +867,17 @@ void GameEngine::SetFrameRate(int frameRate)
 	m_FrameDelay = 1000 / frameRate;
 }
 
+void GameEngine::SetFixedTimestep(int tickRate)
+{
+	m_TickRate = max(tickRate, 0);
+	m_TickAccumulator = 0;
+}
+
+void GameEngine::SetMaxCatchUpTicks(int maxTicks)
+{
+	m_MaxCatchUpTicks = max(maxTicks, 1);
+}
+
 void GameEngine::SetWidth(int width) 
 {
 	m_Width = width; 
@@ -499,15 +999,63 @@ SIZE GameEngine::CalculateTextDimensions(const tstring& text, const Font* fontPt
 
 bool GameEngine::DrawLine(int x1, int y1, int x2, int y2) const
 {
+	CountDrawCall(FrameProfiler::DrawCall::Line);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::Line, x1, y1, x2, y2);
+
 	if (m_IsPainting)
 	{
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+		if (IsOutsideDamage(min(x1, x2), min(y1, y2), max(x1, x2) + 1, max(y1, y2) + 1)) return true;
+
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::Line, x1, y1, x2, y2);
+			return true;
+		}
+
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->DrawLine(x1, y1, x2, y2);
+			return true;
+		}
+
 		MoveToEx(m_HdcDraw, x1, y1, nullptr);
 		LineTo(m_HdcDraw, x2, y2);
 		MoveToEx(m_HdcDraw, 0, 0, nullptr); // reset the position - sees to it that eg. AngleArc draws from 0,0 instead of the last position of DrawLine
-		SelectObject(m_HdcDraw, hOldPen);
-		DeleteObject(hNewPen);
+
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::DrawLines(const float coordsArr[], int count) const
+{
+	if (IsSimulationThread() || m_IsPainting)
+	{
+		if (count <= 0) return true;
+
+		// recorded lines are batched at the flush, the others go to GDI in a single PolyPolyline right away
+		if (IsSimulationThread() || IsRecording() || m_RenderBackendPtr)
+		{
+			for (int index{}; index < count; ++index)
+			{
+				const float* lineArr = coordsArr + index * 4;
+				DrawLine((int)lineArr[0], (int)lineArr[1], (int)lineArr[2], (int)lineArr[3]);
+			}
+			return true;
+		}
+
+		m_LinePoints.clear();
+		m_LineCounts.assign(count, 2);
+
+		for (int index{}; index < count; ++index)
+		{
+			const float* lineArr = coordsArr + index * 4;
+			m_LinePoints.push_back({ (int)lineArr[0], (int)lineArr[1] });
+			m_LinePoints.push_back({ (int)lineArr[2], (int)lineArr[3] });
+		}
+
+		CountDrawCall(FrameProfiler::DrawCall::Line, count);
+		PolyPolyline(m_HdcDraw, m_LinePoints.data(), m_LineCounts.data(), count);
 
 		return true;
 	}
@@ -521,15 +1069,20 @@ bool GameEngine::DrawPolygon(const POINT ptsArr[], int count) const
 
 bool GameEngine::DrawPolygon(const POINT ptsArr[], int count, bool close) const
 {
+	CountDrawCall(FrameProfiler::DrawCall::Polygon);
+	if (IsSimulationThread()) return false;		// polygons can not be recorded into snapshots
+
 	if (m_IsPainting) 
 	{	
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+		FlushDrawCommands();	// polygons are not recorded, everything before them has to be drawn first
 
-		FormPolygon(ptsArr, count, close);
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->DrawPolygon(reinterpret_cast<const RenderPoint*>(ptsArr), count, close);
+			return true;
+		}
 
-		SelectObject(m_HdcDraw, hOldPen);
-		DeleteObject(hNewPen);
+		FormPolygon(ptsArr, count, close);
 
 		return true;
 	}
@@ -543,12 +1096,19 @@ bool GameEngine::FillPolygon(const POINT ptsArr[], int count) const
 
 bool GameEngine::FillPolygon(const POINT ptsArr[], int count, bool close) const
 {
+	CountDrawCall(FrameProfiler::DrawCall::FillPolygon);
+	if (IsSimulationThread()) return false;		// polygons can not be recorded into snapshots
+
 	if (m_IsPainting)
 	{
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
-		HBRUSH hOldBrush, hNewBrush = CreateSolidBrush(m_ColDraw);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
-		hOldBrush = (HBRUSH)SelectObject(m_HdcDraw, hNewBrush);
+		FlushDrawCommands();	// polygons are not recorded, everything before them has to be drawn first
+
+		if (m_RenderBackendPtr)
+		{
+			// StrokeAndFillPath closes the figure anyway
+			m_RenderBackendPtr->FillPolygon(reinterpret_cast<const RenderPoint*>(ptsArr), count);
+			return true;
+		}
 
 		BeginPath(m_HdcDraw);
 
@@ -557,12 +1117,6 @@ bool GameEngine::FillPolygon(const POINT ptsArr[], int count, bool close) const
 		EndPath(m_HdcDraw);
 		StrokeAndFillPath(m_HdcDraw);
 
-		SelectObject(m_HdcDraw, hOldPen);
-		SelectObject(m_HdcDraw, hOldBrush);
-
-		DeleteObject(hNewPen);
-		DeleteObject(hNewBrush);
-
 		return true;
 	}
 	else return false;
@@ -585,16 +1139,28 @@ void GameEngine::FormPolygon(const POINT ptsArr[], int count, bool close) const
 
 bool GameEngine::DrawRect(int left, int top, int right, int bottom) const
 {
+	CountDrawCall(FrameProfiler::DrawCall::Rect);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::Rect, left, top, right, bottom);
+
 	if (m_IsPainting)
 	{
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
 
-		POINT pts[4] = { left, top, right - 1, top, right - 1, bottom - 1, left, bottom - 1 };
-		DrawPolygon(pts, 4, true);
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::Rect, left, top, right, bottom);
+			return true;
+		}
 
-		SelectObject(m_HdcDraw, hOldPen);
-		DeleteObject(hNewPen);
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->DrawRect(left, top, right, bottom);
+			return true;
+		}
+
+		// straight to GDI, DrawPolygon would count the call a second time
+		POINT pts[4] = { left, top, right - 1, top, right - 1, bottom - 1, left, bottom - 1 };
+		FormPolygon(pts, 4, true);
 
 		return true;
 	}
@@ -603,274 +1169,637 @@ bool GameEngine::DrawRect(int left, int top, int right, int bottom) const
 
 bool GameEngine::FillRect(int left, int top, int right, int bottom) const
 {
+	CountDrawCall(FrameProfiler::DrawCall::FillRect);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::FillRect, left, top, right, bottom);
+
 	if (m_IsPainting)
 	{
-		HBRUSH hOldBrush, hNewBrush = CreateSolidBrush(m_ColDraw);
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
+
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::FillRect, left, top, right, bottom);
+			return true;
+		}
 
-		hOldBrush = (HBRUSH)SelectObject(m_HdcDraw, hNewBrush);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->FillRect(left, top, right, bottom, 255);
+			return true;
+		}
 
 		Rectangle(m_HdcDraw, left, top, right, bottom);
 
-		SelectObject(m_HdcDraw, hOldPen);
-		SelectObject(m_HdcDraw, hOldBrush);
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::FillRect(int left, int top, int right, int bottom, int opacity) const
+{
+	// full opacity is a plain fill, nothing to blend
+	if (opacity >= 255) return FillRect(left, top, right, bottom);
+
+	CountDrawCall(FrameProfiler::DrawCall::FillRect);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::FillRect, left, top, right, bottom, 0, 0, opacity);
+
+	if (m_IsPainting)
+	{
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
+
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::FillRect, left, top, right, bottom, 0, 0, opacity);
+			return true;
+		}
+
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->FillRect(left, top, right, bottom, opacity);
+			return true;
+		}
+
+		const int width { right - left };
+		const int height{ bottom - top };
+		if (opacity <= 0 || width <= 0 || height <= 0) return true;
+
+		if (!EnsureScratchSurface(width, height)) return false;
+
+		// fill the top left corner of the scratch surface with the draw color
+		const DWORD pixel{ (DWORD)GetRValue(m_ColDraw) << 16 | (DWORD)GetGValue(m_ColDraw) << 8 | GetBValue(m_ColDraw) };
+		for (int row{}; row < height; ++row)
+		{
+			uint32_t* rowPtr = m_ScratchPixelsPtr + row * m_ScratchWidth;
+			std::fill(rowPtr, rowPtr + width, pixel);
+		}
+
+		BLENDFUNCTION blend = { AC_SRC_OVER, 0, (BYTE)opacity, 0 };
+		AlphaBlend(m_HdcDraw, left, top, width, height, m_ScratchDC, 0, 0, width, height, blend);
+
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::FillRects(const float coordsArr[], int count, int opacity) const
+{
+	if (IsSimulationThread() || m_IsPainting)
+	{
+		// the per rect path already culls, records and batches, only the call overhead from Lua is saved
+		for (int index{}; index < count; ++index)
+		{
+			const float* rectArr = coordsArr + index * 4;
+			FillRect((int)rectArr[0], (int)rectArr[1], (int)rectArr[2], (int)rectArr[3], opacity);
+		}
+
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::DrawRoundRect(int left, int top, int right, int bottom, int radius) const
+{
+	CountDrawCall(FrameProfiler::DrawCall::RoundRect);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::RoundRect, left, top, right, bottom, radius);
+
+	if (m_IsPainting)
+	{
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
+
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::RoundRect, left, top, right, bottom, radius);
+			return true;
+		}
+
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->DrawRoundRect(left, top, right, bottom, radius);
+			return true;
+		}
+
+		BeginPath(m_HdcDraw);
+
+		RoundRect(m_HdcDraw, left, top, right, bottom, radius, radius);
+
+		EndPath(m_HdcDraw);
+		StrokePath(m_HdcDraw);
 
-		DeleteObject(hNewPen);
-		DeleteObject(hNewBrush);
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::FillRoundRect(int left, int top, int right, int bottom, int radius) const
+{
+	CountDrawCall(FrameProfiler::DrawCall::FillRoundRect);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::FillRoundRect, left, top, right, bottom, radius);
+
+	if (m_IsPainting) 
+	{
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
+
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::FillRoundRect, left, top, right, bottom, radius);
+			return true;
+		}
+
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->FillRoundRect(left, top, right, bottom, radius);
+			return true;
+		}
+
+		RoundRect(m_HdcDraw, left, top, right, bottom, radius, radius);
+
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::DrawOval(int left, int top, int right, int bottom) const
+{
+	CountDrawCall(FrameProfiler::DrawCall::Oval);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::Oval, left, top, right, bottom);
+
+	if (m_IsPainting)
+	{
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
+
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::Oval, left, top, right, bottom);
+			return true;
+		}
+
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->DrawOval(left, top, right, bottom);
+			return true;
+		}
+
+		Arc(m_HdcDraw, left, top, right, bottom, left, top + (bottom - top) / 2, left, top + (bottom - top) / 2);
+
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::FillOval(int left, int top, int right, int bottom) const
+{
+	CountDrawCall(FrameProfiler::DrawCall::FillOval);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::FillOval, left, top, right, bottom);
+
+	if (m_IsPainting)
+	{
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
+
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::FillOval, left, top, right, bottom);
+			return true;
+		}
+
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->FillOval(left, top, right, bottom, 255);
+			return true;
+		}
+
+		Ellipse(m_HdcDraw, left, top, right, bottom);
+
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::FillOval(int left, int top, int right, int bottom, int opacity) const
+{
+	CountDrawCall(FrameProfiler::DrawCall::FillOval);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::FillOval, left, top, right, bottom, 0, 0, opacity);
+
+	if (m_IsPainting)
+	{
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
+
+		if (IsRecording())
+		{
+			RecordCommand(DrawCommandType::FillOval, left, top, right, bottom, 0, 0, opacity);
+			return true;
+		}
+
+		if (m_RenderBackendPtr)
+		{
+			m_RenderBackendPtr->FillOval(left, top, right, bottom, opacity);
+			return true;
+		}
+
+		// black would be indistinguishable from the cleared background
+		COLORREF color = m_ColDraw;
+		if (color == RGB(0, 0, 0)) color = RGB(0, 0, 1);
+
+		const int width { right - left };
+		const int height{ bottom - top };
+		if (opacity <= 0 || width <= 0 || height <= 0) return true;
+
+		if (!EnsureScratchSurface(width, height)) return false;
+
+		for (int row{}; row < height; ++row)
+		{
+			uint32_t* rowPtr = m_ScratchPixelsPtr + row * m_ScratchWidth;
+			std::fill(rowPtr, rowPtr + width, 0);
+		}
+
+		// the scratch DC has the DC pen and brush selected, so changing their color allocates nothing
+		SetDCPenColor(m_ScratchDC, color);
+		SetDCBrushColor(m_ScratchDC, color);
+		Ellipse(m_ScratchDC, 0, 0, width, height);
+		GdiFlush();		// the ellipse has to be in the pixels before they are read
+
+		// set the alpha channel of the ellipse pixels and premultiply them
+		for (int row{}; row < height; ++row)
+		{
+			PixelKernels::PremultiplyByOpacity(m_ScratchPixelsPtr + row * m_ScratchWidth, width, (uint8_t)opacity);
+		}
+
+		BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
+		AlphaBlend(m_HdcDraw, left, top, width, height, m_ScratchDC, 0, 0, width, height, blend);
+
+		return true;
+	}
+	else return false;
+}
+
+bool GameEngine::DrawArc(int left, int top, int right, int bottom, int startDegree, int angle) const
+{
+	CountDrawCall(FrameProfiler::DrawCall::Arc);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::Arc, left, top, right, bottom, startDegree, angle);
+
+	if (m_IsPainting)
+	{
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
+
+		if (angle == 0) return false;
+		if (angle > 360)
+		{
+			// the whole oval, drawn here since DrawOval would count the call a second time
+			if (IsRecording()) RecordCommand(DrawCommandType::Oval, left, top, right, bottom);
+			else if (m_RenderBackendPtr) m_RenderBackendPtr->DrawOval(left, top, right, bottom);
+			else Arc(m_HdcDraw, left, top, right, bottom, left, top + (bottom - top) / 2, left, top + (bottom - top) / 2);
+		}
+		else if (IsRecording()) RecordCommand(DrawCommandType::Arc, left, top, right, bottom, startDegree, angle);
+		else if (m_RenderBackendPtr) m_RenderBackendPtr->DrawArc(left, top, right, bottom, startDegree, angle);
+		else
+		{
+			POINT ptStart = AngleToPoint(left, top, right, bottom, startDegree);
+			POINT ptEnd = AngleToPoint(left, top, right, bottom, startDegree + angle);
+
+			if (angle > 0) Arc(m_HdcDraw, left, top, right, bottom, ptStart.x, ptStart.y, ptEnd.x, ptEnd.y);
+			else Arc(m_HdcDraw, left, top, right, bottom, ptEnd.x, ptEnd.y, ptStart.x, ptStart.y);
+		}
 
 		return true;
 	}
 	else return false;
 }
 
-bool GameEngine::FillRect(int left, int top, int right, int bottom, int opacity) const
+bool GameEngine::FillArc(int left, int top, int right, int bottom, int startDegree, int angle) const
 {
+	CountDrawCall(FrameProfiler::DrawCall::FillArc);
+	if (IsSimulationThread()) return RecordToSnapshot(DrawCommandType::FillArc, left, top, right, bottom, startDegree, angle);
+
 	if (m_IsPainting)
 	{
-		HDC tempHdc = CreateCompatibleDC(m_HdcDraw);
-		BLENDFUNCTION blend = { AC_SRC_OVER, 0, (BYTE)opacity, 0 };
-
-		RECT dim{};
-		dim.right = right - left;
-		dim.bottom = bottom - top;
-
-		// setup bitmap info   
-		BITMAPINFO bmi{};
-		bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-		bmi.bmiHeader.biWidth = dim.right;
-		bmi.bmiHeader.biHeight = dim.bottom;
-		bmi.bmiHeader.biPlanes = 1;
-		bmi.bmiHeader.biBitCount = 32;         // four 8-bit components 
-		bmi.bmiHeader.biCompression = BI_RGB;
-		bmi.bmiHeader.biSizeImage = dim.right * dim.bottom * 4;
+		if (IsOutsideDamage(left, top, right, bottom)) return true;
 
-		// create our DIB section and select the bitmap into the dc 
-		HBITMAP hbitmap = CreateDIBSection(tempHdc, &bmi, DIB_RGB_COLORS, nullptr, NULL, 0x0);
-		SelectObject(tempHdc, hbitmap);
-
-		HBRUSH fillBrush = CreateSolidBrush(m_ColDraw);
-		::FillRect(tempHdc, &dim, fillBrush);
-
-		AlphaBlend(m_HdcDraw, left, top, dim.right, dim.bottom, tempHdc, dim.left, dim.top, dim.right, dim.bottom, blend);
+		if (angle == 0) return false;
+		if (angle > 360)
+		{
+			// the whole oval, drawn here since FillOval would count the call a second time
+			if (IsRecording()) RecordCommand(DrawCommandType::FillOval, left, top, right, bottom);
+			else if (m_RenderBackendPtr) m_RenderBackendPtr->FillOval(left, top, right, bottom, 255);
+			else Ellipse(m_HdcDraw, left, top, right, bottom);
+		}
+		else if (IsRecording()) RecordCommand(DrawCommandType::FillArc, left, top, right, bottom, startDegree, angle);
+		else if (m_RenderBackendPtr) m_RenderBackendPtr->FillArc(left, top, right, bottom, startDegree, angle);
+		else
+		{
+			POINT ptStart = AngleToPoint(left, top, right, bottom, startDegree);
+			POINT ptEnd = AngleToPoint(left, top, right, bottom, startDegree + angle);
 
-		DeleteObject(fillBrush);
-		DeleteObject(hbitmap);
-		DeleteObject(tempHdc);
+			if (angle > 0) Pie(m_HdcDraw, left, top, right, bottom, ptStart.x, ptStart.y, ptEnd.x, ptEnd.y);
+			else Pie(m_HdcDraw, left, top, right, bottom, ptEnd.x, ptEnd.y, ptStart.x, ptStart.y);
+		}
 
 		return true;
 	}
 	else return false;
 }
 
-bool GameEngine::DrawRoundRect(int left, int top, int right, int bottom, int radius) const
+void GameEngine::SetDrawBuffering(bool enable)
 {
-	if (m_IsPainting)
-	{
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+	if (IsSimulationThread()) return;		// snapshots are always recorded
 
-		BeginPath(m_HdcDraw);
+	// draw what was recorded so far when buffering is switched off in the middle of a frame
+	if (!enable) FlushDrawCommands();
 
-		RoundRect(m_HdcDraw, left, top, right, bottom, radius, radius);
+	m_DrawBuffering = enable;
+}
 
-		EndPath(m_HdcDraw);
-		StrokePath(m_HdcDraw);
+void GameEngine::SetDamageTracking(bool enable)
+{
+	m_DamageTracking = enable;
+	ResetDamage();
+	m_DamageFull = true;	// the first frame after switching draws everything
+}
 
-		SelectObject(m_HdcDraw, hOldPen);
-		DeleteObject(hNewPen);
+void GameEngine::Invalidate(int left, int top, int right, int bottom)
+{
+	if (!m_DamageTracking) return;
 
-		return true;
+	m_DamageDeclared = true;
+
+	RECT rect{ max(min(left, right), 0), max(min(top, bottom), 0), min(max(left, right), m_Width), min(max(top, bottom), m_Height) };
+	if (rect.left >= rect.right || rect.top >= rect.bottom) return;
+
+	// a rectangle inside the last one adds nothing, the common case of the same area invalidated twice
+	if (!m_DamageRects.empty())
+	{
+		const RECT& last = m_DamageRects.back();
+		if (rect.left >= last.left && rect.top >= last.top && rect.right <= last.right && rect.bottom <= last.bottom) return;
 	}
-	else return false;
-}
 
-bool GameEngine::FillRoundRect(int left, int top, int right, int bottom, int radius) const
-{
-	if (m_IsPainting) 
+	// past this many rectangles the region costs more than it saves
+	if (m_DamageRects.size() >= MAX_DAMAGE_RECTS)
 	{
-		HBRUSH hOldBrush, hNewBrush = CreateSolidBrush(m_ColDraw);
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
+		m_DamageFull = true;
+		return;
+	}
 
-		hOldBrush = (HBRUSH)SelectObject(m_HdcDraw, hNewBrush);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+	m_DamageRects.push_back(rect);
+}
 
-		RoundRect(m_HdcDraw, left, top, right, bottom, radius, radius);
+void GameEngine::InvalidateAll()
+{
+	if (!m_DamageTracking) return;
 
-		SelectObject(m_HdcDraw, hOldPen);
-		SelectObject(m_HdcDraw, hOldBrush);
+	m_DamageDeclared = true;
+	m_DamageFull = true;
+}
 
-		DeleteObject(hNewPen);
-		DeleteObject(hNewBrush);
+void GameEngine::SetFrameUnchanged()
+{
+	if (!m_DamageTracking) return;
 
-		return true;
-	}
-	else return false;
+	m_DamageDeclared = true;
 }
 
-bool GameEngine::DrawOval(int left, int top, int right, int bottom) const
+bool GameEngine::IsOutsideDamage(int left, int top, int right, int bottom) const
 {
-	if (m_IsPainting)
-	{
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+	if (!m_IsClippingDamage) return false;
 
-		Arc(m_HdcDraw, left, top, right, bottom, left, top + (bottom - top) / 2, left, top + (bottom - top) / 2);
-
-		SelectObject(m_HdcDraw, hOldPen);
-		DeleteObject(hNewPen);
+	if (left > right) swap(left, right);
+	if (top > bottom) swap(top, bottom);
 
-		return true;
+	for (const RECT& rect : m_DamageRects)
+	{
+		if (left < rect.right && rect.left < right && top < rect.bottom && rect.top < bottom) return false;
 	}
-	else return false;
+	return true;
 }
 
-bool GameEngine::FillOval(int left, int top, int right, int bottom) const
+void GameEngine::ResetDamage()
 {
-	if (m_IsPainting)
-	{
-		HBRUSH hOldBrush, hNewBrush = CreateSolidBrush(m_ColDraw);
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
+	m_DamageRects.clear();
+	m_DamageDeclared = false;
+	m_DamageFull = false;
+}
+
+void GameEngine::CountDrawCall(FrameProfiler::DrawCall drawCall, int count) const
+{
+	// replaying recorded commands draws them a second time, the window thread never reads the flag in threaded mode
+	if (IsSimulationThread() || !m_IsFlushing) m_Profiler.CountDrawCall(drawCall, count);
+}
+
+void GameEngine::DrawProfilerOverlay()
+{
+	static const int LINE_HEIGHT{ 16 };
+	static const int OVERLAY_WIDTH{ 360 };
 
-		hOldBrush = (HBRUSH)SelectObject(m_HdcDraw, hNewBrush);
-		hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+	// the overlay's own calls are not counted, and it uses the default font so the game's font size does not matter
+	m_Profiler.PauseCounting(true);
+	HFONT& fontDraw = IsSimulationThread() ? m_RecordFont : m_FontDraw;
+	const HFONT oldFont{ fontDraw };
+	const COLORREF oldColor{ GetDrawColor() };
+	fontDraw = NULL;
 
-		Ellipse(m_HdcDraw, left, top, right, bottom);
+	const int drawCallLines{ 2 };
+	FillRect(0, 0, OVERLAY_WIDTH, (FrameProfiler::PHASE_COUNT + drawCallLines) * LINE_HEIGHT + 8, 192);
+	SetColor(RGB(255, 255, 255));
 
-		SelectObject(m_HdcDraw, hOldPen);
-		SelectObject(m_HdcDraw, hOldBrush);
+	TCHAR lineArr[160];
+	int top{ 4 };
+	for (int phase{}; phase < FrameProfiler::PHASE_COUNT; ++phase)
+	{
+		const FrameProfiler::PhaseStats stats{ m_Profiler.GetPhaseStats((FrameProfiler::Phase)phase) };
+		_stprintf_s(lineArr, _T("%-16hs p50 %6.2f  p99 %6.2f  max %6.2f ms"),
+			FrameProfiler::GetPhaseName((FrameProfiler::Phase)phase), stats.p50Ms, stats.p99Ms, stats.maxMs);
+		DrawString(lineArr, 4, top);
+		top += LINE_HEIGHT;
+	}
 
-		DeleteObject(hNewPen);
-		DeleteObject(hNewBrush);
+	// only the kinds of draw calls the last frame made, wrapped over two lines
+	tstring drawCalls{ _T("draw calls ") + to_tstring(m_Profiler.GetTotalDrawCalls()) + _T(":") };
+	tstring secondLine{};
+	for (int drawCall{}; drawCall < FrameProfiler::DRAW_CALL_COUNT; ++drawCall)
+	{
+		const int count{ m_Profiler.GetDrawCalls((FrameProfiler::DrawCall)drawCall) };
+		if (count == 0) continue;
 
-		return true;
+		_stprintf_s(lineArr, _T(" %hs %d"), FrameProfiler::GetDrawCallName((FrameProfiler::DrawCall)drawCall), count);
+		(drawCalls.size() < 48 ? drawCalls : secondLine) += lineArr;
 	}
-	else return false;
+	DrawString(drawCalls, 4, top);
+	if (!secondLine.empty()) DrawString(secondLine, 4, top + LINE_HEIGHT);
+
+	SetColor(oldColor);
+	fontDraw = oldFont;
+	m_Profiler.PauseCounting(false);
 }
 
-bool GameEngine::FillOval(int left, int top, int right, int bottom, int opacity) const
+void GameEngine::RecordCommand(DrawCommandType type, int left, int top, int right, int bottom, int param1, int param2, int opacity) const
 {
-	if (m_IsPainting)
-	{
-		COLORREF color = m_ColDraw;
-		if (color == RGB(0, 0, 0)) color = RGB(0, 0, 1);
-
-		HDC tempHdc = CreateCompatibleDC(m_HdcDraw);
+	m_DrawCommands.Add(DrawCommand{ type, (uint8_t)clamp(opacity, 0, 255), m_ColDraw, left, top, right, bottom, param1, param2 });
+}
 
-		RECT dim{};
-		dim.right = right - left;
-		dim.bottom = bottom - top;
+void GameEngine::FlushDrawCommands() const
+{
+	if (!IsRecording() || m_DrawCommands.IsEmpty()) return;
 
-		// setup bitmap info   
-		BITMAPINFO bmi{};
-		bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-		bmi.bmiHeader.biWidth = dim.right;
-		bmi.bmiHeader.biHeight = dim.bottom;
-		bmi.bmiHeader.biPlanes = 1;
-		bmi.bmiHeader.biBitCount = 32;         // four 8-bit components 
-		bmi.bmiHeader.biCompression = BI_RGB;
-		bmi.bmiHeader.biSizeImage = dim.right * dim.bottom * 4;
+	SubmitDrawCommands(m_DrawCommands);
+}
 
-		// create our DIB section and select the bitmap into the dc 
-		int* dataPtr = nullptr;
-		HBITMAP hbitmap = CreateDIBSection(tempHdc, &bmi, DIB_RGB_COLORS, (void**)&dataPtr, NULL, 0x0);
-		SelectObject(tempHdc, hbitmap);
+void GameEngine::SubmitDrawCommands(DrawCommandBuffer& commands) const
+{
+	// while flushing the Draw/Fill member functions draw immediately
+	m_IsFlushing = true;
 
-		memset(dataPtr, 0, dim.right * dim.bottom);
+	const COLORREF oldColor = GetDrawColor();
+	GameEngine* enginePtr = const_cast<GameEngine*>(this);
 
-		HBRUSH hOldBrush, hNewBrush = CreateSolidBrush(color);
-		HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, color);
+	commands.Sort();
+	const DrawCommand* sortedPtr = commands.GetSorted();
 
-		hOldBrush = (HBRUSH)SelectObject(tempHdc, hNewBrush);
-		hOldPen = (HPEN)SelectObject(tempHdc, hNewPen);
+	for (const DrawBatch& batch : commands.GetBatches())
+	{
+		enginePtr->SetColor(batch.color);
 
-		Ellipse(tempHdc, 0, 0, dim.right, dim.bottom);
+		const DrawCommand* commandsArr = sortedPtr + batch.first;
 
-		for (int count{}; count < dim.right * dim.bottom; ++count)
+		if (!m_RenderBackendPtr && batch.type == DrawCommandType::Line) SubmitLines(commandsArr, batch.count);
+		else if (!m_RenderBackendPtr && batch.type == DrawCommandType::FillRect && batch.opacity == 255) SubmitOpaqueRects(commandsArr, batch.count);
+		else
 		{
-			if (dataPtr[count] != 0)
-			{
-				// set alpha channel and premultiply
-				unsigned char* pos = (unsigned char*)&(dataPtr[count]);
-				pos[0] = (int)pos[0] * opacity / 255;
-				pos[1] = (int)pos[1] * opacity / 255;
-				pos[2] = (int)pos[2] * opacity / 255;
-				pos[3] = opacity;
-			}
+			for (uint32_t index{}; index < batch.count; ++index) ReplayCommand(commandsArr[index]);
 		}
+	}
 
-		SelectObject(tempHdc, hOldPen);
-		SelectObject(tempHdc, hOldBrush);
+	enginePtr->SetColor(oldColor);
+	commands.Clear();
 
-		BLENDFUNCTION blend = { AC_SRC_OVER, 0, 255, AC_SRC_ALPHA };
-		AlphaBlend(m_HdcDraw, left, top, dim.right, dim.bottom, tempHdc, dim.left, dim.top, dim.right, dim.bottom, blend);
+	m_IsFlushing = false;
+}
 
-		DeleteObject(hNewPen);
-		DeleteObject(hNewBrush);
-		DeleteObject(hbitmap);
-		DeleteObject(tempHdc);
+void GameEngine::ReplayCommand(const DrawCommand& command) const
+{
+	switch (command.type)
+	{
+		case DrawCommandType::Line:				DrawLine		(command.left, command.top, command.right, command.bottom);									break;
+		case DrawCommandType::Rect:				DrawRect		(command.left, command.top, command.right, command.bottom);									break;
+		case DrawCommandType::FillRect:			FillRect		(command.left, command.top, command.right, command.bottom, command.opacity);				break;
+		case DrawCommandType::RoundRect:		DrawRoundRect	(command.left, command.top, command.right, command.bottom, command.param1);					break;
+		case DrawCommandType::FillRoundRect:	FillRoundRect	(command.left, command.top, command.right, command.bottom, command.param1);					break;
+		case DrawCommandType::Oval:				DrawOval		(command.left, command.top, command.right, command.bottom);									break;
+		case DrawCommandType::FillOval:
+			if (command.opacity == 255)			FillOval		(command.left, command.top, command.right, command.bottom);
+			else								FillOval		(command.left, command.top, command.right, command.bottom, command.opacity);
+			break;
+		case DrawCommandType::Arc:				DrawArc			(command.left, command.top, command.right, command.bottom, command.param1, command.param2);	break;
+		case DrawCommandType::FillArc:			FillArc			(command.left, command.top, command.right, command.bottom, command.param1, command.param2);	break;
 
-		return true;
+		// only snapshots hold these
+		case DrawCommandType::Text:
+		{
+			const RecordedText& recorded = m_ReplaySnapshotPtr->texts[command.param1];
+			HFONT& fontDraw = const_cast<GameEngine*>(this)->m_FontDraw;
+			const HFONT oldFont{ fontDraw };
+
+			fontDraw = recorded.hFont;
+			if (command.param2 != 0)	DrawString(recorded.text, command.left, command.top, command.right, command.bottom);
+			else						DrawString(recorded.text, command.left, command.top);
+			fontDraw = oldFont;
+			break;
+		}
+		case DrawCommandType::Bitmap:
+		{
+			const RecordedBitmap& recorded = m_ReplaySnapshotPtr->bitmaps[command.param1];
+			DrawBitmap(recorded.bitmapPtr, command.left, command.top, recorded.sourceRect);
+			break;
+		}
 	}
-	else return false;
 }
 
-bool GameEngine::DrawArc(int left, int top, int right, int bottom, int startDegree, int angle) const
+void GameEngine::SubmitLines(const DrawCommand commandsArr[], int count) const
 {
-	if (m_IsPainting)
+	// the cached pen is already selected, one PolyPolyline call draws the whole batch
+	m_LinePoints.clear();
+	m_LineCounts.assign(count, 2);
+
+	for (int index{}; index < count; ++index)
 	{
-		if (angle == 0) return false;
-		if (angle > 360) { DrawOval(left, top, right, bottom); }
-		else
-		{
-			HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
-			hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+		m_LinePoints.push_back({ commandsArr[index].left,  commandsArr[index].top });
+		m_LinePoints.push_back({ commandsArr[index].right, commandsArr[index].bottom });
+	}
 
-			POINT ptStart = AngleToPoint(left, top, right, bottom, startDegree);
-			POINT ptEnd = AngleToPoint(left, top, right, bottom, startDegree + angle);
+	PolyPolyline(m_HdcDraw, m_LinePoints.data(), m_LineCounts.data(), count);
+}
 
-			if (angle > 0) Arc(m_HdcDraw, left, top, right, bottom, ptStart.x, ptStart.y, ptEnd.x, ptEnd.y);
-			else Arc(m_HdcDraw, left, top, right, bottom, ptEnd.x, ptEnd.y, ptStart.x, ptStart.y);
+void GameEngine::SubmitOpaqueRects(const DrawCommand commandsArr[], int count) const
+{
+	if (m_SelectedDrawObjects == -1) return;
 
-			SelectObject(m_HdcDraw, hOldPen);
-			DeleteObject(hNewPen);
-		}
+	// ::FillRect with the cached brush covers the same pixels as Rectangle with a pen of the same color
+	const HBRUSH hBrush = m_DrawObjectCache[m_SelectedDrawObjects].hBrush;
 
-		return true;
+	for (int index{}; index < count; ++index)
+	{
+		const DrawCommand& command = commandsArr[index];
+		RECT rect{	min(command.left, command.right),	min(command.top, command.bottom),
+					max(command.left, command.right),	max(command.top, command.bottom) };
+
+		::FillRect(m_HdcDraw, &rect, hBrush);
 	}
-	else return false;
 }
 
-bool GameEngine::FillArc(int left, int top, int right, int bottom, int startDegree, int angle) const
+bool GameEngine::EnsureScratchSurface(int width, int height) const
 {
-	if (m_IsPainting)
+	if (width > m_ScratchWidth || height > m_ScratchHeight)
 	{
-		if (angle == 0) return false;
-		if (angle > 360) { FillOval(left, top, right, bottom); }
-		else
-		{
-			HBRUSH hOldBrush, hNewBrush = CreateSolidBrush(m_ColDraw);
-			HPEN hOldPen, hNewPen = CreatePen(PS_SOLID, 1, m_ColDraw);
+		// grow only, the surface is shared by all alpha fills of all frames
+		const int newWidth { max(width,  m_ScratchWidth)  };
+		const int newHeight{ max(height, m_ScratchHeight) };
 
-			hOldBrush = (HBRUSH)SelectObject(m_HdcDraw, hNewBrush);
-			hOldPen = (HPEN)SelectObject(m_HdcDraw, hNewPen);
+		if (m_ScratchDC == NULL)
+		{
+			m_ScratchDC = CreateCompatibleDC(m_HdcDraw);
+			if (m_ScratchDC == NULL) return false;
 
-			POINT ptStart = AngleToPoint(left, top, right, bottom, startDegree);
-			POINT ptEnd = AngleToPoint(left, top, right, bottom, startDegree + angle);
+			SelectObject(m_ScratchDC, GetStockObject(DC_PEN));
+			SelectObject(m_ScratchDC, GetStockObject(DC_BRUSH));
+		}
 
-			if (angle > 0) Pie(m_HdcDraw, left, top, right, bottom, ptStart.x, ptStart.y, ptEnd.x, ptEnd.y);
-			else Pie(m_HdcDraw, left, top, right, bottom, ptEnd.x, ptEnd.y, ptStart.x, ptStart.y);
+		BITMAPINFO bmi{};
+		bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+		bmi.bmiHeader.biWidth		= newWidth;
+		bmi.bmiHeader.biHeight		= -newHeight;		// top-down, row 0 is the top of the surface
+		bmi.bmiHeader.biPlanes		= 1;
+		bmi.bmiHeader.biBitCount	= 32;				// four 8-bit components 
+		bmi.bmiHeader.biCompression = BI_RGB;
 
-			SelectObject(m_HdcDraw, hOldPen);
-			SelectObject(m_HdcDraw, hOldBrush);
+		uint32_t* pixelsPtr = nullptr;
+		HBITMAP hBitmap = CreateDIBSection(m_ScratchDC, &bmi, DIB_RGB_COLORS, (void**)&pixelsPtr, NULL, 0x0);
+		if (hBitmap == NULL) return false;
 
-			DeleteObject(hNewPen);
-			DeleteObject(hNewBrush);
-		}
+		HBITMAP hPreviousBitmap = (HBITMAP)SelectObject(m_ScratchDC, hBitmap);
+		if (m_hScratchBitmap != NULL) DeleteObject(m_hScratchBitmap);
+		else m_hScratchOldBitmap = hPreviousBitmap;
 
-		return true;
+		m_hScratchBitmap	= hBitmap;
+		m_ScratchPixelsPtr	= pixelsPtr;
+		m_ScratchWidth		= newWidth;
+		m_ScratchHeight		= newHeight;
 	}
-	else return false;
+
+	// pending GDI calls on the surface have to be finished before its pixels are written
+	GdiFlush();
+
+	return true;
+}
+
+void GameEngine::ReleaseScratchSurface()
+{
+	if (m_ScratchDC == NULL) return;
+
+	SelectObject(m_ScratchDC, m_hScratchOldBitmap);
+	DeleteObject(m_hScratchBitmap);
+	DeleteDC(m_ScratchDC);
+
+	m_ScratchDC			= NULL;
+	m_hScratchBitmap	= NULL;
+	m_ScratchPixelsPtr	= nullptr;
+	m_ScratchWidth		= 0;
+	m_ScratchHeight		= 0;
 }
 
 POINT GameEngine::AngleToPoint(int left, int top, int right, int bottom, int angle) const
@@ -917,8 +1846,15 @@ POINT GameEngine::AngleToPoint(int left, int top, int right, int bottom, int ang
 
 int GameEngine::DrawString(const tstring& text, int left, int top, int right, int bottom) const
 {
+	CountDrawCall(FrameProfiler::DrawCall::String);
+	if (IsSimulationThread()) return RecordText(text, left, top, right, bottom, true);
+
 	if (m_IsPainting)
 	{
+		FlushDrawCommands();	// text is not recorded, everything before it has to be drawn first
+
+		if (m_RenderBackendPtr) return 0;	// the render backends have no text support
+
 		if (m_FontDraw != NULL)
 		{
 			HFONT hOldFont = (HFONT)SelectObject(m_HdcDraw, m_FontDraw);
@@ -955,8 +1891,15 @@ int GameEngine::DrawString(const tstring& text, int left, int top, int right, in
 
 int GameEngine::DrawString(const tstring& text, int left, int top) const
 {
+	CountDrawCall(FrameProfiler::DrawCall::String);
+	if (IsSimulationThread()) return RecordText(text, left, top, left, top, false);
+
 	if (m_IsPainting)
 	{
+		FlushDrawCommands();	// text is not recorded, everything before it has to be drawn first
+
+		if (m_RenderBackendPtr) return 0;	// the render backends have no text support
+
 		if (m_FontDraw != 0)
 		{
 			HFONT hOldFont = (HFONT)SelectObject(m_HdcDraw, m_FontDraw);
@@ -992,14 +1935,27 @@ int GameEngine::DrawString(const tstring& text, int left, int top) const
 
 bool GameEngine::DrawBitmap(const Bitmap* bitmapPtr, int left, int top, RECT rect) const
 {
-	if (m_IsPainting)
+	CountDrawCall(FrameProfiler::DrawCall::Bitmap);
+	if (IsSimulationThread() || m_IsPainting)
 	{
 		if (!bitmapPtr->Exists()) return false;
+		if (IsSimulationThread()) return RecordBitmap(bitmapPtr, left, top, rect);
+		if (IsOutsideDamage(left, top, left + rect.right - rect.left, top + rect.bottom - rect.top)) return true;
+
+		FlushDrawCommands();	// bitmaps are not recorded, everything before them has to be drawn first
 
 		const int opacity = bitmapPtr->GetOpacity();
 
 		if (opacity == 0 && bitmapPtr->HasAlphaChannel()) return true; // don't draw if opacity == 0 and opacity is used
 
+		if (m_RenderBackendPtr)
+		{
+			if (bitmapPtr->HasAlphaChannel()) m_RenderBackendPtr->BlendImage(bitmapPtr->GetRenderImage(), left, top, rect.left, rect.top, rect.right, rect.bottom, (int)(2.55 * opacity));
+			else m_RenderBackendPtr->KeyedImage(bitmapPtr->GetRenderImage(), left, top, rect.left, rect.top, rect.right, rect.bottom, bitmapPtr->GetTransparencyColor());
+
+			return true;
+		}
+
 		HDC hdcMem = CreateCompatibleDC(m_HdcDraw);
 		HBITMAP hbmOld = (HBITMAP)SelectObject(hdcMem, bitmapPtr->GetHandle());
 
@@ -1020,7 +1976,7 @@ bool GameEngine::DrawBitmap(const Bitmap* bitmapPtr, int left, int top, RECT rec
 
 bool GameEngine::DrawBitmap(const Bitmap* bitmapPtr, int left, int top) const
 {
-	if (m_IsPainting)
+	if (IsSimulationThread() || m_IsPainting)
 	{
 		if (!bitmapPtr->Exists()) return false;
 
@@ -1035,7 +1991,7 @@ bool GameEngine::DrawBitmap(const Bitmap* bitmapPtr, int left, int top) const
 
 bool GameEngine::FillWindowRect(COLORREF color) const
 {	
-	if (m_IsPainting)
+	if (IsSimulationThread() || m_IsPainting)
 	{
 		COLORREF oldColor = GetDrawColor();
 		const_cast<GameEngine*>(this)->SetColor(color);
@@ -1049,7 +2005,7 @@ bool GameEngine::FillWindowRect(COLORREF color) const
 
 COLORREF GameEngine::GetDrawColor() const
 { 
-	return m_ColDraw; 
+	return IsSimulationThread() ? m_RecordColor : m_ColDraw; 
 }
 
 bool GameEngine::Repaint() const
@@ -1080,16 +2036,115 @@ void GameEngine::SetWindowPosition(int left, int top)
 
 void GameEngine::SetColor(COLORREF color) 
 { 
+	if (IsSimulationThread())
+	{
+		m_RecordColor = color;
+		return;
+	}
+
 	m_ColDraw = color; 
+
+	if (m_RenderBackendPtr) m_RenderBackendPtr->SetColor(color);
+	else SelectDrawObjects();
+}
+
+void GameEngine::SelectDrawObjects()
+{
+	if (m_HdcDraw == NULL) return;
+
+	// nothing to do when the pen and brush for this color are already selected
+	if (m_SelectedDrawObjects != -1 && m_DrawObjectCache[m_SelectedDrawObjects].color == m_ColDraw)
+	{
+		++m_DrawObjectCacheHits;
+		return;
+	}
+
+	// look the color up, remember the least recently used entry in case it is not there
+	int index{ -1 }, leastRecentIndex{};
+	for (int count{}; count < DRAW_OBJECT_CACHE_SIZE; ++count)
+	{
+		const CachedDrawObjects& entry = m_DrawObjectCache[count];
+		if (entry.hPen != NULL && entry.color == m_ColDraw)
+		{
+			index = count;
+			break;
+		}
+		if (entry.lastUse < m_DrawObjectCache[leastRecentIndex].lastUse) leastRecentIndex = count;
+	}
+
+	if (index != -1) ++m_DrawObjectCacheHits;
+	else
+	{
+		++m_DrawObjectCacheMisses;
+
+		// the least recently used entry is never the selected one, so it can be deleted right away
+		index = leastRecentIndex;
+		CachedDrawObjects& entry = m_DrawObjectCache[index];
+		if (entry.hPen != NULL)
+		{
+			DeleteObject(entry.hPen);
+			DeleteObject(entry.hBrush);
+		}
+
+		entry.color  = m_ColDraw;
+		entry.hPen   = CreatePen(PS_SOLID, 1, m_ColDraw);
+		entry.hBrush = CreateSolidBrush(m_ColDraw);
+	}
+
+	CachedDrawObjects& entry = m_DrawObjectCache[index];
+	entry.lastUse = ++m_DrawObjectCacheClock;
+
+	HPEN hOldPen = (HPEN)SelectObject(m_HdcDraw, entry.hPen);
+	HBRUSH hOldBrush = (HBRUSH)SelectObject(m_HdcDraw, entry.hBrush);
+
+	// keep whatever was selected before the first cached objects, it is put back in ReleaseDrawObjects
+	if (m_SelectedDrawObjects == -1)
+	{
+		m_hOldPen = hOldPen;
+		m_hOldBrush = hOldBrush;
+	}
+
+	m_SelectedDrawObjects = index;
+}
+
+void GameEngine::ReleaseDrawObjects()
+{
+	if (m_SelectedDrawObjects != -1)
+	{
+		SelectObject(m_HdcDraw, m_hOldPen);
+		SelectObject(m_HdcDraw, m_hOldBrush);
+		m_SelectedDrawObjects = -1;
+	}
+
+	for (CachedDrawObjects& entry : m_DrawObjectCache)
+	{
+		if (entry.hPen != NULL)
+		{
+			DeleteObject(entry.hPen);
+			DeleteObject(entry.hBrush);
+		}
+		entry = CachedDrawObjects{};
+	}
+}
+
+void GameEngine::SetRenderBackend(unique_ptr<RenderBackend> backendPtr)
+{
+	m_RenderBackendPtr = std::move(backendPtr);
+
+	if (m_RenderBackendPtr) m_RenderBackendPtr->SetColor(m_ColDraw);
 }
 
 void GameEngine::SetFont(Font* fontPtr)
 {
-	m_FontDraw = fontPtr->GetHandle();
+	if (IsSimulationThread()) m_RecordFont = fontPtr->GetHandle();
+	else m_FontDraw = fontPtr->GetHandle();
 }
 
 LRESULT GameEngine::HandleEvent(HWND hWindow, UINT msg, WPARAM wParam, LPARAM lParam)
 {
+	// input is handed to the next tick, in threaded mode that runs on the simulation thread
+	if (QueueEvent(msg, wParam, lParam)) return 0;
+
 	// Route Windows messages to game engine member functions
 	switch (msg)
 	{
@@ -1111,7 +2166,14 @@ LRESULT GameEngine::HandleEvent(HWND hWindow, UINT msg, WPARAM wParam, LPARAM lP
 			PAINTSTRUCT ps;
 			HDC hDC = BeginPaint(hWindow, &ps);
 
-			PaintDoubleBuffered(hDC);
+			// the window lost its contents, so the whole frame has to be drawn and copied,
+			// in threaded mode the buffer still holds the last presented snapshot
+			if (IsSimulationRunning()) PresentBuffer(hDC);
+			else
+			{
+				m_DamageFull = true;
+				PaintDoubleBuffered(hDC);
+			}
 
 			// end paint
 			EndPaint(hWindow, &ps);
@@ -1124,36 +2186,13 @@ LRESULT GameEngine::HandleEvent(HWND hWindow, UINT msg, WPARAM wParam, LPARAM lP
 		case WM_CTLCOLORBTN:
 			return SendMessage((HWND) lParam, WM_CTLCOLOREDIT, wParam, lParam);	// delegate this message to the child window
 
-		case WM_LBUTTONDOWN:
-			m_GamePtr->MouseButtonAction(true, true, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), wParam);
-			return 0;
-
-		case WM_LBUTTONUP:
-			m_GamePtr->MouseButtonAction(true, false, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), wParam);
-			return 0;
-
-		case WM_RBUTTONDOWN:
-			m_GamePtr->MouseButtonAction(false, true, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), wParam);
-			return 0;
-
-		case WM_RBUTTONUP:
-			m_GamePtr->MouseButtonAction(false, false, GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), wParam);
-			return 0;
-			
-		case WM_MOUSEWHEEL:
-			m_GamePtr->MouseWheelAction(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), (short) HIWORD(wParam), wParam);
-			return 0;
-
-		case WM_MOUSEMOVE:
-			m_GamePtr->MouseMove(GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam), wParam);
-			return 0;
-			
 		case WM_SYSCOMMAND:	// trapping this message prevents a freeze after the ALT key is released
 			if (wParam == SC_KEYMENU) return 0;			// see win32 API : WM_KEYDOWN
 			else break;    
 
 		case WM_DESTROY:
-			// User defined code for ending the game
+			// User defined code for ending the game, after the simulation thread is done with it
+			StopSimulation();
 			m_GamePtr->End();
 			
 			// End and exit the application
@@ -1356,10 +2395,7 @@ void Bitmap::CreateAlphaChannel()
 	GetDIBits(windowDC, m_hBitmap, 0, GetHeight(), m_PixelsPtr, (BITMAPINFO*)&bminfoheader, DIB_RGB_COLORS); // load pixel info
 
 	// add alpha channel values of 255 for every pixel if bmp
-	for (int count{}; count < GetWidth() * GetHeight(); ++count)
-	{
-		m_PixelsPtr[count * 4 + 3] = 255;
-	}
+	PixelKernels::SetAlpha((uint32_t*)m_PixelsPtr, (size_t)GetWidth() * GetHeight(), 255);
 	
 	SetDIBits(windowDC, m_hBitmap, 0, GetHeight(), m_PixelsPtr, (BITMAPINFO*)&bminfoheader, DIB_RGB_COLORS); 
 }
@@ -1433,6 +2469,33 @@ HBITMAP Bitmap::GetHandle() const
 	return m_hBitmap;
 }
 
+RenderImage Bitmap::GetRenderImage() const
+{
+	if (!Exists()) return {};
+
+	const int width { GetWidth()  };
+	const int height{ GetHeight() };
+
+	if (m_RenderPixels.empty())
+	{
+		BITMAPINFO bmi{};
+		bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+		bmi.bmiHeader.biWidth		= width;
+		bmi.bmiHeader.biHeight		= -height;		// top-down rows
+		bmi.bmiHeader.biPlanes		= 1;
+		bmi.bmiHeader.biBitCount	= 32;
+		bmi.bmiHeader.biCompression = BI_RGB;
+
+		m_RenderPixels.resize(width * height);
+
+		HDC hScreenDC = GetDC(NULL);
+		GetDIBits(hScreenDC, m_hBitmap, 0, height, m_RenderPixels.data(), &bmi, DIB_RGB_COLORS); // load pixel info
+		ReleaseDC(NULL, hScreenDC);
+	}
+
+	return { m_RenderPixels.data(), width, height };
+}
+
 int Bitmap::GetWidth() const
 {
 	if (!Exists()) return 0;
@@ -1456,6 +2519,7 @@ int Bitmap::GetHeight() const
 void Bitmap::SetTransparencyColor(COLORREF color) // converts transparency value to pixel-based alpha
 {
 	m_TransparencyKey = color;
+	m_RenderPixels.clear();		// the pixels are about to change
 
 	if (HasAlphaChannel())
 	{
@@ -1474,15 +2538,9 @@ void Bitmap::SetTransparencyColor(COLORREF color) // converts transparency value
 
 		unsigned char* newPixelsPtr = new unsigned char[width * height * 4]; // create 32 bit buffer
 
-		for (int count{}; count < width * height; ++count)
-		{
-			if (RGB(m_PixelsPtr[count * 4 + 2], m_PixelsPtr[count * 4 + 1], m_PixelsPtr[count * 4]) == color) // if the color of this pixel == transparency color
-			{
-				((int*) newPixelsPtr)[count] = 0;	// set all four values to zero, this assumes sizeof(int) == 4 on this system
-													// setting values to zero means premultiplying the RGB values to an alpha of 0
-			}
-			else ((int*) newPixelsPtr)[count] = ((int*) m_PixelsPtr)[count]; // copy all four values from m_PixelsPtr to NewPixels
-		}
+		// pixels of the transparency color become all zero, which is their rgb premultiplied with an alpha of 0
+		const uint32_t keyPixel{ (uint32_t)GetRValue(color) << 16 | (uint32_t)GetGValue(color) << 8 | GetBValue(color) };
+		PixelKernels::ColorKeyToZero((uint32_t*)newPixelsPtr, (const uint32_t*)m_PixelsPtr, (size_t)width * height, keyPixel);
 
 		SetDIBits(windowDC, m_hBitmap, 0, height, newPixelsPtr, (BITMAPINFO*) &bminfoheader, DIB_RGB_COLORS); // insert pixels into bitmap
 
@@ -2303,39 +3361,34 @@ Timer::Timer(int msec, Callable* targetPtr, bool repeat) : m_Delay{ msec }, m_Mu
 
 Timer::~Timer()
 {
-	if (m_IsRunning) Stop(); // stop closes the handle
+	Stop();
+	WaitForAsyncCalls(); // an async expiry may still be calling the listeners
 }
 
 void Timer::Start()
 {
-	if (m_IsRunning == false)
-	{
-		CreateTimerQueueTimer(&m_TimerHandle, NULL, TimerProcStatic, (void*) this, m_Delay, m_Delay, WT_EXECUTEINTIMERTHREAD);	
-		m_IsRunning = true;
-	}
+	if (IsRunning()) return;
+
+	SetPeriod(m_MustRepeat ? max(m_Delay, 1) : 0);
+	GAME_ENGINE->GetTimerWheel().Schedule(this, max(m_Delay, 1));
 }
 
 void Timer::Stop()
 {	
-	if (m_IsRunning == true)
-	{
-		DeleteTimerQueueTimer(NULL, m_TimerHandle, NULL);  
-		//CloseHandle (m_TimerHandle);		DeleteTimerQueueTimer automatically closes the handle? MSDN Documentation seems to suggest this
-		
-		m_IsRunning = false;
-	}
+	// an async expiry that is already queued still calls the listeners
+	Cancel();
 }
 
 bool Timer::IsRunning() const
 {
-	return m_IsRunning;
+	return IsScheduled();
 }
 
 void Timer::SetDelay(int msec)
 {
 	m_Delay = max(msec, 1); // timer will not accept values less than 1 msec
 
-	if (m_IsRunning)
+	if (IsRunning())
 	{
 		Stop();
 		Start();
@@ -2345,6 +3398,19 @@ void Timer::SetDelay(int msec)
 void Timer::SetRepeat(bool repeat)
 {
 	m_MustRepeat = repeat;
+
+	// takes effect when a running timer expires next
+	SetPeriod(m_MustRepeat ? max(m_Delay, 1) : 0);
+}
+
+void Timer::SetAsync(bool isAsync)
+{
+	TimerWheel::Entry::SetAsync(isAsync);
+}
+
+bool Timer::IsAsync() const
+{
+	return TimerWheel::Entry::IsAsync();
 }
 
 int Timer::GetDelay() const
@@ -2357,13 +3423,10 @@ Caller::Type Timer::GetType() const
 	return Caller::Type::Timer;
 }
 
-void CALLBACK Timer::TimerProcStatic(void* lpParameter, BOOLEAN TimerOrWaitFired)
+void Timer::OnExpire()
 {
-	Timer* timerPtr = reinterpret_cast<Timer*>(lpParameter);
-
-	if (timerPtr->m_IsRunning)		timerPtr->CallListeners();
-
-	if (!timerPtr->m_MustRepeat)	timerPtr->Stop();
+	// the wheel already rescheduled a repeating timer and stopped a one-shot one
+	CallListeners();
 }
 
 //---------------------------
@@ -28,10 +28,22 @@
 
 #include "AbstractGame.h"				// base for all games
 #include "GameDefines.h"				// common header files and defines / macros
+#include "RenderBackend.h"				// optional replacement for the GDI draw calls
+#include "DrawCommandBuffer.h"			// per frame batching of the draw calls
+#include "ThreadPool.h"					// worker threads for the simulation code
+#include "FramePacer.h"					// sleeps between frames instead of spinning
+#include "FrameProfiler.h"				// per phase frame timing and draw call counts
+#include "TripleBuffer.h"				// hands frame snapshots from the simulation thread to the window thread
+#include "TimerWheel.h"					// runs the Timer objects from the game loop
+#include "EventQueue.h"					// hands input from the window procedure to the game thread
 
 #include <vector>						// using std::vector for tab control logic
 #include <queue>						// using std::queue for event system
 #include <algorithm>
+#include <memory>						// using std::unique_ptr for the render backend
+#include <atomic>
+#include <mutex>						// guards the bitmaps waiting to be deleted in threaded mode
+#include <thread>						// the simulation thread in threaded mode
 
 //-----------------------------------------------------------------
 // Pragma Library includes
@@ -70,12 +82,15 @@ public:
 	// General Member Functions
 	void		SetGame				(AbstractGame* gamePtr);
 	bool		Run					(HINSTANCE hInstance, int cmdShow);
+	bool		RunHeadless			(int frameCount, const tstring& outputFilename = _T(""));	// runs the game without a window on the software renderer
 
 	void		SetTitle			(const tstring& title);			// SetTitle automatically sets the window class name 
 	void		SetWindowPosition	(int left, int top);
 	bool		SetWindowRegion		(const HitRegion* regionPtr);
 	void		SetKeyList			(const tstring& keyList);
 	void		SetFrameRate		(int frameRate);
+	void		SetFixedTimestep	(int tickRate);		// Tick runs tickRate times per second of game time, 0 ticks once per painted frame
+	void		SetMaxCatchUpTicks	(int maxTicks);		// ticks per frame at most, a game that falls further behind slows down instead of stalling
 	void		SetWidth			(int width);
 	void		SetHeight			(int height);
 
@@ -119,12 +134,20 @@ public:
 	bool		DrawArc				(int left, int top, int right, int bottom, int startDegree, int angle)	const;
 	bool		FillArc				(int left, int top, int right, int bottom, int startDegree, int angle)	const;
 
+	// Bulk versions, coordsArr holds count groups of 4: x1, y1, x2, y2 per line or left, top, right, bottom per rect
+	bool		DrawLines			(const float coordsArr[], int count)									const;
+	bool		FillRects			(const float coordsArr[], int count, int opacity)						const;
+
 	int			DrawString			(const tstring& text, int left, int top)								const;
 	int			DrawString			(const tstring& text, int left, int top, int right, int bottom)			const;
 
 	bool		DrawBitmap			(const Bitmap* bitmapPtr, int left, int top)							const;
 	bool		DrawBitmap			(const Bitmap* bitmapPtr, int left, int top, RECT sourceRect)			const;
 
+	// Delete a bitmap or font, in threaded mode only after the window thread presented every snapshot that may draw it
+	void		DeleteBitmap		(const Bitmap* bitmapPtr);
+	void		DeleteFont			(const Font* fontPtr);		// a font that is still set is replaced by the default one
+
 	bool		DrawPolygon			(const POINT ptsArr[], int count)										const;
 	bool		DrawPolygon			(const POINT ptsArr[], int count, bool close)							const;
 	bool		FillPolygon			(const POINT ptsArr[], int count)										const;
@@ -133,6 +156,50 @@ public:
 	COLORREF	GetDrawColor		()						const; 
 	bool		Repaint				()						const;
 
+	// Pen and brush cache statistics, a lookup happens on every SetColor call
+	unsigned int	GetDrawObjectCacheHits		()		const	{ return m_DrawObjectCacheHits; }
+	unsigned int	GetDrawObjectCacheMisses	()		const	{ return m_DrawObjectCacheMisses; }
+
+	// Render backend, when set all Draw/Fill calls are routed to it instead of GDI
+	void			SetRenderBackend	(std::unique_ptr<RenderBackend> backendPtr);
+	RenderBackend*	GetRenderBackend	()					const	{ return m_RenderBackendPtr.get(); }
+
+	// Draw buffering, when enabled the Draw/Fill calls are recorded and submitted in batches at the end of the frame
+	void		SetDrawBuffering	(bool enable);
+	bool		IsDrawBuffering		()						const	{ return m_DrawBuffering; }
+
+	// Damage tracking, when enabled a frame in which the game called Invalidate only redraws and copies
+	// those rectangles, a frame declared unchanged is skipped, a frame without either is drawn in full
+	void		SetDamageTracking	(bool enable);
+	bool		IsDamageTracking	()						const	{ return m_DamageTracking; }
+	void		Invalidate			(int left, int top, int right, int bottom);
+	void		InvalidateAll		();
+	void		SetFrameUnchanged	();
+	bool		IsOutsideDamage		(int left, int top, int right, int bottom)	const;	// true while painting when the area needs no redraw
+	unsigned int	GetSkippedFrames	()					const	{ return m_SkippedFrames; }
+
+	// Threaded mode, set before Run: Tick, Paint and the input callbacks run on a simulation thread that records
+	// every frame into a snapshot, the window thread only replays the newest snapshot and presents it.
+	// Polygons can not be recorded, bitmaps have to stay alive until the frames drawing them are presented.
+	void		SetThreaded			(bool enable)					{ m_IsThreaded = enable; }
+	bool		IsThreaded			()						const	{ return m_IsThreaded; }
+
+	// Frame profiler, always gathering, the overlay shows its numbers in the top left corner of every frame
+	const FrameProfiler&	GetProfiler	()				const	{ return m_Profiler; }
+	void		ResetProfiler		()								{ m_Profiler.Reset(); }
+	void		SetProfilerOverlay	(bool show)						{ m_ShowProfilerOverlay = show; }
+	bool		IsProfilerOverlayShown	()					const	{ return m_ShowProfilerOverlay; }
+
+	// Worker threads shared by everything the game runs in parallel, created on first use
+	ThreadPool*	GetThreadPool		();
+
+	// Input and focus events of the current tick, runs of mouse moves merged into one, in the order they came in
+	const std::vector<EngineEvent>&	GetEvents	()				const	{ return m_TickEvents; }
+	uint64_t	GetDroppedEventCount()						const	{ return m_EventQueue.GetDroppedCount(); }
+
+	// Every running Timer, advanced by the frame time at the start of each frame on the game thread
+	TimerWheel&	GetTimerWheel		()								{ return m_TimerWheel; }
+
 	// Accessor Member Functions	
 	tstring		GetTitle			()						const; 
 	HINSTANCE	GetInstance			()						const	{ return m_Instance; }
@@ -141,6 +208,12 @@ public:
 	int			GetHeight			()						const	{ return m_Height; }
 	int			GetFrameRate		()						const	{ return m_FrameRate; }
 	int			GetFrameDelay		()						const	{ return m_FrameDelay; }
+	int			GetTickRate			()						const	{ return m_TickRate; }
+	double		GetDeltaTime		()						const	{ return m_DeltaTime; }				// seconds of game time the current Tick covers
+	double		GetFrameTime		()						const	{ return m_FrameTime; }				// measured seconds between the last two frames
+	double		GetInterpolationAlpha()						const	{ return m_InterpolationAlpha; }	// where the painted frame lies between the last tick (0) and the next (1)
+	FramePacer::JitterStats	GetFrameStats	()			const	{ return m_FramePacer.GetJitterStats(); }
+	void		ResetFrameStats		()								{ m_FramePacer.ResetStats(); }
 	POINT		GetWindowPosition	()						const;
 
 	// Tab control
@@ -156,10 +229,59 @@ private:
 	void		SetInstance			(HINSTANCE hInstance);
 	void		SetWindow			(HWND hWindow);
 
+	// Frame scheduling in performance counter counts, a frame is due one period after the previous one was due
+	struct FrameClock
+	{
+		LONGLONG	frequency	{};
+		LONGLONG	trigger		{};
+		LONGLONG	lastFrame	{};
+	};
+	void		StartFrameClock		(FrameClock& clock)										const;
+	bool		IsFrameDue			(FrameClock& clock, double& frameTime);		// when it is, measures the frame time and schedules the next one
+
+	void		RunFrame			(double frameTime);
+	void		TickGame			();		// one Tick and CheckKeyboard
+	void		PaintFrame			();
 	void		PaintDoubleBuffered	(HDC hDC);
+	void		PresentBuffer		(HDC hDC);
+
+	// Input, queued by the window procedure and dispatched at the start of the next tick
+	bool		QueueEvent			(UINT msg, WPARAM wParam, LPARAM lParam);		// true when the message needs no further handling
+	void		DispatchEvents		();
+
+	// Threaded mode
+	bool		IsSimulationRunning	()		const	{ return m_SimulationThread.joinable(); }
+	static bool	IsSimulationThread	()				{ return s_IsSimulationThread; }
+	void		SimulationLoop		();
+	void		StopSimulation		();
+	void		RecordSnapshot		();
+	void		PresentSnapshot		(HDC hDC);
+	bool		RecordToSnapshot	(DrawCommandType type, int left, int top, int right, int bottom, int param1 = 0, int param2 = 0, int opacity = 255) const;
+	int			RecordText			(const tstring& text, int left, int top, int right, int bottom, bool isRect)	const;
+	bool		RecordBitmap		(const Bitmap* bitmapPtr, int left, int top, RECT sourceRect)					const;
+	void		DeletePendingObjects	(uint64_t presentedSequence);		// the ones no snapshot up to presentedSequence is left to draw
 	void		FormPolygon			(const POINT ptsArr[], int count, bool close)			const;
 	POINT		AngleToPoint		(int left, int top, int right, int bottom, int angle)	const;
 
+	bool		IsRecording			()														const	{ return m_DrawBuffering && !m_IsFlushing; }
+	void		RecordCommand		(DrawCommandType type, int left, int top, int right, int bottom, int param1 = 0, int param2 = 0, int opacity = 255) const;
+	void		FlushDrawCommands	()														const;
+	void		SubmitDrawCommands	(DrawCommandBuffer& commands)							const;	// draws and clears commands
+	void		ReplayCommand		(const DrawCommand& command)							const;
+	void		SubmitLines			(const DrawCommand commandsArr[], int count)			const;
+	void		SubmitOpaqueRects	(const DrawCommand commandsArr[], int count)			const;
+
+	void		ResetDamage			();
+
+	void		CountDrawCall		(FrameProfiler::DrawCall drawCall, int count = 1)	const;	// skips the calls made while flushing
+	void		DrawProfilerOverlay	();
+
+	void		SelectDrawObjects	();
+	void		ReleaseDrawObjects	();
+
+	bool		EnsureScratchSurface	(int width, int height)								const;
+	void		ReleaseScratchSurface	();
+
 	void AllocateConsole();
 
 	// Member Variables
@@ -176,6 +298,57 @@ private:
 	AbstractGame*		m_GamePtr			{};
 	bool				m_Fullscreen		{};
 
+	// Game loop timing, in seconds
+	int					m_TickRate				{};		// 0 ticks once per painted frame
+	int					m_MaxCatchUpTicks		{ 5 };
+	double				m_DeltaTime				{ 1.0 / m_FrameRate };
+	double				m_FrameTime				{ 1.0 / m_FrameRate };
+	double				m_InterpolationAlpha	{ 1.0 };
+	double				m_TickAccumulator		{};		// game time not simulated yet
+	FramePacer			m_FramePacer			{};		// paces the simulation thread in threaded mode
+
+	// Threaded mode, a snapshot is everything one recorded frame needs, param1 of its Text and Bitmap commands indexes texts and bitmaps
+	struct RecordedText
+	{
+		tstring			text		{};
+		HFONT			hFont		{};
+	};
+	struct RecordedBitmap
+	{
+		const Bitmap*	bitmapPtr	{};
+		RECT			sourceRect	{};
+	};
+	struct FrameSnapshot
+	{
+		uint64_t					sequence	{};		// counts the recorded snapshots
+		DrawCommandBuffer			commands	{};
+		std::vector<RecordedText>	texts		{};
+		std::vector<RecordedBitmap>	bitmaps		{};
+	};
+
+	bool							m_IsThreaded			{};
+	std::thread						m_SimulationThread		{};
+	std::atomic<bool>				m_StopSimulation		{};
+	HANDLE							m_SnapshotReady			{};		// auto reset event, set for every published snapshot
+	TripleBuffer<FrameSnapshot>		m_Snapshots				{};
+	FrameSnapshot*					m_RecordSnapshotPtr		{};		// simulation thread, set while the game paints into it
+	const FrameSnapshot*			m_ReplaySnapshotPtr		{};		// window thread, set while it is replayed
+	COLORREF						m_RecordColor			{};		// the draw color and font of the simulation thread
+	HFONT							m_RecordFont			{};
+	uint64_t						m_RecordSequence		{};		// simulation thread, the sequence of the snapshot being recorded or last published
+
+	// Bitmaps and fonts deleted on the simulation thread while a snapshot not presented yet may still draw them, one of the two is set
+	struct PendingObject
+	{
+		const Bitmap*	bitmapPtr	{};
+		const Font*		fontPtr		{};
+		uint64_t		sequence	{};		// the last snapshot that may draw it
+	};
+	std::mutex						m_PendingObjectsMutex	{};
+	std::vector<PendingObject>		m_PendingObjects		{};
+
+	static thread_local bool		s_IsSimulationThread;
+
 	// GDI+ for PNG loading
 	ULONG_PTR			m_GDIPlusToken;
 
@@ -184,10 +357,69 @@ private:
 	// Draw assistance variables
 	HDC					m_HdcDraw			{};
 	RECT				m_RectDraw			{};
-	bool				m_IsPainting		{};
+	std::atomic<bool>	m_IsPainting		{};		// window thread, the simulation thread checks IsSimulationThread first and never reads it
 	COLORREF			m_ColDraw			{};
 	HFONT				m_FontDraw			{};
 
+	// Render backend, GDI is used when this is empty
+	std::unique_ptr<RenderBackend>	m_RenderBackendPtr	{};
+
+	// Draw buffering assistance variables
+	mutable DrawCommandBuffer	m_DrawCommands		{};
+	bool						m_DrawBuffering		{};
+	mutable std::atomic<bool>	m_IsFlushing		{};		// window thread, like m_IsPainting
+	mutable std::vector<POINT>	m_LinePoints		{};		// reused by SubmitLines
+	mutable std::vector<DWORD>	m_LineCounts		{};
+
+	// Pen and brush cache, keyed by color, the entry for m_ColDraw stays selected in m_HdcDraw
+	struct CachedDrawObjects
+	{
+		COLORREF		color		{};
+		HPEN			hPen		{};
+		HBRUSH			hBrush		{};
+		unsigned int	lastUse		{};
+	};
+	static const int	DRAW_OBJECT_CACHE_SIZE{ 8 };
+
+	CachedDrawObjects	m_DrawObjectCache[DRAW_OBJECT_CACHE_SIZE]	{};
+	int					m_SelectedDrawObjects						{ -1 };
+	HPEN				m_hOldPen									{};
+	HBRUSH				m_hOldBrush									{};
+	unsigned int		m_DrawObjectCacheClock						{};
+	unsigned int		m_DrawObjectCacheHits						{};
+	unsigned int		m_DrawObjectCacheMisses						{};
+
+	// Scratch surface for the alpha blended fills, grows to the largest fill and is reused across frames
+	mutable HDC			m_ScratchDC				{};
+	mutable HBITMAP		m_hScratchBitmap		{};
+	mutable HBITMAP		m_hScratchOldBitmap		{};
+	mutable uint32_t*	m_ScratchPixelsPtr		{};
+	mutable int			m_ScratchWidth			{};
+	mutable int			m_ScratchHeight			{};
+
+	// Damage tracking assistance variables
+	static const size_t	MAX_DAMAGE_RECTS	{ 64 };
+
+	bool				m_DamageTracking	{};
+	bool				m_DamageDeclared	{};		// the game called Invalidate or SetFrameUnchanged since the last frame
+	bool				m_DamageFull		{};
+	std::vector<RECT>	m_DamageRects		{};
+	bool				m_IsClippingDamage	{};		// set while painting a partial frame
+	unsigned int		m_SkippedFrames		{};
+
+	// Frame profiler, phases may be timed on both threads in threaded mode
+	mutable FrameProfiler	m_Profiler				{};
+	bool					m_ShowProfilerOverlay	{};
+
+	// Worker threads, destroyed after the game so nothing the game owns can still be using them
+	std::unique_ptr<ThreadPool>	m_ThreadPoolPtr	{};
+
+	TimerWheel			m_TimerWheel		{};
+
+	// Input events, the window thread produces and the game thread consumes
+	EventQueue					m_EventQueue			{ 4096 };
+	std::vector<EngineEvent>	m_TickEvents			{};		// drained at the start of the current tick
+
 	// Fullscreen assistance variable
 	POINT				m_OldPosition		{};
 
@@ -263,7 +495,7 @@ private:
 // Timer Class
 //--------------------------------------------------------------------------
 
-class Timer : public Caller
+class Timer : public Caller, private TimerWheel::Entry
 {
 public:
 	// -------------------------
@@ -284,12 +516,14 @@ public:
 	// -------------------------
 	// General Member Functions
 	// -------------------------
-	void	Start			();
+	void	Start			();		// Start and Stop on the game thread
 	void	Stop			();
 	void	SetDelay		(int msec);
 	void	SetRepeat		(bool repeat);
+	void	SetAsync		(bool isAsync);		// listeners run on a worker thread, locking what they share with the game is up to them
 
 	bool	IsRunning		()					const;
+	bool	IsAsync			()					const;
 	int		GetDelay		()					const;
 	Type	GetType			()					const;
 
@@ -297,15 +531,13 @@ private:
 	// -------------------------
 	// Datamembers
 	// -------------------------
-	HANDLE	m_TimerHandle	{};
-	bool	m_IsRunning		{};
 	bool	m_MustRepeat;
 	int		m_Delay;
 
 	// -------------------------
 	// Handler functions
 	// -------------------------	
-	static void CALLBACK TimerProcStatic(void* lpParameter, BOOLEAN TimerOrWaitFired); // proc will call CallListeners()
+	void	OnExpire		()					override; // will call CallListeners()
 };
 
 //-----------------------------------------------------------------
@@ -562,6 +794,7 @@ public:
 	bool		SaveToFile				(const tstring& filename)			const;
 
 	HBITMAP		GetHandle				()									const;
+	RenderImage	GetRenderImage			()									const;	// top-down 32 bit copy of the pixels, used by render backends
 	
 private:	
 	// -------------------------
@@ -574,6 +807,8 @@ private:
 	int				m_Opacity			{ 100 };
 	unsigned char*	m_PixelsPtr			{};
 	bool			m_HasAlphaChannel;
+
+	mutable std::vector<uint32_t>	m_RenderPixels	{};		// filled on the first GetRenderImage call
 	
 	// -------------------------
 	// Member Functions
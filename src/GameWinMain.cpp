@@ -22,7 +22,26 @@ GameEngine* GAME_ENGINE{ &myGameEngine };
 //-----------------------------------------------------------------
 int APIENTRY wWinMain(_In_ HINSTANCE hInstance, _In_opt_ HINSTANCE hPrevInstance, _In_ LPWSTR lpCmdLine, _In_ int nCmdShow)
 {
-	GAME_ENGINE->SetGame(new Game());					// any class that implements AbstractGame
+	// "--script <file.lua>" runs another script than lua/GameOfLife.lua
+	// "--headless <frames> [output.bmp]" runs the game without a window on the software renderer
+	tstringstream arguments{ lpCmdLine };
+	tstring option;
+	tstring scriptFilename{ _T("lua/GameOfLife.lua") };
+	int headlessFrames{ -1 };
+	tstring outputFilename;
+	while (arguments >> option)
+	{
+		if (option == _T("--script")) arguments >> scriptFilename;
+		else if (option == _T("--headless") && arguments >> headlessFrames)
+		{
+			arguments >> outputFilename;		// optional, so --headless goes last
+			break;
+		}
+	}
+
+	GAME_ENGINE->SetGame(new Game(scriptFilename));		// any class that implements AbstractGame
+
+	if (headlessFrames >= 0) return GAME_ENGINE->RunHeadless(headlessFrames, outputFilename) ? 0 : 1;
 
 	return GAME_ENGINE->Run(hInstance, nCmdShow);		// here we go
 
@@ -0,0 +1,573 @@
+//-----------------------------------------------------------------
+// HashLife
+// C++ Source - HashLife.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "HashLife.h"
+#include "FloatBuffer.h"
+
+#include <algorithm>
+#include <bit>
+
+//-----------------------------------------------------------------
+// HashLife Constructor(s)
+//-----------------------------------------------------------------
+HashLife::HashLife()
+{
+	m_Alive.population = 1;
+	m_RootPtr = Empty(3);
+	m_PreviousRootPtr = m_RootPtr;
+}
+
+//-----------------------------------------------------------------
+// HashLife Member Functions
+//-----------------------------------------------------------------
+bool HashLife::Get(int64_t x, int64_t y) const
+{
+	const int64_t half{ RootHalf() };
+	if (x < -half || x >= half || y < -half || y >= half) return false;
+
+	return GetCell(m_RootPtr, x + half, y + half);
+}
+
+void HashLife::Set(int64_t x, int64_t y, bool alive)
+{
+	while (m_RootPtr->level < MAX_LEVEL && (x < -RootHalf() || x >= RootHalf() || y < -RootHalf() || y >= RootHalf()))
+	{
+		m_RootPtr = Expand(m_RootPtr);
+	}
+
+	const int64_t half{ RootHalf() };
+	if (x < -half || x >= half || y < -half || y >= half) return;
+
+	m_RootPtr = SetCell(m_RootPtr, x + half, y + half, alive);
+}
+
+void HashLife::Toggle(int64_t x, int64_t y)
+{
+	Set(x, y, !Get(x, y));
+}
+
+void HashLife::Clear()
+{
+	m_RootPtr = Empty(3);
+	m_Generation = 0;
+	CollectGarbage();
+}
+
+bool HashLife::Step(uint64_t generations)
+{
+	m_PreviousRootPtr = m_RootPtr;
+
+	for (int log2Generations{}; generations != 0; ++log2Generations, generations >>= 1)
+	{
+		if ((generations & 1) && !Jump(log2Generations)) return false;
+	}
+	return true;
+}
+
+bool HashLife::StepPow2(int log2Generations)
+{
+	m_PreviousRootPtr = m_RootPtr;
+
+	return Jump(log2Generations);
+}
+
+bool HashLife::Jump(int log2Generations)
+{
+	log2Generations = std::clamp(log2Generations, 0, MAX_LEVEL - 3);
+
+	// the pattern has to sit in the center half of the root, plus one more level of margin
+	// because it can grow by 2^log2Generations cells on every side
+	Node* rootPtr = m_RootPtr;
+	while (rootPtr->level < MAX_LEVEL - 1 && (rootPtr->level < log2Generations + 2 || !FitsInCenter(rootPtr))) rootPtr = Expand(rootPtr);
+
+	// cells this close to the int64 limits could step out of the coordinate range, the pattern stays as it is
+	if (rootPtr->level < log2Generations + 2 || !FitsInCenter(rootPtr)) return false;
+
+	m_RootPtr = Expand(rootPtr);
+
+	if (m_NodeCount > m_MaxNodes) CollectGarbage();
+	if (log2Generations != m_StepLog2) ClearResults(log2Generations);
+
+	m_RootPtr = Successor(m_RootPtr);
+	m_Generation += uint64_t{ 1 } << log2Generations;
+
+	// drop the empty border again so later jumps do not work on a needlessly big root
+	while (m_RootPtr->level > 3 && FitsInCenter(m_RootPtr)) m_RootPtr = Center(m_RootPtr);
+	return true;
+}
+
+bool HashLife::GetBoundingBox(int64_t& left, int64_t& top, int64_t& right, int64_t& bottom)
+{
+	if (m_RootPtr->population == 0) return false;
+
+	ComputeBounds(m_RootPtr);
+
+	const int64_t half{ RootHalf() };
+	left	= m_RootPtr->boundsLeft		- half;
+	top		= m_RootPtr->boundsTop		- half;
+	right	= m_RootPtr->boundsRight	- half;
+	bottom	= m_RootPtr->boundsBottom	- half;
+	return true;
+}
+
+void HashLife::SetViewport(int64_t left, int64_t top, int width, int height)
+{
+	m_ViewLeft		= left;
+	m_ViewTop		= top;
+	m_ViewWidth		= std::max(width, 0);
+	m_ViewHeight	= std::max(height, 0);
+}
+
+std::vector<int> HashLife::GetChangedTiles()
+{
+	std::vector<int> rects{};
+	if (m_ViewWidth == 0 || m_ViewHeight == 0) return rects;
+
+	// the tiles are aligned to the plane, so they line up with the nodes of both trees
+	auto floorTile = [](int64_t value) { return (value >= 0 ? value : value - (TILE_SIZE - 1)) / TILE_SIZE * TILE_SIZE; };
+	const int64_t viewRight{ m_ViewLeft + m_ViewWidth };
+	const int64_t viewBottom{ m_ViewTop + m_ViewHeight };
+
+	for (int64_t tileTop{ floorTile(m_ViewTop) }; tileTop < viewBottom; tileTop += TILE_SIZE)
+	{
+		for (int64_t tileLeft{ floorTile(m_ViewLeft) }; tileLeft < viewRight; tileLeft += TILE_SIZE)
+		{
+			if (GetTile(m_PreviousRootPtr, tileLeft, tileTop) == GetTile(m_RootPtr, tileLeft, tileTop)) continue;
+
+			rects.push_back((int)(std::max(tileLeft, m_ViewLeft) - m_ViewLeft));
+			rects.push_back((int)(std::max(tileTop, m_ViewTop) - m_ViewTop));
+			rects.push_back((int)(std::min(tileLeft + TILE_SIZE, viewRight) - m_ViewLeft));
+			rects.push_back((int)(std::min(tileTop + TILE_SIZE, viewBottom) - m_ViewTop));
+		}
+	}
+	return rects;
+}
+
+void HashLife::AppendCellRects(std::vector<float>& coords, float cellSize)
+{
+	if (m_ViewWidth == 0 || m_ViewHeight == 0) return;
+
+	// the alive cells of the viewport as rows of bits, then the same run search as LifeGrid
+	const int wordsPerRow{ (m_ViewWidth + 63) / 64 };
+	m_ViewCells.assign((size_t)wordsPerRow * m_ViewHeight, 0);
+	AddViewCells(m_RootPtr, -RootHalf(), -RootHalf());
+
+	for (int y{}; y < m_ViewHeight; ++y)
+	{
+		const uint64_t* rowPtr = m_ViewCells.data() + (size_t)y * wordsPerRow;
+		int runStart{ -1 };
+
+		auto addRun = [&](int runEnd)
+		{
+			coords.insert(coords.end(), { runStart * cellSize, y * cellSize, runEnd * cellSize, (y + 1) * cellSize });
+			runStart = -1;
+		};
+
+		for (int wordIndex{}; wordIndex < wordsPerRow; ++wordIndex)
+		{
+			const uint64_t word{ rowPtr[wordIndex] };
+			int bit{};
+			while (bit < 64)
+			{
+				const uint64_t rest{ (runStart < 0 ? word : ~word) >> bit };
+				if (rest == 0) break;
+
+				bit += std::countr_zero(rest);
+				if (runStart < 0) runStart = wordIndex * 64 + bit;
+				else addRun(wordIndex * 64 + bit);
+			}
+		}
+
+		if (runStart >= 0) addRun(m_ViewWidth);
+	}
+}
+
+void HashLife::CollectGarbage()
+{
+	// everything reachable from the root survives, the empty nodes are cheap to keep
+	Mark(m_RootPtr);
+	Mark(m_PreviousRootPtr);
+	for (Node* emptyPtr : m_EmptyNodes) Mark(emptyPtr);
+
+	for (auto it = m_Nodes.begin(); it != m_Nodes.end(); )
+	{
+		Node* nodePtr = it->second;
+		if (nodePtr->isMarked)
+		{
+			++it;
+			continue;
+		}
+
+		m_FreeNodes.push_back(nodePtr);
+		it = m_Nodes.erase(it);
+		--m_NodeCount;
+	}
+
+	// a surviving node may have a result that was just freed
+	for (auto& [key, nodePtr] : m_Nodes)
+	{
+		if (nodePtr->resultPtr && !nodePtr->resultPtr->isMarked) nodePtr->resultPtr = nullptr;
+	}
+	for (auto& [key, nodePtr] : m_Nodes) nodePtr->isMarked = false;
+}
+
+HashLife::Node* HashLife::Join(Node* nwPtr, Node* nePtr, Node* swPtr, Node* sePtr)
+{
+	const NodeKey key{ nwPtr, nePtr, swPtr, sePtr };
+
+	auto it = m_Nodes.find(key);
+	if (it != m_Nodes.end()) return it->second;
+
+	Node* nodePtr = AllocateNode();
+	nodePtr->nwPtr		= nwPtr;
+	nodePtr->nePtr		= nePtr;
+	nodePtr->swPtr		= swPtr;
+	nodePtr->sePtr		= sePtr;
+	nodePtr->level		= nwPtr->level + 1;
+	nodePtr->population	= nwPtr->population + nePtr->population + swPtr->population + sePtr->population;
+
+	m_Nodes.emplace(key, nodePtr);
+	return nodePtr;
+}
+
+HashLife::Node* HashLife::Empty(int level)
+{
+	if (level == 0) return &m_Dead;
+
+	while ((int)m_EmptyNodes.size() <= level)
+	{
+		const int newLevel{ (int)m_EmptyNodes.size() };
+		if (newLevel == 0)
+		{
+			m_EmptyNodes.push_back(&m_Dead);
+			continue;
+		}
+
+		Node* childPtr = m_EmptyNodes[newLevel - 1];
+		m_EmptyNodes.push_back(Join(childPtr, childPtr, childPtr, childPtr));
+	}
+
+	return m_EmptyNodes[level];
+}
+
+HashLife::Node* HashLife::Center(Node* nodePtr)
+{
+	return Join(nodePtr->nwPtr->sePtr, nodePtr->nePtr->swPtr, nodePtr->swPtr->nePtr, nodePtr->sePtr->nwPtr);
+}
+
+HashLife::Node* HashLife::Expand(Node* nodePtr)
+{
+	Node* emptyPtr = Empty(nodePtr->level - 1);
+
+	return Join(Join(emptyPtr, emptyPtr, emptyPtr, nodePtr->nwPtr),
+				Join(emptyPtr, emptyPtr, nodePtr->nePtr, emptyPtr),
+				Join(emptyPtr, nodePtr->swPtr, emptyPtr, emptyPtr),
+				Join(nodePtr->sePtr, emptyPtr, emptyPtr, emptyPtr));
+}
+
+// The center half of a node, 2^min(m_StepLog2, level - 2) generations later
+HashLife::Node* HashLife::Successor(Node* nodePtr)
+{
+	if (nodePtr->resultPtr) return nodePtr->resultPtr;
+
+	Node* resultPtr{};
+	if (nodePtr->population == 0) resultPtr = Empty(nodePtr->level - 1);
+	else if (nodePtr->level == 2) resultPtr = StepLevel2(nodePtr);
+	else
+	{
+		Node* nw = nodePtr->nwPtr; Node* ne = nodePtr->nePtr;
+		Node* sw = nodePtr->swPtr; Node* se = nodePtr->sePtr;
+
+		// nine overlapping sub squares of half the size
+		Node* n00 = nw;
+		Node* n01 = Join(nw->nePtr, ne->nwPtr, nw->sePtr, ne->swPtr);
+		Node* n02 = ne;
+		Node* n10 = Join(nw->swPtr, nw->sePtr, sw->nwPtr, sw->nePtr);
+		Node* n11 = Join(nw->sePtr, ne->swPtr, sw->nePtr, se->nwPtr);
+		Node* n12 = Join(ne->swPtr, ne->sePtr, se->nwPtr, se->nePtr);
+		Node* n20 = sw;
+		Node* n21 = Join(sw->nePtr, se->nwPtr, sw->sePtr, se->swPtr);
+		Node* n22 = se;
+
+		Node* r00 = Successor(n00); Node* r01 = Successor(n01); Node* r02 = Successor(n02);
+		Node* r10 = Successor(n10); Node* r11 = Successor(n11); Node* r12 = Successor(n12);
+		Node* r20 = Successor(n20); Node* r21 = Successor(n21); Node* r22 = Successor(n22);
+
+		if (m_StepLog2 >= nodePtr->level - 2)
+		{
+			// full speed: a second round of successors doubles the generations
+			resultPtr = Join(Successor(Join(r00, r01, r10, r11)), Successor(Join(r01, r02, r11, r12)),
+							 Successor(Join(r10, r11, r20, r21)), Successor(Join(r11, r12, r21, r22)));
+		}
+		else
+		{
+			// smaller jump: the sub squares already advanced far enough, only the centers are needed
+			resultPtr = Join(Center(Join(r00, r01, r10, r11)), Center(Join(r01, r02, r11, r12)),
+							 Center(Join(r10, r11, r20, r21)), Center(Join(r11, r12, r21, r22)));
+		}
+	}
+
+	nodePtr->resultPtr = resultPtr;
+	return resultPtr;
+}
+
+// One generation of the center 2x2 of a 4x4 node
+HashLife::Node* HashLife::StepLevel2(Node* nodePtr)
+{
+	uint32_t cells{};
+	for (int y{}; y < 4; ++y)
+	{
+		for (int x{}; x < 4; ++x)
+		{
+			if (GetCell(nodePtr, x, y)) cells |= 1u << (y * 4 + x);
+		}
+	}
+
+	auto nextCell = [this, cells](int x, int y)
+	{
+		int neighbors{};
+		for (int dy{ -1 }; dy <= 1; ++dy)
+		{
+			for (int dx{ -1 }; dx <= 1; ++dx)
+			{
+				if (dx != 0 || dy != 0) neighbors += (cells >> ((y + dy) * 4 + x + dx)) & 1;
+			}
+		}
+
+		const bool alive{ ((cells >> (y * 4 + x)) & 1) != 0 };
+		return neighbors == 3 || (alive && neighbors == 2) ? &m_Alive : &m_Dead;
+	};
+
+	return Join(nextCell(1, 1), nextCell(2, 1), nextCell(1, 2), nextCell(2, 2));
+}
+
+HashLife::Node* HashLife::SetCell(Node* nodePtr, int64_t x, int64_t y, bool alive)
+{
+	if (nodePtr->level == 0) return alive ? &m_Alive : &m_Dead;
+
+	const int64_t half{ int64_t{ 1 } << (nodePtr->level - 1) };
+	Node* nw = nodePtr->nwPtr; Node* ne = nodePtr->nePtr;
+	Node* sw = nodePtr->swPtr; Node* se = nodePtr->sePtr;
+
+	if (y < half)
+	{
+		if (x < half) nw = SetCell(nw, x, y, alive);
+		else ne = SetCell(ne, x - half, y, alive);
+	}
+	else
+	{
+		if (x < half) sw = SetCell(sw, x, y - half, alive);
+		else se = SetCell(se, x - half, y - half, alive);
+	}
+
+	return Join(nw, ne, sw, se);
+}
+
+bool HashLife::GetCell(const Node* nodePtr, int64_t x, int64_t y) const
+{
+	while (nodePtr->level > 0)
+	{
+		if (nodePtr->population == 0) return false;
+
+		const int64_t half{ int64_t{ 1 } << (nodePtr->level - 1) };
+		if (y < half)	nodePtr = x < half ? nodePtr->nwPtr : nodePtr->nePtr;
+		else			nodePtr = x < half ? nodePtr->swPtr : nodePtr->sePtr;
+
+		if (x >= half) x -= half;
+		if (y >= half) y -= half;
+	}
+
+	return nodePtr == &m_Alive;
+}
+
+HashLife::Node* HashLife::GetTile(Node* rootPtr, int64_t left, int64_t top)
+{
+	// a root smaller than a tile gets an empty border, outside the root the tile is empty
+	while (rootPtr->level <= TILE_LEVEL) rootPtr = Expand(rootPtr);
+
+	const int64_t half{ int64_t{ 1 } << (rootPtr->level - 1) };
+	if (left < -half || left >= half || top < -half || top >= half) return Empty(TILE_LEVEL);
+
+	Node* nodePtr = rootPtr;
+	int64_t x{ left + half }, y{ top + half };
+	while (nodePtr->level > TILE_LEVEL)
+	{
+		const int64_t childHalf{ int64_t{ 1 } << (nodePtr->level - 1) };
+		if (y < childHalf)	nodePtr = x < childHalf ? nodePtr->nwPtr : nodePtr->nePtr;
+		else				nodePtr = x < childHalf ? nodePtr->swPtr : nodePtr->sePtr;
+
+		if (x >= childHalf) x -= childHalf;
+		if (y >= childHalf) y -= childHalf;
+	}
+
+	return nodePtr;
+}
+
+void HashLife::AddViewCells(const Node* nodePtr, int64_t left, int64_t top)
+{
+	if (nodePtr->population == 0) return;
+
+	const int64_t size{ int64_t{ 1 } << nodePtr->level };
+	if (left >= m_ViewLeft + m_ViewWidth || top >= m_ViewTop + m_ViewHeight || left + size <= m_ViewLeft || top + size <= m_ViewTop) return;
+
+	if (nodePtr->level == 0)
+	{
+		const int64_t x{ left - m_ViewLeft }, y{ top - m_ViewTop };
+		m_ViewCells[(size_t)y * ((m_ViewWidth + 63) / 64) + x / 64] |= uint64_t{ 1 } << (x % 64);
+		return;
+	}
+
+	const int64_t half{ size / 2 };
+	AddViewCells(nodePtr->nwPtr, left,			top);
+	AddViewCells(nodePtr->nePtr, left + half,	top);
+	AddViewCells(nodePtr->swPtr, left,			top + half);
+	AddViewCells(nodePtr->sePtr, left + half,	top + half);
+}
+
+bool HashLife::FitsInCenter(const Node* nodePtr) const
+{
+	const uint64_t centerPopulation{ nodePtr->nwPtr->sePtr->population + nodePtr->nePtr->swPtr->population
+								   + nodePtr->swPtr->nePtr->population + nodePtr->sePtr->nwPtr->population };
+
+	return centerPopulation == nodePtr->population;
+}
+
+void HashLife::ComputeBounds(Node* nodePtr)
+{
+	if (nodePtr->hasBounds || nodePtr->population == 0) return;
+
+	if (nodePtr->level == 0)
+	{
+		nodePtr->hasBounds = true;		// the alive leaf, all bounds are 0
+		return;
+	}
+
+	const int64_t half{ int64_t{ 1 } << (nodePtr->level - 1) };
+	const Node* childrenArr[4]{ nodePtr->nwPtr, nodePtr->nePtr, nodePtr->swPtr, nodePtr->sePtr };
+
+	bool isFirst{ true };
+	for (int index{}; index < 4; ++index)
+	{
+		Node* childPtr = const_cast<Node*>(childrenArr[index]);
+		if (childPtr->population == 0) continue;
+
+		ComputeBounds(childPtr);
+
+		const int64_t offsetX{ (index & 1) ? half : 0 };
+		const int64_t offsetY{ (index & 2) ? half : 0 };
+		const int64_t left{ childPtr->boundsLeft + offsetX }, right { childPtr->boundsRight  + offsetX };
+		const int64_t top { childPtr->boundsTop  + offsetY }, bottom{ childPtr->boundsBottom + offsetY };
+
+		nodePtr->boundsLeft		= isFirst ? left	: std::min(nodePtr->boundsLeft,		left);
+		nodePtr->boundsTop		= isFirst ? top		: std::min(nodePtr->boundsTop,		top);
+		nodePtr->boundsRight	= isFirst ? right	: std::max(nodePtr->boundsRight,	right);
+		nodePtr->boundsBottom	= isFirst ? bottom	: std::max(nodePtr->boundsBottom,	bottom);
+		isFirst = false;
+	}
+
+	nodePtr->hasBounds = true;
+}
+
+void HashLife::Mark(Node* nodePtr)
+{
+	if (nodePtr->isMarked || nodePtr->level == 0) return;
+
+	nodePtr->isMarked = true;
+	Mark(nodePtr->nwPtr);
+	Mark(nodePtr->nePtr);
+	Mark(nodePtr->swPtr);
+	Mark(nodePtr->sePtr);
+}
+
+void HashLife::ClearResults(int newStepLog2)
+{
+	// a node jumps 2^min(stepLog2, level - 2) generations, for low levels that does not change
+	for (auto& [key, nodePtr] : m_Nodes)
+	{
+		const int jump{ nodePtr->level - 2 };
+		if (m_StepLog2 < 0 || std::min(m_StepLog2, jump) != std::min(newStepLog2, jump)) nodePtr->resultPtr = nullptr;
+	}
+
+	m_StepLog2 = newStepLog2;
+}
+
+HashLife::Node* HashLife::AllocateNode()
+{
+	Node* nodePtr{};
+	if (!m_FreeNodes.empty())
+	{
+		nodePtr = m_FreeNodes.back();
+		m_FreeNodes.pop_back();
+		*nodePtr = Node{};
+	}
+	else
+	{
+		if (m_NodeBlocks.empty() || m_BlockUsed == NODES_PER_BLOCK)
+		{
+			m_NodeBlocks.push_back(std::make_unique<Node[]>(NODES_PER_BLOCK));
+			m_BlockUsed = 0;
+		}
+		nodePtr = &m_NodeBlocks.back()[m_BlockUsed++];
+	}
+
+	++m_NodeCount;
+	return nodePtr;
+}
+
+size_t HashLife::NodeKeyHash::operator()(const NodeKey& key) const
+{
+	// the nodes are at least 8 byte aligned, so the low pointer bits carry nothing
+	const uint64_t hash{ (uint64_t)(uintptr_t)key.nwPtr * 0x9E3779B97F4A7C15ull
+					   ^ (uint64_t)(uintptr_t)key.nePtr * 0xC2B2AE3D27D4EB4Full
+					   ^ (uint64_t)(uintptr_t)key.swPtr * 0x165667B19E3779F9ull
+					   ^ (uint64_t)(uintptr_t)key.sePtr * 0x27D4EB2F165667C5ull };
+
+	return (size_t)(hash ^ (hash >> 29));
+}
+
+void HashLife::CreateBindings(sol::state& state)
+{
+	state.new_usertype<HashLife>(
+		"HashLife",
+		sol::factories(
+			[]() { return std::make_unique<HashLife>(); },
+			[](int width, int height)
+			{
+				// stands in for a LifeGrid of that size, the plane still goes on past the viewport
+				auto lifePtr = std::make_unique<HashLife>();
+				lifePtr->SetViewport(0, 0, width, height);
+				return lifePtr;
+			}),
+		"Get", &HashLife::Get,
+		"Set", &HashLife::Set,
+		"Toggle", &HashLife::Toggle,
+		"Clear", &HashLife::Clear,
+		"Step", sol::overload(
+			[](HashLife& life) { return life.Step(1); },
+			[](HashLife& life, uint64_t generations) { return life.Step(generations); }),
+		"StepPow2", &HashLife::StepPow2,
+		"GetGeneration", &HashLife::GetGeneration,
+		"GetPopulation", &HashLife::GetPopulation,
+		"SetViewport", &HashLife::SetViewport,
+		"GetWidth", &HashLife::GetWidth,
+		"GetHeight", &HashLife::GetHeight,
+		"SetSparse", &HashLife::SetSparse,
+		"IsSparse", &HashLife::IsSparse,
+		"GetChangedTiles", [](HashLife& life) { return sol::as_table(life.GetChangedTiles()); },
+		"GetCellRects", [](HashLife& life, FloatBuffer& buffer, float cellSize) { life.AppendCellRects(buffer.GetValues(), cellSize); },
+		"GetBoundingBox", [](HashLife& life)
+		{
+			int64_t left{}, top{}, right{}, bottom{};
+			const bool hasCells{ life.GetBoundingBox(left, top, right, bottom) };
+			return std::make_tuple(hasCells, left, top, right, bottom);
+		},
+		"SetMaxNodes", &HashLife::SetMaxNodes,
+		"GetNodeCount", &HashLife::GetNodeCount,
+		"CollectGarbage", &HashLife::CollectGarbage
+	);
+}
@@ -0,0 +1,157 @@
+//-----------------------------------------------------------------
+// HashLife
+// C++ Header - HashLife.h - version v8_01
+//
+// Game of Life on an unbounded plane, stored as a hash-consed quadtree
+// so identical regions share one node and the result of stepping a
+// node is computed once. Jumps of 2^k generations cost about as much
+// as a single one on patterns with repeating structure.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <sol/sol.hpp>
+
+//-----------------------------------------------------------------
+// HashLife Class
+//-----------------------------------------------------------------
+class HashLife final
+{
+public:
+	// Constructor(s) and destructor
+	HashLife();
+	~HashLife() = default;
+
+	// Disabling copy/move constructors and assignment operators, the nodes point into m_NodeBlocks
+	HashLife(const HashLife& other)					= delete;
+	HashLife(HashLife&& other) noexcept				= delete;
+	HashLife& operator=(const HashLife& other)		= delete;
+	HashLife& operator=(HashLife&& other) noexcept	= delete;
+
+	// General Member Functions, the same cell interface as LifeGrid but without edges
+	bool		Get				(int64_t x, int64_t y)		const;
+	void		Set				(int64_t x, int64_t y, bool alive);
+	void		Toggle			(int64_t x, int64_t y);
+	void		Clear			();
+
+	// False when the pattern reached the edge of the int64 plane, it is left at the last generation that fit
+	bool		Step			(uint64_t generations = 1);		// split into power of two jumps
+	bool		StepPow2		(int log2Generations);			// 2^log2Generations generations in one jump
+
+	uint64_t	GetGeneration	()							const	{ return m_Generation; }
+	uint64_t	GetPopulation	()							const	{ return m_RootPtr->population; }
+
+	// A window of the plane that stands in for a LifeGrid board of width x height: GetWidth and GetHeight
+	// report its size, the cell rects and changed tiles are clipped to it and relative to its top left
+	void		SetViewport		(int64_t left, int64_t top, int width, int height);
+	int			GetWidth		()							const	{ return m_ViewWidth; }
+	int			GetHeight		()							const	{ return m_ViewHeight; }
+
+	// Always sparse, only changed regions cost anything, accepted so a script can treat it like a LifeGrid
+	void		SetSparse		(bool /*isSparse*/)					{}
+	bool		IsSparse		()							const	{ return true; }
+
+	// Tiles of the viewport whose cells changed in the last step, or were edited since, as cell rectangles:
+	// left, top, right, bottom (exclusive). Found by comparing the tree with the one before the step,
+	// hash consing gives equal tiles the same node so only the changed branches are visited.
+	static const int TILE_SIZE{ 64 };
+	std::vector<int>	GetChangedTiles	();
+
+	// Appends left, top, right, bottom per horizontal run of alive cells in the viewport, scaled by cellSize, for Draw.FillRects
+	void		AppendCellRects	(std::vector<float>& coords, float cellSize);
+
+	// Smallest rectangle holding every alive cell, inclusive. False when there are none.
+	// Read from per node bounds, the tree is never expanded to answer it.
+	bool		GetBoundingBox	(int64_t& left, int64_t& top, int64_t& right, int64_t& bottom);
+
+	// Nodes are collected between jumps once there are more than this many
+	void		SetMaxNodes		(size_t maxNodes)					{ m_MaxNodes = maxNodes; }
+	size_t		GetNodeCount	()							const	{ return m_NodeCount; }
+	void		CollectGarbage	();
+
+	static void	CreateBindings	(sol::state& state);
+
+private:
+	struct Node
+	{
+		Node*		nwPtr			{};
+		Node*		nePtr			{};
+		Node*		swPtr			{};
+		Node*		sePtr			{};
+		Node*		resultPtr		{};		// center half, 2^m_StepLog2 generations later
+		uint64_t	population		{};
+		int			level			{};		// the node covers 2^level x 2^level cells
+		bool		isMarked		{};
+		bool		hasBounds		{};
+		int64_t		boundsLeft		{};		// relative to the node's top left, valid when hasBounds and population > 0
+		int64_t		boundsTop		{};
+		int64_t		boundsRight		{};
+		int64_t		boundsBottom	{};
+	};
+
+	struct NodeKey
+	{
+		const Node* nwPtr; const Node* nePtr; const Node* swPtr; const Node* sePtr;
+		bool operator==(const NodeKey& other) const = default;
+	};
+
+	struct NodeKeyHash
+	{
+		size_t operator()(const NodeKey& key) const;
+	};
+
+	// Private Member Functions
+	Node*		Join			(Node* nwPtr, Node* nePtr, Node* swPtr, Node* sePtr);
+	Node*		Empty			(int level);
+	Node*		Center			(Node* nodePtr);
+	Node*		Expand			(Node* nodePtr);
+	Node*		Successor		(Node* nodePtr);
+	Node*		StepLevel2		(Node* nodePtr);
+	Node*		SetCell			(Node* nodePtr, int64_t x, int64_t y, bool alive);
+
+	bool		GetCell			(const Node* nodePtr, int64_t x, int64_t y)	const;
+	Node*		GetTile			(Node* rootPtr, int64_t left, int64_t top);		// the TILE_SIZE square at a multiple of TILE_SIZE
+	void		AddViewCells	(const Node* nodePtr, int64_t left, int64_t top);	// sets the bits of m_ViewCells
+	bool		FitsInCenter	(const Node* nodePtr)						const;	// every alive cell lies in the center half
+	void		ComputeBounds	(Node* nodePtr);
+	void		Mark			(Node* nodePtr);
+	void		ClearResults	(int newStepLog2);		// drops the results whose jump size changes
+	Node*		AllocateNode	();
+	bool		Jump			(int log2Generations);
+
+	int64_t		RootHalf		()		const	{ return int64_t{ 1 } << (m_RootPtr->level - 1); }
+
+	// Coordinates are int64, the root never grows past this level
+	static const int MAX_LEVEL{ 62 };
+	static const int TILE_LEVEL{ 6 };
+	static const size_t NODES_PER_BLOCK{ 1 << 16 };
+
+	// Member Variables
+	std::vector<std::unique_ptr<Node[]>>					m_NodeBlocks	{};
+	size_t													m_BlockUsed		{};		// nodes handed out from the last block
+	std::vector<Node*>										m_FreeNodes		{};
+	std::unordered_map<NodeKey, Node*, NodeKeyHash>			m_Nodes			{};
+	std::vector<Node*>										m_EmptyNodes	{};		// per level
+	Node													m_Dead			{};
+	Node													m_Alive			{};
+	Node*													m_RootPtr		{};		// centered on (0, 0)
+	Node*													m_PreviousRootPtr	{};	// before the last step, for GetChangedTiles
+	int														m_StepLog2		{ -1 };	// the jump size the results were computed for
+	uint64_t												m_Generation	{};
+	size_t													m_NodeCount		{};
+	size_t													m_MaxNodes		{ 4'000'000 };
+
+	// Viewport
+	int64_t													m_ViewLeft		{};
+	int64_t													m_ViewTop		{};
+	int														m_ViewWidth		{};
+	int														m_ViewHeight	{};
+	std::vector<uint64_t>									m_ViewCells		{};		// reused by AppendCellRects, one bit per cell
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <sol/sol.hpp>
+#include "GameEngine.h"
+
+class InputBindings{
+public:
+    // { type = "MouseMove", x = ..., y = ... }, the other fields only for the types that have them
+    static sol::table ToTable(sol::state_view& lua, const EngineEvent& event){
+        switch (event.type) {
+            case EngineEvent::Type::MouseMove:
+                return lua.create_table_with("type", "MouseMove", "x", event.x, "y", event.y);
+            case EngineEvent::Type::MouseButton:
+                return lua.create_table_with("type", "MouseButton", "x", event.x, "y", event.y, "isLeft", event.isLeft, "isDown", event.isDown);
+            case EngineEvent::Type::MouseWheel:
+                return lua.create_table_with("type", "MouseWheel", "x", event.x, "y", event.y, "distance", event.distance);
+            case EngineEvent::Type::KeyDown:
+                return lua.create_table_with("type", "KeyDown", "key", event.key, "isRepeat", event.isRepeat);
+            case EngineEvent::Type::KeyUp:
+                return lua.create_table_with("type", "KeyUp", "key", event.key);
+            case EngineEvent::Type::FocusGained:
+                return lua.create_table_with("type", "FocusGained");
+            default:
+                return lua.create_table_with("type", "FocusLost");
+        }
+    }
+    // every event of this tick in one array
+    static sol::table GetEvents(sol::this_state luaState){
+        sol::state_view lua{ luaState };
+        const std::vector<EngineEvent>& events{ GAME_ENGINE->GetEvents() };
+
+        sol::table eventsTable = lua.create_table((int)events.size());
+        for (const EngineEvent& event : events) eventsTable.add(ToTable(lua, event));
+        return eventsTable;
+    }
+    // for event in Input.PollEvents() do ... end, one table per step instead of all of them up front
+    static sol::object PollEvents(sol::this_state luaState){
+        return sol::make_object(luaState, [index = size_t{}](sol::this_state iteratorState) mutable -> sol::object {
+            const std::vector<EngineEvent>& events{ GAME_ENGINE->GetEvents() };
+            if (index >= events.size()) return sol::lua_nil;
+
+            sol::state_view lua{ iteratorState };
+            return ToTable(lua, events[index++]);
+        });
+    }
+    static uint64_t GetDroppedCount(){return GAME_ENGINE->GetDroppedEventCount();}
+    static void CreateBindings(sol::state& state){
+        state.new_usertype<InputBindings>(
+            "Input",
+            "GetEvents", &InputBindings::GetEvents,
+            "PollEvents", &InputBindings::PollEvents,
+            "GetDroppedCount", &InputBindings::GetDroppedCount
+        );
+    }
+};
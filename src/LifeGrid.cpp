@@ -0,0 +1,441 @@
+//-----------------------------------------------------------------
+// Life Grid
+// C++ Source - LifeGrid.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "LifeGrid.h"
+#include "LifeKernels.h"
+#include "ThreadPool.h"
+#include "FloatBuffer.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <iterator>
+#include <random>
+
+//-----------------------------------------------------------------
+// Patterns
+//-----------------------------------------------------------------
+namespace
+{
+	// Gosper glider gun, fires a glider to the bottom right every 30 generations
+	const char* const GLIDER_GUN[]
+	{
+		"........................O...........",
+		"......................O.O...........",
+		"............OO......OO............OO",
+		"...........O...O....OO............OO",
+		"OO........O.....O...OO..............",
+		"OO........O...O.OO....O.O...........",
+		"..........O.....O.......O...........",
+		"...........O...O....................",
+		"............OO......................",
+	};
+}
+
+//-----------------------------------------------------------------
+// LifeGrid Constructor(s)
+//-----------------------------------------------------------------
+LifeGrid::LifeGrid(int width, int height)
+	: m_Width		{ std::max(width, 0) }
+	, m_Height		{ std::max(height, 0) }
+	, m_WordsPerRow	{ (m_Width + 63) / 64 }
+	, m_Stride		{ m_WordsPerRow + 2 }
+{
+	const int lastBits{ m_Width % 64 };
+	m_LastWordMask = lastBits == 0 ? ~uint64_t{} : (uint64_t{ 1 } << lastBits) - 1;
+
+	m_Cells.assign((size_t)(m_Height + 2) * m_Stride, 0);
+	m_Next.assign(m_Cells.size(), 0);
+
+	m_TilesX = m_WordsPerRow;
+	m_TilesY = (m_Height + TILE_SIZE - 1) / TILE_SIZE;
+	m_TileChanged.assign((size_t)m_TilesX * m_TilesY, 0);
+	m_TileNeeded.assign(m_TileChanged.size(), 0);
+}
+
+//-----------------------------------------------------------------
+// LifeGrid Member Functions
+//-----------------------------------------------------------------
+bool LifeGrid::Get(int x, int y) const
+{
+	if (x < 0 || x >= m_Width || y < 0 || y >= m_Height) return false;
+
+	return (RowPtr(m_Cells, y)[x / 64] >> (x % 64)) & 1;
+}
+
+void LifeGrid::Set(int x, int y, bool alive)
+{
+	if (x < 0 || x >= m_Width || y < 0 || y >= m_Height) return;
+
+	uint64_t& word = RowPtr(m_Cells, y)[x / 64];
+	const uint64_t bit{ uint64_t{ 1 } << (x % 64) };
+
+	if (alive) word |= bit;
+	else word &= ~bit;
+
+	MarkTileChanged(x, y);
+}
+
+void LifeGrid::Toggle(int x, int y)
+{
+	if (x < 0 || x >= m_Width || y < 0 || y >= m_Height) return;
+
+	RowPtr(m_Cells, y)[x / 64] ^= uint64_t{ 1 } << (x % 64);
+	MarkTileChanged(x, y);
+}
+
+void LifeGrid::Clear()
+{
+	std::fill(m_Cells.begin(), m_Cells.end(), 0);
+	MarkAllChanged();
+	m_Generation = 0;
+}
+
+void LifeGrid::Randomize(double density, uint32_t seed)
+{
+	std::mt19937 generator{ seed };
+	std::bernoulli_distribution isAlive{ std::clamp(density, 0.0, 1.0) };
+
+	for (int y{}; y < m_Height; ++y)
+	{
+		for (int x{}; x < m_Width; ++x) Set(x, y, isAlive(generator));
+	}
+	m_Generation = 0;
+}
+
+void LifeGrid::Step(int generations)
+{
+	for (int count{}; count < generations; ++count)
+	{
+		if (m_IsSparse) StepSparse();
+		else StepDense();
+
+		m_Cells.swap(m_Next);
+		++m_Generation;
+	}
+}
+
+void LifeGrid::SetSparse(bool isSparse)
+{
+	// dense steps do not keep the tile flags up to date, so start from "everything changed"
+	if (isSparse && !m_IsSparse) MarkAllChanged();
+
+	m_IsSparse = isSparse;
+	m_ActiveTiles.clear();
+}
+
+std::vector<int> LifeGrid::GetChangedTiles() const
+{
+	std::vector<int> rects{};
+	for (int tileY{}; tileY < m_TilesY; ++tileY)
+	{
+		for (int tileX{}; tileX < m_TilesX; ++tileX)
+		{
+			if (!m_TileChanged[(size_t)tileY * m_TilesX + tileX]) continue;
+
+			rects.push_back(tileX * TILE_SIZE);
+			rects.push_back(tileY * TILE_SIZE);
+			rects.push_back(std::min((tileX + 1) * TILE_SIZE, m_Width));
+			rects.push_back(std::min((tileY + 1) * TILE_SIZE, m_Height));
+		}
+	}
+	return rects;
+}
+
+void LifeGrid::AppendCellRects(std::vector<float>& coords, float cellSize) const
+{
+	// one rect per horizontal run of alive cells, the zero and one runs are found a word at a time
+	for (int y{}; y < m_Height; ++y)
+	{
+		const uint64_t* rowPtr = RowPtr(m_Cells, y);
+		int runStart{ -1 };
+
+		auto addRun = [&](int runEnd)
+		{
+			coords.insert(coords.end(), { runStart * cellSize, y * cellSize, runEnd * cellSize, (y + 1) * cellSize });
+			runStart = -1;
+		};
+
+		for (int wordIndex{}; wordIndex < m_WordsPerRow; ++wordIndex)
+		{
+			const uint64_t word{ rowPtr[wordIndex] };
+			int bit{};
+			while (bit < 64)
+			{
+				// inside a run look for the next dead cell, outside it for the next alive one
+				const uint64_t rest{ (runStart < 0 ? word : ~word) >> bit };
+				if (rest == 0) break;
+
+				bit += std::countr_zero(rest);
+				if (runStart < 0) runStart = wordIndex * 64 + bit;
+				else addRun(wordIndex * 64 + bit);
+			}
+		}
+
+		if (runStart >= 0) addRun(m_Width);
+	}
+}
+
+uint64_t LifeGrid::GetPopulation() const
+{
+	uint64_t population{};
+	for (uint64_t word : m_Cells) population += std::popcount(word);
+
+	return population;
+}
+
+void LifeGrid::StepDense()
+{
+	// every band reads the whole previous generation, halo rows included, and writes only its own rows
+	// of the next one, so the bands need no locks and only the buffer swap waits for all of them
+	const int threadCount{ m_ThreadPoolPtr ? m_ThreadPoolPtr->GetThreadCount() : 1 };
+	const int bandCount{ std::clamp(m_Height / MIN_BAND_ROWS, 1, threadCount * 4) };
+
+	if (threadCount == 1 || bandCount == 1) StepRows(0, m_Height);
+	else
+	{
+		m_ThreadPoolPtr->ParallelFor(bandCount, [this, bandCount](int band)
+		{
+			StepRows(m_Height * band / bandCount, m_Height * (band + 1) / bandCount);
+		});
+	}
+}
+
+void LifeGrid::StepSparse()
+{
+	// a tile can only change when it or one of its eight neighbors changed in the previous step
+	std::fill(m_TileNeeded.begin(), m_TileNeeded.end(), uint8_t{});
+	for (int tileY{}; tileY < m_TilesY; ++tileY)
+	{
+		for (int tileX{}; tileX < m_TilesX; ++tileX)
+		{
+			if (!m_TileChanged[(size_t)tileY * m_TilesX + tileX]) continue;
+
+			for (int neighborY{ std::max(tileY - 1, 0) }; neighborY <= std::min(tileY + 1, m_TilesY - 1); ++neighborY)
+			{
+				for (int neighborX{ std::max(tileX - 1, 0) }; neighborX <= std::min(tileX + 1, m_TilesX - 1); ++neighborX)
+				{
+					m_TileNeeded[(size_t)neighborY * m_TilesX + neighborX] = 1;
+				}
+			}
+		}
+	}
+
+	m_ActiveTiles.clear();
+	for (int tile{}; tile < (int)m_TileNeeded.size(); ++tile)
+	{
+		if (m_TileNeeded[tile]) m_ActiveTiles.push_back(tile);
+	}
+
+	// the skipped tiles keep their flag at 0, their cells in m_Next are already the current ones
+	std::fill(m_TileChanged.begin(), m_TileChanged.end(), uint8_t{});
+
+	const LifeKernels::Board board{ RowPtr(m_Cells, 0), RowPtr(m_Next, 0), m_Stride, m_WordsPerRow, m_LastWordMask };
+	auto stepTile = [this, &board](int tile)
+	{
+		const int tileX{ tile % m_TilesX }, tileY{ tile / m_TilesX };
+		const int firstRow{ tileY * TILE_SIZE }, endRow{ std::min(firstRow + TILE_SIZE, m_Height) };
+
+		LifeKernels::Step(board, firstRow, endRow, tileX, tileX + 1);
+
+		uint64_t difference{};
+		for (int y{ firstRow }; y < endRow; ++y) difference |= RowPtr(m_Cells, y)[tileX] ^ RowPtr(m_Next, y)[tileX];
+		m_TileChanged[tile] = difference != 0;
+	};
+
+	// each task owns its tiles' rows of m_Next and their flags, so the result does not depend on the threads
+	const int activeCount{ (int)m_ActiveTiles.size() };
+	const int threadCount{ m_ThreadPoolPtr ? m_ThreadPoolPtr->GetThreadCount() : 1 };
+	const int taskCount{ std::min(activeCount / 8, threadCount * 4) };
+
+	if (threadCount == 1 || taskCount <= 1)
+	{
+		for (int tile : m_ActiveTiles) stepTile(tile);
+	}
+	else
+	{
+		m_ThreadPoolPtr->ParallelFor(taskCount, [this, &stepTile, activeCount, taskCount](int task)
+		{
+			for (int index{ activeCount * task / taskCount }; index < activeCount * (task + 1) / taskCount; ++index)
+			{
+				stepTile(m_ActiveTiles[index]);
+			}
+		});
+	}
+}
+
+void LifeGrid::StepRows(int firstRow, int endRow)
+{
+	const LifeKernels::Board board{ RowPtr(m_Cells, 0), RowPtr(m_Next, 0), m_Stride, m_WordsPerRow, m_LastWordMask };
+	LifeKernels::Step(board, firstRow, endRow, 0, m_WordsPerRow);
+}
+
+std::vector<LifeGrid::BenchmarkResult> LifeGrid::Benchmark(int size, int generations)
+{
+	LifeGrid start{ size, size };
+	start.Randomize(0.3, 1);
+
+	const LifeKernels::Level previousLevel{ LifeKernels::GetLevel() };
+	const int supported{ (int)LifeKernels::GetSupportedLevel() };
+
+	std::vector<BenchmarkResult> results{};
+	std::vector<uint64_t> referenceCells{};
+
+	for (int level{}; level <= supported; ++level)
+	{
+		LifeKernels::SetLevel((LifeKernels::Level)level);
+
+		LifeGrid grid{ start };
+		const auto startTime = std::chrono::steady_clock::now();
+		grid.Step(generations);
+		const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - startTime;
+
+		// every level has to end on exactly the same board as the scalar reference
+		if (level == 0) referenceCells = grid.m_Cells;
+		const bool matches{ grid.m_Cells == referenceCells };
+
+		const double cells{ (double)size * size * generations };
+		results.push_back(BenchmarkResult{ LifeKernels::GetLevelName((LifeKernels::Level)level), cells / std::max(seconds.count(), 1e-9), matches });
+	}
+
+	LifeKernels::SetLevel(previousLevel);
+	return results;
+}
+
+std::vector<LifeGrid::ScalingResult> LifeGrid::BenchmarkThreads(int size, int generations, int maxThreads)
+{
+	LifeGrid start{ size, size };
+	start.Randomize(0.3, 1);
+
+	std::vector<ScalingResult> results{};
+	std::vector<uint64_t> referenceCells{};
+
+	for (int threadCount{ 1 }; threadCount <= std::max(maxThreads, 1); ++threadCount)
+	{
+		ThreadPool threadPool{ threadCount - 1 };
+
+		LifeGrid grid{ start };
+		grid.SetThreadPool(&threadPool);
+
+		const auto startTime = std::chrono::steady_clock::now();
+		grid.Step(generations);
+		const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - startTime;
+
+		if (threadCount == 1) referenceCells = grid.m_Cells;
+		const bool matches{ grid.m_Cells == referenceCells };
+
+		const double cells{ (double)size * size * generations };
+		results.push_back(ScalingResult{ threadCount, cells / std::max(seconds.count(), 1e-9), matches });
+	}
+
+	return results;
+}
+
+std::vector<LifeGrid::BenchmarkResult> LifeGrid::BenchmarkSparse(int size, int generations)
+{
+	// one gun per 1024 x 1024 block, the rest of the board stays dead
+	LifeGrid start{ size, size };
+	const int spacing{ std::clamp(size, 1, 1024) };
+	for (int blockY{}; blockY + spacing <= size; blockY += spacing)
+	{
+		for (int blockX{}; blockX + spacing <= size; blockX += spacing)
+		{
+			for (int row{}; row < (int)std::size(GLIDER_GUN); ++row)
+			{
+				for (int column{}; GLIDER_GUN[row][column] != '\0'; ++column)
+				{
+					if (GLIDER_GUN[row][column] == 'O') start.Set(blockX + 8 + column, blockY + 8 + row, true);
+				}
+			}
+		}
+	}
+
+	std::vector<BenchmarkResult> results{};
+	std::vector<uint64_t> referenceCells{};
+
+	for (bool isSparse : { false, true })
+	{
+		LifeGrid grid{ start };
+		grid.SetSparse(isSparse);
+
+		const auto startTime = std::chrono::steady_clock::now();
+		grid.Step(generations);
+		const std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - startTime;
+
+		if (!isSparse) referenceCells = grid.m_Cells;
+		const bool matches{ grid.m_Cells == referenceCells };
+
+		const double cells{ (double)size * size * generations };
+		results.push_back(BenchmarkResult{ isSparse ? "Sparse" : "Dense", cells / std::max(seconds.count(), 1e-9), matches });
+	}
+
+	return results;
+}
+
+void LifeGrid::CreateBindings(sol::state& state, ThreadPool* threadPoolPtr)
+{
+	state.new_usertype<LifeGrid>(
+		"LifeGrid",
+		sol::factories([threadPoolPtr](int width, int height)
+		{
+			LifeGrid grid{ width, height };
+			grid.SetThreadPool(threadPoolPtr);
+			return grid;
+		}),
+		"Get", &LifeGrid::Get,
+		"Set", &LifeGrid::Set,
+		"Toggle", &LifeGrid::Toggle,
+		"Clear", &LifeGrid::Clear,
+		"Randomize", &LifeGrid::Randomize,
+		"Step", sol::overload(
+			[](LifeGrid& grid) { grid.Step(1); },
+			[](LifeGrid& grid, int generations) { grid.Step(generations); }),
+		"GetWidth", &LifeGrid::GetWidth,
+		"GetHeight", &LifeGrid::GetHeight,
+		"GetGeneration", &LifeGrid::GetGeneration,
+		"GetPopulation", &LifeGrid::GetPopulation,
+		"SetSparse", &LifeGrid::SetSparse,
+		"IsSparse", &LifeGrid::IsSparse,
+		"GetActiveTileCount", &LifeGrid::GetActiveTileCount,
+		"GetChangedTiles", [](const LifeGrid& grid) { return sol::as_table(grid.GetChangedTiles()); },
+		"GetCellRects", [](const LifeGrid& grid, FloatBuffer& buffer, float cellSize) { grid.AppendCellRects(buffer.GetValues(), cellSize); },
+		"Benchmark", [](int size, int generations, sol::this_state luaState)
+		{
+			// { { name = "SWAR", cellsPerSecond = ..., matches = true }, ... } from the slowest to the fastest level
+			sol::state_view lua{ luaState };
+			sol::table resultsTable = lua.create_table();
+			for (const BenchmarkResult& result : Benchmark(size, generations))
+			{
+				resultsTable.add(lua.create_table_with("name", result.name, "cellsPerSecond", result.cellsPerSecond, "matches", result.matchesReference));
+			}
+			return resultsTable;
+		},
+		"BenchmarkSparse", [](int size, int generations, sol::this_state luaState)
+		{
+			sol::state_view lua{ luaState };
+			sol::table resultsTable = lua.create_table();
+			for (const BenchmarkResult& result : BenchmarkSparse(size, generations))
+			{
+				resultsTable.add(lua.create_table_with("name", result.name, "cellsPerSecond", result.cellsPerSecond, "matches", result.matchesReference));
+			}
+			return resultsTable;
+		},
+		"BenchmarkThreads", [threadPoolPtr](int size, int generations, sol::this_state luaState)
+		{
+			// { { threads = 1, cellsPerSecond = ..., matches = true }, ... } up to the engine's thread count
+			sol::state_view lua{ luaState };
+			sol::table resultsTable = lua.create_table();
+			const int maxThreads{ threadPoolPtr ? threadPoolPtr->GetThreadCount() : 1 };
+			for (const ScalingResult& result : BenchmarkThreads(size, generations, maxThreads))
+			{
+				resultsTable.add(lua.create_table_with("threads", result.threadCount, "cellsPerSecond", result.cellsPerSecond, "matches", result.matchesReference));
+			}
+			return resultsTable;
+		}
+	);
+}
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------
+// Life Grid
+// C++ Header - LifeGrid.h - version v8_01
+//
+// Game of Life board stored as one bit per cell, 64 cells per word.
+// Cells outside the board are dead, the same rule the Lua version used.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <sol/sol.hpp>
+
+class ThreadPool;
+
+//-----------------------------------------------------------------
+// LifeGrid Class
+//-----------------------------------------------------------------
+class LifeGrid final
+{
+public:
+	// Constructor(s) and destructor
+	LifeGrid(int width, int height);
+	~LifeGrid() = default;
+
+	LifeGrid(const LifeGrid& other)					= default;
+	LifeGrid(LifeGrid&& other) noexcept				= default;
+	LifeGrid& operator=(const LifeGrid& other)		= default;
+	LifeGrid& operator=(LifeGrid&& other) noexcept	= default;
+
+	// General Member Functions, coordinates are 0 based and out of range cells read as dead
+	bool		Get				(int x, int y)		const;
+	void		Set				(int x, int y, bool alive);
+	void		Toggle			(int x, int y);
+	void		Clear			();
+	void		Randomize		(double density, uint32_t seed);
+
+	void		Step			(int generations = 1);
+
+	// Steps bands of rows in parallel on the pool, the result does not depend on the thread count
+	void		SetThreadPool	(ThreadPool* threadPoolPtr)			{ m_ThreadPoolPtr = threadPoolPtr; }
+
+	// Sparse stepping only evaluates the tiles that changed in the previous generation and the tiles
+	// around them, so still lifes and dead space cost nothing. A tile is one word wide and 64 rows high.
+	static const int TILE_SIZE{ 64 };
+
+	void		SetSparse		(bool isSparse);
+	bool		IsSparse		()					const	{ return m_IsSparse; }
+	int			GetActiveTileCount	()				const	{ return (int)m_ActiveTiles.size(); }
+
+	// Tiles whose cells changed in the last step, as cell rectangles: left, top, right, bottom (exclusive)
+	std::vector<int>	GetChangedTiles	()			const;
+
+	// Appends left, top, right, bottom per horizontal run of alive cells, scaled by cellSize, for Draw.FillRects
+	void		AppendCellRects	(std::vector<float>& coords, float cellSize)	const;
+
+	int			GetWidth		()					const	{ return m_Width; }
+	int			GetHeight		()					const	{ return m_Height; }
+	uint64_t	GetGeneration	()					const	{ return m_Generation; }
+	uint64_t	GetPopulation	()					const;
+
+	// Steps a random size x size board with every kernel level the CPU supports
+	struct BenchmarkResult
+	{
+		const char*	name				{};
+		double		cellsPerSecond		{};
+		bool		matchesReference	{};		// same board as the scalar kernel after all generations
+	};
+	static std::vector<BenchmarkResult>	Benchmark			(int size, int generations);
+
+	// Same board on 1 to maxThreads threads, the results name the thread count
+	struct ScalingResult
+	{
+		int			threadCount			{};
+		double		cellsPerSecond		{};
+		bool		matchesReference	{};		// same board as the single threaded run
+	};
+	static std::vector<ScalingResult>	BenchmarkThreads	(int size, int generations, int maxThreads);
+
+	// Dense against sparse stepping on a mostly empty size x size board with glider guns on it
+	static std::vector<BenchmarkResult>	BenchmarkSparse		(int size, int generations);
+
+	static void	CreateBindings	(sol::state& state, ThreadPool* threadPoolPtr);
+
+private:
+	// Rows start at word 1 of their stride and have a dead guard word on both sides,
+	// plus a dead guard row above and below the board, so the stepping needs no edge checks
+	uint64_t*		RowPtr		(std::vector<uint64_t>& cells, int y)			{ return cells.data() + (size_t)(y + 1) * m_Stride + 1; }
+	const uint64_t*	RowPtr		(const std::vector<uint64_t>& cells, int y)	const	{ return cells.data() + (size_t)(y + 1) * m_Stride + 1; }
+
+	void		StepRows		(int firstRow, int endRow);		// m_Cells -> m_Next for rows [firstRow, endRow)
+
+	void		StepDense		();
+	void		StepSparse		();
+	void		MarkTileChanged	(int x, int y)		{ m_TileChanged[(size_t)(y / TILE_SIZE) * m_TilesX + x / TILE_SIZE] = 1; }
+	void		MarkAllChanged	()					{ std::fill(m_TileChanged.begin(), m_TileChanged.end(), uint8_t{ 1 }); }
+
+	// Rows per band, small enough to balance the load and big enough to keep the scheduling cost low
+	static const int MIN_BAND_ROWS{ 16 };
+
+	// Member Variables
+	int						m_Width			{};
+	int						m_Height		{};
+	int						m_WordsPerRow	{};
+	int						m_Stride		{};
+	uint64_t				m_LastWordMask	{};		// the valid bits of the last word in a row
+	uint64_t				m_Generation	{};
+	std::vector<uint64_t>	m_Cells			{};
+	std::vector<uint64_t>	m_Next			{};
+	ThreadPool*				m_ThreadPoolPtr	{};
+
+	// Sparse stepping, a tile that did not change has the same cells in m_Next as in m_Cells
+	bool					m_IsSparse		{};
+	int						m_TilesX		{};
+	int						m_TilesY		{};
+	std::vector<uint8_t>	m_TileChanged	{};		// per tile, changed in the last step or edited since
+	std::vector<uint8_t>	m_TileNeeded	{};		// reused by StepSparse
+	std::vector<int>		m_ActiveTiles	{};		// the tiles the last sparse step evaluated
+};
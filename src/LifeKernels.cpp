@@ -0,0 +1,232 @@
+//-----------------------------------------------------------------
+// Life Kernels
+// C++ Source - LifeKernels.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "LifeKernels.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+
+#if defined(CPU_FEATURES_X86)
+	#include <immintrin.h>
+#endif
+
+//-----------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------
+namespace
+{
+	LifeKernels::Level g_Level{ LifeKernels::GetSupportedLevel() };
+
+	// adds three one bit numbers in every bit position
+	inline uint64_t FullAdd(uint64_t x, uint64_t y, uint64_t z, uint64_t& carry)
+	{
+		const uint64_t partial{ x ^ y };
+		carry = (x & y) | (partial & z);
+		return partial ^ z;
+	}
+
+	// the next state of the 64 cells in rowPtr[word], bit i of a west word holds the cell left of cell i
+	inline uint64_t StepWord(const uint64_t* abovePtr, const uint64_t* rowPtr, const uint64_t* belowPtr, int word)
+	{
+		const uint64_t above{ abovePtr[word] }, row{ rowPtr[word] }, below{ belowPtr[word] };
+		const uint64_t aboveWest{ (above << 1) | (abovePtr[word - 1] >> 63) }, aboveEast{ (above >> 1) | (abovePtr[word + 1] << 63) };
+		const uint64_t rowWest  { (row   << 1) | (rowPtr[word - 1]   >> 63) }, rowEast  { (row   >> 1) | (rowPtr[word + 1]   << 63) };
+		const uint64_t belowWest{ (below << 1) | (belowPtr[word - 1] >> 63) }, belowEast{ (below >> 1) | (belowPtr[word + 1] << 63) };
+
+		// neighbor count as bit planes: ones, twos and "four or more"
+		uint64_t carryA, carryB, carryOnes, carryTwos;
+		const uint64_t sumA{ FullAdd(aboveWest, above, aboveEast, carryA) };
+		const uint64_t sumB{ FullAdd(rowWest, rowEast, belowWest, carryB) };
+		const uint64_t sumC{ below ^ belowEast };
+		const uint64_t carryC{ below & belowEast };
+
+		const uint64_t ones{ FullAdd(sumA, sumB, sumC, carryOnes) };
+		const uint64_t twosPartial{ FullAdd(carryA, carryB, carryC, carryTwos) };
+		const uint64_t twos{ twosPartial ^ carryOnes };
+		const uint64_t fours{ carryTwos | (twosPartial & carryOnes) };
+
+		// alive next generation with 3 neighbors, or with 2 when alive now
+		return ~fours & twos & (ones | row);
+	}
+
+	// the last word of a row may hold bits past the board width, they have to stay dead
+	inline void MaskLastWord(const LifeKernels::Board& board, int firstRow, int endRow, int endWord)
+	{
+		if (endWord != board.wordsPerRow) return;
+
+		for (int y{ firstRow }; y < endRow; ++y)
+		{
+			board.nextPtr[y * board.stride + board.wordsPerRow - 1] &= board.lastWordMask;
+		}
+	}
+
+#if defined(CPU_FEATURES_X86)
+	TARGET_AVX2 inline __m256i FullAddAVX2(__m256i x, __m256i y, __m256i z, __m256i& carry)
+	{
+		const __m256i partial = _mm256_xor_si256(x, y);
+		carry = _mm256_or_si256(_mm256_and_si256(x, y), _mm256_and_si256(partial, z));
+		return _mm256_xor_si256(partial, z);
+	}
+
+	TARGET_AVX2 inline __m256i WestAVX2(const uint64_t* rowPtr, int word, __m256i center)
+	{
+		const __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowPtr + word - 1));
+		return _mm256_or_si256(_mm256_slli_epi64(center, 1), _mm256_srli_epi64(left, 63));
+	}
+
+	TARGET_AVX2 inline __m256i EastAVX2(const uint64_t* rowPtr, int word, __m256i center)
+	{
+		const __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowPtr + word + 1));
+		return _mm256_or_si256(_mm256_srli_epi64(center, 1), _mm256_slli_epi64(right, 63));
+	}
+
+	// StepWord for the four words starting at rowPtr[word]
+	TARGET_AVX2 inline __m256i StepWordsAVX2(const uint64_t* abovePtr, const uint64_t* rowPtr, const uint64_t* belowPtr, int word)
+	{
+		const __m256i above = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(abovePtr + word));
+		const __m256i row   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rowPtr   + word));
+		const __m256i below = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(belowPtr + word));
+
+		__m256i carryA, carryB, carryOnes, carryTwos;
+		const __m256i sumA = FullAddAVX2(WestAVX2(abovePtr, word, above), above, EastAVX2(abovePtr, word, above), carryA);
+		const __m256i sumB = FullAddAVX2(WestAVX2(rowPtr, word, row), EastAVX2(rowPtr, word, row), WestAVX2(belowPtr, word, below), carryB);
+		const __m256i belowEast = EastAVX2(belowPtr, word, below);
+		const __m256i sumC   = _mm256_xor_si256(below, belowEast);
+		const __m256i carryC = _mm256_and_si256(below, belowEast);
+
+		const __m256i ones        = FullAddAVX2(sumA, sumB, sumC, carryOnes);
+		const __m256i twosPartial = FullAddAVX2(carryA, carryB, carryC, carryTwos);
+		const __m256i twos        = _mm256_xor_si256(twosPartial, carryOnes);
+		const __m256i fours       = _mm256_or_si256(carryTwos, _mm256_and_si256(twosPartial, carryOnes));
+
+		return _mm256_andnot_si256(fours, _mm256_and_si256(twos, _mm256_or_si256(ones, row)));
+	}
+#endif
+}
+
+//-----------------------------------------------------------------
+// LifeKernels Member Functions
+//-----------------------------------------------------------------
+void LifeKernels::Step(const Board& board, int firstRow, int endRow, int firstWord, int endWord)
+{
+	switch (g_Level)
+	{
+	case Level::AVX2:	StepAVX2(board, firstRow, endRow, firstWord, endWord);		break;
+	case Level::SWAR:	StepSWAR(board, firstRow, endRow, firstWord, endWord);		break;
+	default:			StepScalar(board, firstRow, endRow, firstWord, endWord);	break;
+	}
+}
+
+void LifeKernels::StepScalar(const Board& board, int firstRow, int endRow, int firstWord, int endWord)
+{
+	for (int y{ firstRow }; y < endRow; ++y)
+	{
+		const uint64_t* abovePtr = board.cellsPtr + (y - 1) * board.stride;
+		const uint64_t* rowPtr   = board.cellsPtr + y * board.stride;
+		const uint64_t* belowPtr = board.cellsPtr + (y + 1) * board.stride;
+		uint64_t* nextPtr = board.nextPtr + y * board.stride;
+
+		// the alive cells in column x of the three rows, x == -1 reads the guard word
+		auto column = [&](int x)
+		{
+			const int word{ x >> 6 }, bit{ x & 63 };
+			return (int)((abovePtr[word] >> bit) & 1) + (int)((rowPtr[word] >> bit) & 1) + (int)((belowPtr[word] >> bit) & 1);
+		};
+
+		// sliding window over the column sums, the cell itself is in the middle column
+		int left{ column(firstWord * 64 - 1) }, middle{ column(firstWord * 64) };
+		for (int word{ firstWord }; word < endWord; ++word)
+		{
+			uint64_t result{};
+			for (int bit{}; bit < 64; ++bit)
+			{
+				const int right{ column(word * 64 + bit + 1) };
+				const bool alive{ ((rowPtr[word] >> bit) & 1) != 0 };
+				const int neighbors{ left + middle + right - (alive ? 1 : 0) };
+
+				if (neighbors == 3 || (alive && neighbors == 2)) result |= uint64_t{ 1 } << bit;
+
+				left = middle;
+				middle = right;
+			}
+			nextPtr[word] = result;
+		}
+	}
+
+	MaskLastWord(board, firstRow, endRow, endWord);
+}
+
+void LifeKernels::StepSWAR(const Board& board, int firstRow, int endRow, int firstWord, int endWord)
+{
+	for (int y{ firstRow }; y < endRow; ++y)
+	{
+		const uint64_t* rowPtr = board.cellsPtr + y * board.stride;
+		uint64_t* nextPtr = board.nextPtr + y * board.stride;
+
+		for (int word{ firstWord }; word < endWord; ++word)
+		{
+			nextPtr[word] = StepWord(rowPtr - board.stride, rowPtr, rowPtr + board.stride, word);
+		}
+	}
+
+	MaskLastWord(board, firstRow, endRow, endWord);
+}
+
+#if defined(CPU_FEATURES_X86)
+TARGET_AVX2 void LifeKernels::StepAVX2(const Board& board, int firstRow, int endRow, int firstWord, int endWord)
+{
+	for (int y{ firstRow }; y < endRow; ++y)
+	{
+		const uint64_t* rowPtr = board.cellsPtr + y * board.stride;
+		uint64_t* nextPtr = board.nextPtr + y * board.stride;
+
+		int word{ firstWord };
+		for (; word + 4 <= endWord; word += 4)
+		{
+			const __m256i result = StepWordsAVX2(rowPtr - board.stride, rowPtr, rowPtr + board.stride, word);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(nextPtr + word), result);
+		}
+		for (; word < endWord; ++word)
+		{
+			nextPtr[word] = StepWord(rowPtr - board.stride, rowPtr, rowPtr + board.stride, word);
+		}
+	}
+
+	MaskLastWord(board, firstRow, endRow, endWord);
+}
+#else
+void LifeKernels::StepAVX2(const Board& board, int firstRow, int endRow, int firstWord, int endWord)
+{
+	StepSWAR(board, firstRow, endRow, firstWord, endWord);
+}
+#endif
+
+void LifeKernels::SetLevel(Level level)
+{
+	g_Level = std::min(level, GetSupportedLevel());
+}
+
+LifeKernels::Level LifeKernels::GetLevel()
+{
+	return g_Level;
+}
+
+LifeKernels::Level LifeKernels::GetSupportedLevel()
+{
+	return CpuFeatures::HasAVX2() ? Level::AVX2 : Level::SWAR;
+}
+
+const char* LifeKernels::GetLevelName(Level level)
+{
+	switch (level)
+	{
+	case Level::AVX2:	return "AVX2";
+	case Level::SWAR:	return "SWAR";
+	default:			return "Scalar";
+	}
+}
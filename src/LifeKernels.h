@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------
+// Life Kernels
+// C++ Header - LifeKernels.h - version v8_01
+//
+// Generation step for a bit packed Game of Life board. The SWAR
+// version counts neighbors for 64 cells at once with bitwise full
+// adders, the AVX2 version for 256. The per cell Scalar version is
+// the reference and the fallback.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+
+//-----------------------------------------------------------------
+// LifeKernels Class
+//-----------------------------------------------------------------
+class LifeKernels final
+{
+public:
+	enum class Level
+	{
+		Scalar, SWAR, AVX2
+	};
+
+	// Row y starts at cellsPtr + y * stride. Every row needs a dead word before and after it
+	// and the rows -1 and height have to exist and be dead, the kernels never check the edges.
+	struct Board
+	{
+		const uint64_t*	cellsPtr		{};
+		uint64_t*		nextPtr			{};
+		ptrdiff_t		stride			{};
+		int				wordsPerRow		{};
+		uint64_t		lastWordMask	{};		// the valid bits of the last word in a row
+	};
+
+	// Writes the next generation of rows [firstRow, endRow) and words [firstWord, endWord) of each row
+	static void			Step				(const Board& board, int firstRow, int endRow, int firstWord, int endWord);
+
+	static void			StepScalar			(const Board& board, int firstRow, int endRow, int firstWord, int endWord);
+	static void			StepSWAR			(const Board& board, int firstRow, int endRow, int firstWord, int endWord);
+	static void			StepAVX2			(const Board& board, int firstRow, int endRow, int firstWord, int endWord);
+
+	// Forces a lower level, levels the CPU does not support are clamped
+	static void			SetLevel			(Level level);
+	static Level		GetLevel			();
+	static Level		GetSupportedLevel	();
+	static const char*	GetLevelName		(Level level);
+};
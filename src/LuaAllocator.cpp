@@ -0,0 +1,242 @@
+//-----------------------------------------------------------------
+// Lua Allocator
+// C++ Source - LuaAllocator.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "LuaAllocator.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//-----------------------------------------------------------------
+// LuaAllocator Constructor(s) and Destructor
+//-----------------------------------------------------------------
+LuaAllocator::LuaAllocator()
+{
+	// 8 byte steps up to 128, 16 byte steps up to 256, 32 byte steps up to 512: at most 1/8 of a block is wasted
+	for (size_t blockSize{ 8 }; blockSize <= MAX_POOLED_SIZE; blockSize += blockSize < 128 ? 8 : blockSize < 256 ? 16 : 32)
+	{
+		m_ClassStats.push_back(ClassStats{ blockSize });
+	}
+	m_Pools.resize(m_ClassStats.size());
+
+	m_ClassOfSize.resize(MAX_POOLED_SIZE / 8 + 1);
+	int sizeClass{};
+	for (size_t index{ 1 }; index < m_ClassOfSize.size(); ++index)
+	{
+		if (index * 8 > m_ClassStats[sizeClass].blockSize) ++sizeClass;
+		m_ClassOfSize[index] = (int8_t)sizeClass;
+	}
+}
+
+LuaAllocator::~LuaAllocator()
+{
+	for (void* slabPtr : m_Slabs) free(slabPtr);
+}
+
+//-----------------------------------------------------------------
+// LuaAllocator Member Functions
+//-----------------------------------------------------------------
+void* LuaAllocator::Allocate(void* allocatorPtr, void* ptr, size_t oldSize, size_t newSize)
+{
+	LuaAllocator* thisPtr = static_cast<LuaAllocator*>(allocatorPtr);
+
+	// without a block oldSize holds the type of the new object instead
+	if (ptr == nullptr) oldSize = 0;
+
+	if (newSize == 0)
+	{
+		if (ptr != nullptr) thisPtr->Free(ptr, oldSize);
+		return nullptr;
+	}
+
+	if (ptr == nullptr) return thisPtr->Alloc(newSize);
+	return thisPtr->Realloc(ptr, oldSize, newSize);
+}
+
+void* LuaAllocator::Alloc(size_t size)
+{
+	const int sizeClass{ GetClass(size) };
+	if (sizeClass < 0)
+	{
+		void* blockPtr = malloc(size);
+		if (blockPtr == nullptr) return nullptr;
+
+		++m_Stats.mallocCalls;
+		++m_Stats.largeAllocations;
+		m_Stats.largeBytesInUse += size;
+		if (m_Stats.largeBytesInUse > m_Stats.peakLargeBytes) m_Stats.peakLargeBytes = m_Stats.largeBytesInUse;
+		m_Stats.bytesInUse += size;
+		if (m_Stats.bytesInUse > m_Stats.peakBytes) m_Stats.peakBytes = m_Stats.bytesInUse;
+		return blockPtr;
+	}
+
+	Pool& pool = m_Pools[sizeClass];
+	void* blockPtr{};
+	if (pool.freeListPtr != nullptr)
+	{
+		blockPtr = pool.freeListPtr;
+		pool.freeListPtr = pool.freeListPtr->nextPtr;
+	}
+	else
+	{
+		blockPtr = AllocFromSlab(sizeClass);
+		if (blockPtr == nullptr) return nullptr;
+	}
+
+	ClassStats& stats = m_ClassStats[sizeClass];
+	++stats.allocations;
+	if (++stats.blocksInUse > stats.peakBlocks) stats.peakBlocks = stats.blocksInUse;
+
+	++m_Stats.pooledAllocations;
+	m_Stats.bytesInUse += size;
+	if (m_Stats.bytesInUse > m_Stats.peakBytes) m_Stats.peakBytes = m_Stats.bytesInUse;
+	return blockPtr;
+}
+
+void* LuaAllocator::Realloc(void* ptr, size_t oldSize, size_t newSize)
+{
+	const int oldClass{ GetClass(oldSize) };
+	const int newClass{ GetClass(newSize) };
+
+	// the block already has room for the new size
+	if (oldClass >= 0 && oldClass == newClass)
+	{
+		m_Stats.bytesInUse += newSize - oldSize;
+		if (m_Stats.bytesInUse > m_Stats.peakBytes) m_Stats.peakBytes = m_Stats.bytesInUse;
+		return ptr;
+	}
+
+	if (oldClass < 0 && newClass < 0)
+	{
+		void* blockPtr = realloc(ptr, newSize);
+		if (blockPtr == nullptr) return newSize <= oldSize ? ptr : nullptr;
+
+		++m_Stats.mallocCalls;
+		m_Stats.largeBytesInUse += newSize - oldSize;
+		if (m_Stats.largeBytesInUse > m_Stats.peakLargeBytes) m_Stats.peakLargeBytes = m_Stats.largeBytesInUse;
+		m_Stats.bytesInUse += newSize - oldSize;
+		if (m_Stats.bytesInUse > m_Stats.peakBytes) m_Stats.peakBytes = m_Stats.bytesInUse;
+		return blockPtr;
+	}
+
+	// moving between a pool and malloc or between two pools, Lua keeps using the old block when this fails,
+	// except when shrinking: then the old block is big enough and goes back to the pool of the smaller size later
+	void* blockPtr = Alloc(newSize);
+	if (blockPtr == nullptr) return newSize <= oldSize ? ptr : nullptr;
+
+	memcpy(blockPtr, ptr, newSize < oldSize ? newSize : oldSize);
+	Free(ptr, oldSize);
+	return blockPtr;
+}
+
+void LuaAllocator::Free(void* ptr, size_t size)
+{
+	m_Stats.bytesInUse -= size;
+
+	const int sizeClass{ GetClass(size) };
+	if (sizeClass < 0)
+	{
+		m_Stats.largeBytesInUse -= size;
+		free(ptr);
+		return;
+	}
+
+	FreeBlock* blockPtr = static_cast<FreeBlock*>(ptr);
+	blockPtr->nextPtr = m_Pools[sizeClass].freeListPtr;
+	m_Pools[sizeClass].freeListPtr = blockPtr;
+
+	--m_ClassStats[sizeClass].blocksInUse;
+}
+
+void* LuaAllocator::AllocFromSlab(int sizeClass)
+{
+	Pool& pool = m_Pools[sizeClass];
+	const size_t blockSize{ m_ClassStats[sizeClass].blockSize };
+
+	if (pool.slabCursorPtr == nullptr || pool.slabCursorPtr + blockSize > pool.slabEndPtr)
+	{
+		char* slabPtr = static_cast<char*>(malloc(SLAB_SIZE));
+		if (slabPtr == nullptr) return nullptr;
+
+		m_Slabs.push_back(slabPtr);
+		++m_Stats.mallocCalls;
+		m_Stats.slabBytes += SLAB_SIZE;
+		++m_ClassStats[sizeClass].slabCount;
+
+		// the few bytes at the end of the previous slab that do not fit a block are left unused
+		pool.slabCursorPtr	= slabPtr;
+		pool.slabEndPtr		= slabPtr + SLAB_SIZE;
+	}
+
+	void* blockPtr = pool.slabCursorPtr;
+	pool.slabCursorPtr += blockSize;
+	return blockPtr;
+}
+
+LuaAllocator::Stats LuaAllocator::GetStats() const
+{
+	return m_Stats;
+}
+
+void LuaAllocator::ResetPeaks()
+{
+	m_Stats.peakBytes		= m_Stats.bytesInUse;
+	m_Stats.peakLargeBytes	= m_Stats.largeBytesInUse;
+	for (ClassStats& stats : m_ClassStats) stats.peakBlocks = stats.blocksInUse;
+}
+
+void LuaAllocator::PrintReport() const
+{
+	printf("Lua memory: %.1f KB in use, %.1f KB peak, %.1f KB in slabs, %llu malloc calls\n",
+		m_Stats.bytesInUse / 1024.0, m_Stats.peakBytes / 1024.0, m_Stats.slabBytes / 1024.0, (unsigned long long)m_Stats.mallocCalls);
+	printf("  size    in use      peak  allocations  slabs\n");
+
+	for (const ClassStats& stats : m_ClassStats)
+	{
+		if (stats.allocations == 0) continue;
+		printf("  %4zu  %8zu  %8zu  %11llu  %5zu\n", stats.blockSize, stats.blocksInUse, stats.peakBlocks, (unsigned long long)stats.allocations, stats.slabCount);
+	}
+	printf("  large: %.1f KB in use, %.1f KB peak, %llu allocations\n",
+		m_Stats.largeBytesInUse / 1024.0, m_Stats.peakLargeBytes / 1024.0, (unsigned long long)m_Stats.largeAllocations);
+}
+
+void LuaAllocator::CreateBindings(sol::state& state, LuaAllocator* allocatorPtr)
+{
+	state.new_usertype<LuaAllocator>(
+		"Memory",
+		sol::no_constructor,
+		"GetStats", [allocatorPtr](sol::this_state luaState)
+		{
+			// { inUse = ..., peak = ..., ..., classes = { { size = 8, inUse = ..., peak = ..., allocations = ... }, ... } } in bytes and blocks
+			sol::state_view lua{ luaState };
+			const Stats stats{ allocatorPtr->GetStats() };
+
+			sol::table classesTable = lua.create_table();
+			for (const ClassStats& classStats : allocatorPtr->GetClassStats())
+			{
+				classesTable.add(lua.create_table_with("size", classStats.blockSize, "inUse", classStats.blocksInUse, "peak", classStats.peakBlocks,
+					"allocations", classStats.allocations, "slabs", classStats.slabCount));
+			}
+
+			return lua.create_table_with("inUse", stats.bytesInUse, "peak", stats.peakBytes, "largeInUse", stats.largeBytesInUse, "largePeak", stats.peakLargeBytes,
+				"pooledAllocations", stats.pooledAllocations, "largeAllocations", stats.largeAllocations, "mallocCalls", stats.mallocCalls,
+				"slabBytes", stats.slabBytes, "classes", classesTable);
+		},
+		"PrintReport", [allocatorPtr]() { allocatorPtr->PrintReport(); },
+		"ResetPeaks", [allocatorPtr]() { allocatorPtr->ResetPeaks(); },
+		// 0 or nil keeps the current value of a parameter
+		"SetGenerationalGC", [](sol::optional<int> minorMultiplier, sol::optional<int> majorMultiplier, sol::this_state luaState)
+		{
+			lua_gc(luaState, LUA_GCGEN, minorMultiplier.value_or(0), majorMultiplier.value_or(0));
+		},
+		"SetIncrementalGC", [](sol::optional<int> pause, sol::optional<int> stepMultiplier, sol::optional<int> stepSize, sol::this_state luaState)
+		{
+			lua_gc(luaState, LUA_GCINC, pause.value_or(0), stepMultiplier.value_or(0), stepSize.value_or(0));
+		}
+	);
+}
@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------
+// Lua Allocator
+// C++ Header - LuaAllocator.h - version v8_01
+//
+// Allocator for the Lua state. Blocks up to MAX_POOLED_SIZE bytes come
+// from per size class pools carved out of 64 KiB slabs, so the tables,
+// strings and userdata the scripts churn through cost no malloc call
+// and freed blocks are reused for the same size. Lua passes the size of
+// every block it frees, so blocks need no header. Bigger blocks go to
+// malloc. Slabs are kept until the allocator is destroyed, the pools
+// hold on to the peak memory of each size class. Not thread safe, like
+// the Lua state itself.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <sol/sol.hpp>
+
+//-----------------------------------------------------------------
+// LuaAllocator Class
+//-----------------------------------------------------------------
+class LuaAllocator final
+{
+public:
+	// Constructor(s) and destructor
+	LuaAllocator();
+	~LuaAllocator();		// only after the Lua state using it is closed
+
+	// Disabling copy/move constructors and assignment operators, the Lua state points to the allocator
+	LuaAllocator(const LuaAllocator& other)					= delete;
+	LuaAllocator(LuaAllocator&& other) noexcept				= delete;
+	LuaAllocator& operator=(const LuaAllocator& other)		= delete;
+	LuaAllocator& operator=(LuaAllocator&& other) noexcept	= delete;
+
+	// The lua_Alloc function, pass the allocator as its user data
+	static void*	Allocate		(void* allocatorPtr, void* ptr, size_t oldSize, size_t newSize);
+
+	// Statistics, in bytes as Lua requested them
+	struct ClassStats
+	{
+		size_t		blockSize		{};
+		size_t		blocksInUse		{};
+		size_t		peakBlocks		{};		// high-water mark
+		uint64_t	allocations		{};
+		size_t		slabCount		{};
+	};
+	struct Stats
+	{
+		size_t		bytesInUse			{};
+		size_t		peakBytes			{};
+		size_t		largeBytesInUse		{};
+		size_t		peakLargeBytes		{};
+		uint64_t	pooledAllocations	{};
+		uint64_t	largeAllocations	{};
+		uint64_t	mallocCalls			{};		// slabs plus large blocks, including reallocs
+		size_t		slabBytes			{};		// reserved by the pools
+	};
+
+	Stats		GetStats		()			const;
+	const std::vector<ClassStats>&	GetClassStats	()	const	{ return m_ClassStats; }
+	void		ResetPeaks		();
+	void		PrintReport		()			const;
+
+	// Memory table for the scripts: the statistics and the garbage collector mode
+	static void	CreateBindings	(sol::state& state, LuaAllocator* allocatorPtr);
+
+	static const size_t MAX_POOLED_SIZE	{ 512 };
+
+private:
+	// Private Member Functions
+	void*		Alloc			(size_t size);
+	void*		Realloc			(void* ptr, size_t oldSize, size_t newSize);
+	void		Free			(void* ptr, size_t size);
+	int			GetClass		(size_t size)	const	{ return size <= MAX_POOLED_SIZE ? m_ClassOfSize[(size + 7) / 8] : -1; }
+	void*		AllocFromSlab	(int sizeClass);
+
+	struct FreeBlock
+	{
+		FreeBlock*	nextPtr;
+	};
+
+	struct Pool
+	{
+		FreeBlock*	freeListPtr		{};
+		char*		slabCursorPtr	{};		// the unused rest of the newest slab
+		char*		slabEndPtr		{};
+	};
+
+	static const size_t SLAB_SIZE{ 64 * 1024 };
+
+	// Member Variables
+	std::vector<Pool>		m_Pools				{};
+	std::vector<ClassStats>	m_ClassStats		{};
+	std::vector<int8_t>		m_ClassOfSize		{};		// per 8 bytes of requested size
+	std::vector<void*>		m_Slabs				{};
+	Stats					m_Stats				{};
+};
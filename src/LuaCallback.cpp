@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------
+// Lua Callback
+// C++ Source - LuaCallback.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "LuaCallback.h"
+
+#include <cstdio>
+
+//-----------------------------------------------------------------
+// LuaCallback Member Functions
+//-----------------------------------------------------------------
+bool LuaCallback::s_IsTiming{};
+
+void LuaCallback::Resolve(sol::state& state)
+{
+	// anything but a function counts as absent, so calls never have to check the type again
+	const sol::object object{ state[m_NamePtr] };
+	m_IsBound = object.get_type() == sol::type::function;
+	m_Function = m_IsBound ? object.as<sol::protected_function>() : sol::protected_function{};
+}
+
+void LuaCallback::ReportError(const sol::protected_function_result& result) const
+{
+	++m_Stats.errors;
+
+	// a broken Update fails every frame, once a second is plenty to read the message
+	const Clock::time_point now{ Clock::now() };
+	if (m_Stats.errors > 1 && now - m_LastReportTime < std::chrono::seconds{ 1 })
+	{
+		++m_SuppressedErrors;
+		return;
+	}
+
+	const sol::error error{ result };
+	if (m_SuppressedErrors > 0) printf("Lua error in %s (%llu more since the last report): %s\n", m_NamePtr, (unsigned long long)m_SuppressedErrors, error.what());
+	else printf("Lua error in %s: %s\n", m_NamePtr, error.what());
+
+	m_LastReportTime = now;
+	m_SuppressedErrors = 0;
+}
+
+void LuaCallback::CreateBindings(sol::state& state, std::vector<LuaCallback*> callbacks)
+{
+	state.new_usertype<LuaCallback>(
+		"Callbacks",
+		sol::no_constructor,
+		"GetStats", [callbacks](sol::this_state luaState)
+		{
+			// { Update = { bound = true, calls = ..., errors = ..., totalMs = ..., meanMs = ..., maxMs = ... }, ... }, the mean over the timed calls
+			sol::state_view lua{ luaState };
+			sol::table statsTable = lua.create_table();
+			for (const LuaCallback* callbackPtr : callbacks)
+			{
+				const Stats& stats = callbackPtr->GetStats();
+				const double totalMs{ stats.totalTime.count() / 1e6 };
+				statsTable[callbackPtr->GetName()] = lua.create_table_with("bound", callbackPtr->IsBound(), "calls", stats.calls, "errors", stats.errors,
+					"totalMs", totalMs, "meanMs", stats.timedCalls > 0 ? totalMs / stats.timedCalls : 0.0, "maxMs", stats.maxTime.count() / 1e6);
+			}
+			return statsTable;
+		},
+		"ResetStats", [callbacks]()
+		{
+			for (LuaCallback* callbackPtr : callbacks) callbackPtr->ResetStats();
+		},
+		"SetTiming", &LuaCallback::SetTiming,
+		"IsTiming", &LuaCallback::IsTiming
+	);
+}
@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------
+// Lua Callback
+// C++ Header - LuaCallback.h - version v8_01
+//
+// One global function of the game script the engine calls, resolved
+// once by name. A script that does not define it costs a single branch
+// per call. Calls are protected: an error in the script is caught by
+// lua_pcall, reported at most once a second per callback, and the game
+// keeps running. Every call is counted, and timed while timing is on:
+// reading the clock twice per call is not free for a callback that
+// runs per mouse move, so it is off unless a script asks for it.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <sol/sol.hpp>
+
+//-----------------------------------------------------------------
+// LuaCallback Class
+//-----------------------------------------------------------------
+class LuaCallback final
+{
+public:
+	// Constructor(s) and destructor
+	explicit LuaCallback(const char* namePtr) : m_NamePtr{ namePtr } {}
+	~LuaCallback() = default;
+
+	// Disabling copy/move constructors and assignment operators, the stats bindings point to the callbacks
+	LuaCallback(const LuaCallback& other)					= delete;
+	LuaCallback(LuaCallback&& other) noexcept				= delete;
+	LuaCallback& operator=(const LuaCallback& other)		= delete;
+	LuaCallback& operator=(LuaCallback&& other) noexcept	= delete;
+
+	// General Member Functions
+	void		Resolve			(sol::state& state);		// again after the script was reloaded
+	bool		IsBound			()		const	{ return m_IsBound; }
+	const char*	GetName			()		const	{ return m_NamePtr; }
+
+	// False when the script has no such function or it raised an error
+	template <typename... Args>
+	bool		Call			(Args&&... args)	const
+	{
+		if (!m_IsBound) return false;
+
+		++m_Stats.calls;
+		if (!s_IsTiming)
+		{
+			const sol::protected_function_result result{ m_Function(std::forward<Args>(args)...) };
+			if (result.valid()) return true;
+
+			ReportError(result);
+			return false;
+		}
+
+		const Clock::time_point startTime{ Clock::now() };
+		const sol::protected_function_result result{ m_Function(std::forward<Args>(args)...) };
+		const Clock::duration callTime{ Clock::now() - startTime };
+
+		++m_Stats.timedCalls;
+		m_Stats.totalTime += callTime;
+		if (callTime > m_Stats.maxTime) m_Stats.maxTime = callTime;
+
+		if (result.valid()) return true;
+
+		ReportError(result);
+		return false;
+	}
+
+	struct Stats
+	{
+		uint64_t					calls		{};
+		uint64_t					timedCalls	{};		// made while timing was on
+		uint64_t					errors		{};
+		std::chrono::nanoseconds	totalTime	{};
+		std::chrono::nanoseconds	maxTime		{};
+	};
+	const Stats&	GetStats	()		const	{ return m_Stats; }
+	void		ResetStats		()				{ m_Stats = Stats{}; }
+
+	// For every callback, the times only cover the calls made while it is on
+	static void	SetTiming		(bool isTiming)	{ s_IsTiming = isTiming; }
+	static bool	IsTiming		()				{ return s_IsTiming; }
+
+	// Callbacks table for the scripts with the stats of the given callbacks
+	static void	CreateBindings	(sol::state& state, std::vector<LuaCallback*> callbacks);
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	// Private Member Functions
+	void		ReportError		(const sol::protected_function_result& result)	const;
+
+	// Member Variables
+	const char*					m_NamePtr			{};
+	sol::protected_function		m_Function			{};
+	bool						m_IsBound			{};
+
+	mutable Stats				m_Stats				{};
+	mutable Clock::time_point	m_LastReportTime	{};
+	mutable uint64_t			m_SuppressedErrors	{};		// errors since the last report
+
+	static bool					s_IsTiming;
+};
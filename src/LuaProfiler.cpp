@@ -0,0 +1,218 @@
+//-----------------------------------------------------------------
+// Lua Profiler
+// C++ Source - LuaProfiler.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "LuaProfiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+std::atomic<LuaProfiler*> LuaProfiler::s_ActiveProfilerPtr{};
+
+//-----------------------------------------------------------------
+// LuaProfiler Constructor(s) and Destructor
+//-----------------------------------------------------------------
+LuaProfiler::~LuaProfiler()
+{
+	Stop();
+}
+
+//-----------------------------------------------------------------
+// LuaProfiler Member Functions
+//-----------------------------------------------------------------
+void LuaProfiler::Start(double intervalMs)
+{
+	if (IsRunning()) return;
+
+	s_ActiveProfilerPtr.store(this, std::memory_order_release);
+	m_StopSampler.store(false, std::memory_order_relaxed);
+
+	const int intervalUs{ std::clamp(int(intervalMs * 1000), 100, 1'000'000) };
+	m_SamplerThread = std::thread{ &LuaProfiler::SamplerLoop, this, intervalUs };
+}
+
+void LuaProfiler::Stop()
+{
+	if (!IsRunning()) return;
+
+	m_StopSampler.store(true, std::memory_order_relaxed);
+	m_SamplerThread.join();
+
+	// the sampler may have armed the hook right before it stopped
+	lua_sethook(m_LuaStatePtr, nullptr, 0, 0);
+	if (m_RunningThreadPtr != m_LuaStatePtr) lua_sethook(m_RunningThreadPtr, nullptr, 0, 0);
+	s_ActiveProfilerPtr.store(nullptr, std::memory_order_release);
+}
+
+void LuaProfiler::Reset()
+{
+	m_Stacks.clear();
+	m_SampleCount = 0;
+}
+
+void LuaProfiler::SamplerLoop(int intervalUs)
+{
+	// the sleep granularity of the system timer decides the real rate, the counts stay proportional either way
+	while (!m_StopSampler.load(std::memory_order_relaxed))
+	{
+		std::this_thread::sleep_for(std::chrono::microseconds{ intervalUs });
+
+		// lua_sethook is the one call that is safe from outside the thread running the script
+		if (m_ScriptDepth.load(std::memory_order_relaxed) > 0)
+		{
+			std::lock_guard<std::mutex> lock{ m_ThreadMutex };
+			lua_sethook(m_RunningThreadPtr, &LuaProfiler::SampleHook, LUA_MASKCOUNT, 1);
+		}
+	}
+}
+
+lua_State* LuaProfiler::SwitchThread(lua_State* threadPtr)
+{
+	std::lock_guard<std::mutex> lock{ m_ThreadMutex };
+	lua_State* outerThreadPtr = m_RunningThreadPtr;
+
+	// a sample armed on the thread that stops running would only fire once it runs again and be charged to what it runs then
+	if (lua_gethook(outerThreadPtr) == &LuaProfiler::SampleHook)
+	{
+		lua_sethook(outerThreadPtr, nullptr, 0, 0);
+		lua_sethook(threadPtr, &LuaProfiler::SampleHook, LUA_MASKCOUNT, 1);
+	}
+
+	m_RunningThreadPtr = threadPtr;
+	return outerThreadPtr;
+}
+
+void LuaProfiler::SampleHook(lua_State* luaStatePtr, lua_Debug*)
+{
+	// one shot, the sampler thread arms it again for the next sample
+	lua_sethook(luaStatePtr, nullptr, 0, 0);
+
+	LuaProfiler* profilerPtr = s_ActiveProfilerPtr.load(std::memory_order_acquire);
+	if (profilerPtr != nullptr && profilerPtr->m_ScriptDepth.load(std::memory_order_relaxed) > 0) profilerPtr->TakeSample(luaStatePtr);
+}
+
+void LuaProfiler::TakeSample(lua_State* luaStatePtr)
+{
+	// level 0 is the function that was running when the hook fired
+	m_FrameScratch.clear();
+	lua_Debug debug{};
+	for (int level{}; level < MAX_STACK_DEPTH && lua_getstack(luaStatePtr, level, &debug); ++level)
+	{
+		lua_getinfo(luaStatePtr, "Sn", &debug);
+
+		std::string frame{};
+		if (debug.what[0] == 'm') frame = "main chunk (" + std::string{ debug.short_src } + ")";
+		else if (debug.what[0] == 'C') frame = debug.name != nullptr ? debug.name : "[C]";
+		else frame = std::string{ debug.name != nullptr ? debug.name : "?" } + " (" + debug.short_src + ":" + std::to_string(debug.linedefined) + ")";
+
+		m_FrameScratch.push_back(std::move(frame));
+	}
+	if (m_FrameScratch.empty()) return;
+
+	m_StackScratch.clear();
+	for (auto frameIt = m_FrameScratch.rbegin(); frameIt != m_FrameScratch.rend(); ++frameIt)
+	{
+		if (!m_StackScratch.empty()) m_StackScratch += ';';
+		m_StackScratch += *frameIt;
+	}
+
+	++m_Stacks[m_StackScratch];
+	++m_SampleCount;
+}
+
+std::vector<LuaProfiler::FunctionStats> LuaProfiler::GetFlatProfile() const
+{
+	std::unordered_map<std::string, FunctionStats> functions{};
+	std::vector<std::string> stackFrames{};
+
+	for (const auto& [stack, samples] : m_Stacks)
+	{
+		stackFrames.clear();
+		size_t start{};
+		while (start <= stack.size())
+		{
+			size_t end{ stack.find(';', start) };
+			if (end == std::string::npos) end = stack.size();
+			stackFrames.push_back(stack.substr(start, end - start));
+			start = end + 1;
+		}
+
+		// a recursive function counts once per sample in its total
+		for (size_t index{}; index < stackFrames.size(); ++index)
+		{
+			if (std::find(stackFrames.begin(), stackFrames.begin() + index, stackFrames[index]) != stackFrames.begin() + index) continue;
+			functions[stackFrames[index]].totalSamples += samples;
+		}
+		functions[stackFrames.back()].selfSamples += samples;
+	}
+
+	std::vector<FunctionStats> profile{};
+	profile.reserve(functions.size());
+	for (auto& [name, stats] : functions)
+	{
+		stats.name = name;
+		profile.push_back(std::move(stats));
+	}
+
+	std::sort(profile.begin(), profile.end(), [](const FunctionStats& first, const FunctionStats& second)
+	{
+		if (first.selfSamples != second.selfSamples) return first.selfSamples > second.selfSamples;
+		return first.totalSamples > second.totalSamples;
+	});
+	return profile;
+}
+
+bool LuaProfiler::SaveCollapsedStacks(const std::string& filename) const
+{
+	std::ofstream file{ filename };
+	if (!file) return false;
+
+	for (const auto& [stack, samples] : m_Stacks) file << stack << ' ' << samples << '\n';
+
+	return (bool)file;
+}
+
+void LuaProfiler::PrintFlatProfile(int maxFunctions) const
+{
+	printf("Lua profile, %d samples\n   self   total  function\n", m_SampleCount);
+	if (m_SampleCount == 0) return;
+
+	const std::vector<FunctionStats> profile{ GetFlatProfile() };
+	for (int index{}; index < (int)profile.size() && index < maxFunctions; ++index)
+	{
+		const FunctionStats& stats = profile[index];
+		printf("%6.1f%% %6.1f%%  %s\n", 100.0 * stats.selfSamples / m_SampleCount, 100.0 * stats.totalSamples / m_SampleCount, stats.name.c_str());
+	}
+}
+
+void LuaProfiler::CreateBindings(sol::state& state, LuaProfiler* profilerPtr)
+{
+	state.new_usertype<LuaProfiler>(
+		"LuaProfiler",
+		sol::no_constructor,
+		"Start", [profilerPtr](sol::optional<double> intervalMs) { profilerPtr->Start(intervalMs.value_or(1.0)); },
+		"Stop", [profilerPtr]() { profilerPtr->Stop(); },
+		"IsRunning", [profilerPtr]() { return profilerPtr->IsRunning(); },
+		"Reset", [profilerPtr]() { profilerPtr->Reset(); },
+		"GetSampleCount", [profilerPtr]() { return profilerPtr->GetSampleCount(); },
+		"GetProfile", [profilerPtr](sol::this_state luaState)
+		{
+			// { { name = "Update (lua/GameOfLife.lua:30)", self = ..., total = ... }, ... } most self samples first
+			sol::state_view lua{ luaState };
+			sol::table profileTable = lua.create_table();
+			for (const FunctionStats& stats : profilerPtr->GetFlatProfile())
+			{
+				profileTable.add(lua.create_table_with("name", stats.name, "self", stats.selfSamples, "total", stats.totalSamples));
+			}
+			return profileTable;
+		},
+		"Save", [profilerPtr](const std::string& filename) { return profilerPtr->SaveCollapsedStacks(filename); },
+		"Print", [profilerPtr](sol::optional<int> maxFunctions) { profilerPtr->PrintFlatProfile(maxFunctions.value_or(20)); }
+	);
+}
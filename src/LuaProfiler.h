@@ -0,0 +1,122 @@
+//-----------------------------------------------------------------
+// Lua Profiler
+// C++ Header - LuaProfiler.h - version v8_01
+//
+// Sampling profiler for the game script. A sampler thread arms a one
+// shot count hook on the Lua state at a fixed interval, the hook records
+// the Lua call stack at the next instruction and removes itself again.
+// Between samples no hook is installed, while stopped there is no
+// sampler thread either. Only time spent inside a script callback is
+// sampled, the engine marks those with ScriptScope. Hooks belong to a
+// single Lua thread, so the coroutine scheduler marks the task it
+// resumes with ThreadScope and the hook is armed on that thread.
+// Coroutines a script resumes itself are sampled as their resumer.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <sol/sol.hpp>
+
+//-----------------------------------------------------------------
+// LuaProfiler Class
+//-----------------------------------------------------------------
+class LuaProfiler final
+{
+public:
+	// Constructor(s) and destructor
+	explicit LuaProfiler(lua_State* luaStatePtr) : m_LuaStatePtr{ luaStatePtr }, m_RunningThreadPtr{ luaStatePtr } {}
+	~LuaProfiler();
+
+	// Disabling copy/move constructors and assignment operators, the sampler thread and the hook point to the profiler
+	LuaProfiler(const LuaProfiler& other)					= delete;
+	LuaProfiler(LuaProfiler&& other) noexcept				= delete;
+	LuaProfiler& operator=(const LuaProfiler& other)		= delete;
+	LuaProfiler& operator=(LuaProfiler&& other) noexcept	= delete;
+
+	// Marks a call into the script, samples are only taken while one is running
+	class ScriptScope final
+	{
+	public:
+		explicit ScriptScope(const LuaProfiler& profiler) : m_Profiler{ profiler } { m_Profiler.m_ScriptDepth.fetch_add(1, std::memory_order_relaxed); }
+		~ScriptScope() { m_Profiler.m_ScriptDepth.fetch_sub(1, std::memory_order_relaxed); }
+
+		ScriptScope(const ScriptScope& other)				= delete;
+		ScriptScope& operator=(const ScriptScope& other)	= delete;
+
+	private:
+		const LuaProfiler&	m_Profiler;
+	};
+
+	// Marks a coroutine while it is resumed, samples walk its stack instead of the resumer's. Does nothing without a profiler.
+	class ThreadScope final
+	{
+	public:
+		ThreadScope(LuaProfiler* profilerPtr, lua_State* threadPtr)
+			: m_ProfilerPtr{ profilerPtr }, m_OuterThreadPtr{ profilerPtr != nullptr ? profilerPtr->SwitchThread(threadPtr) : nullptr } {}
+		~ThreadScope() { if (m_ProfilerPtr != nullptr) m_ProfilerPtr->SwitchThread(m_OuterThreadPtr); }
+
+		ThreadScope(const ThreadScope& other)				= delete;
+		ThreadScope& operator=(const ThreadScope& other)	= delete;
+
+	private:
+		LuaProfiler*	m_ProfilerPtr;
+		lua_State*		m_OuterThreadPtr;
+	};
+
+	// General Member Functions, all of them on the thread that runs the script
+	void		Start			(double intervalMs = 1.0);
+	void		Stop			();
+	bool		IsRunning		()		const	{ return m_SamplerThread.joinable(); }
+	void		Reset			();
+
+	// Per function, self counts the samples the function was on top of the stack, total the samples it was on the stack at all
+	struct FunctionStats
+	{
+		std::string		name			{};
+		int				selfSamples		{};
+		int				totalSamples	{};
+	};
+	std::vector<FunctionStats>	GetFlatProfile	()		const;		// most self samples first
+	int			GetSampleCount	()		const	{ return m_SampleCount; }
+
+	// One "outer;inner;innermost count" line per distinct stack, the input format of flamegraph.pl and speedscope
+	bool		SaveCollapsedStacks	(const std::string& filename)	const;
+	void		PrintFlatProfile	(int maxFunctions)				const;
+
+	static void	CreateBindings	(sol::state& state, LuaProfiler* profilerPtr);
+
+private:
+	// Private Member Functions
+	static void	SampleHook		(lua_State* luaStatePtr, lua_Debug* debugPtr);
+	void		TakeSample		(lua_State* luaStatePtr);
+	void		SamplerLoop		(int intervalUs);
+	lua_State*	SwitchThread	(lua_State* threadPtr);		// returns the thread that ran before
+
+	static const int MAX_STACK_DEPTH{ 64 };
+
+	// Member Variables
+	lua_State*									m_LuaStatePtr		{};
+	std::thread									m_SamplerThread		{};
+	std::atomic<bool>							m_StopSampler		{};
+	mutable std::atomic<int>					m_ScriptDepth		{};
+
+	// The thread the hook is armed on, the mutex keeps the sampler from arming a task that already ended
+	std::mutex									m_ThreadMutex		{};
+	lua_State*									m_RunningThreadPtr	{};
+
+	std::unordered_map<std::string, uint32_t>	m_Stacks			{};		// collapsed stack, root first -> samples
+	std::string									m_StackScratch		{};
+	std::vector<std::string>					m_FrameScratch		{};
+	int											m_SampleCount		{};
+
+	static std::atomic<LuaProfiler*>			s_ActiveProfilerPtr;		// the hook has no user data
+};
@@ -0,0 +1,381 @@
+//-----------------------------------------------------------------
+// Pixel Kernels
+// C++ Source - PixelKernels.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "PixelKernels.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+
+#if defined(CPU_FEATURES_X86)
+	#include <immintrin.h>
+#endif
+
+//-----------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------
+namespace
+{
+	PixelKernels::Level g_Level{ PixelKernels::GetSupportedLevel() };
+
+	// floor(value / 255) without a division, exact for every value <= 255 * 255
+	inline uint32_t Div255(uint32_t value)
+	{
+		return (value + 1 + (value >> 8)) >> 8;
+	}
+
+#if defined(CPU_FEATURES_X86)
+	//-------------------------------------------------------------
+	// SSE2, 4 pixels per step, 16 bit lanes hold one channel each
+	//-------------------------------------------------------------
+	inline __m128i Div255SSE2(__m128i value)
+	{
+		const __m128i one = _mm_set1_epi16(1);
+		return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(value, one), _mm_srli_epi16(value, 8)), 8);
+	}
+
+	// dst * (255 - srcAlpha) / 255 for 4 pixels, per pixel alpha taken from src
+	inline __m128i ScaleByInverseAlphaSSE2(__m128i dst, __m128i src)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i full = _mm_set1_epi16(255);
+
+		__m128i srcLo = _mm_unpacklo_epi8(src, zero);
+		__m128i srcHi = _mm_unpackhi_epi8(src, zero);
+		srcLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		srcHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(srcHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		const __m128i lo = Div255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_sub_epi16(full, srcLo)));
+		const __m128i hi = Div255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_sub_epi16(full, srcHi)));
+		return _mm_packus_epi16(lo, hi);
+	}
+
+	// pixels * factor / 255 for 4 pixels, factor holds one 16 bit value per channel
+	inline __m128i ScaleSSE2(__m128i pixels, __m128i factor)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i lo = Div255SSE2(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), factor));
+		const __m128i hi = Div255SSE2(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), factor));
+		return _mm_packus_epi16(lo, hi);
+	}
+
+	size_t PremultiplyByOpacitySSE2(uint32_t* pixelsArr, size_t count, uint8_t opacity)
+	{
+		const __m128i zero		= _mm_setzero_si128();
+		const __m128i factor	= _mm_set1_epi16(opacity);
+		const __m128i rgbMask	= _mm_set1_epi32(0x00FFFFFF);
+		const __m128i alpha		= _mm_set1_epi32((int)((uint32_t)opacity << 24));
+
+		size_t index{};
+		for (; index + 4 <= count; index += 4)
+		{
+			__m128i* ptr = reinterpret_cast<__m128i*>(pixelsArr + index);
+			const __m128i pixels = _mm_loadu_si128(ptr);
+			const __m128i isZero = _mm_cmpeq_epi32(pixels, zero);
+			const __m128i result = _mm_or_si128(_mm_and_si128(ScaleSSE2(pixels, factor), rgbMask), alpha);
+			_mm_storeu_si128(ptr, _mm_andnot_si128(isZero, result));
+		}
+		return index;
+	}
+
+	size_t SetAlphaSSE2(uint32_t* pixelsArr, size_t count, uint8_t alpha)
+	{
+		const __m128i rgbMask	= _mm_set1_epi32(0x00FFFFFF);
+		const __m128i alphaBits	= _mm_set1_epi32((int)((uint32_t)alpha << 24));
+
+		size_t index{};
+		for (; index + 4 <= count; index += 4)
+		{
+			__m128i* ptr = reinterpret_cast<__m128i*>(pixelsArr + index);
+			_mm_storeu_si128(ptr, _mm_or_si128(_mm_and_si128(_mm_loadu_si128(ptr), rgbMask), alphaBits));
+		}
+		return index;
+	}
+
+	size_t ColorKeyToZeroSSE2(uint32_t* dstArr, const uint32_t* srcArr, size_t count, uint32_t keyPixel)
+	{
+		const __m128i rgbMask	= _mm_set1_epi32(0x00FFFFFF);
+		const __m128i key		= _mm_set1_epi32((int)(keyPixel & 0x00FFFFFF));
+
+		size_t index{};
+		for (; index + 4 <= count; index += 4)
+		{
+			const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcArr + index));
+			const __m128i isKey = _mm_cmpeq_epi32(_mm_and_si128(pixels, rgbMask), key);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dstArr + index), _mm_andnot_si128(isKey, pixels));
+		}
+		return index;
+	}
+
+	size_t BlendSourceOverSSE2(uint32_t* dstArr, const uint32_t* srcArr, size_t count)
+	{
+		size_t index{};
+		for (; index + 4 <= count; index += 4)
+		{
+			__m128i* dstPtr = reinterpret_cast<__m128i*>(dstArr + index);
+			const __m128i src = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcArr + index));
+			_mm_storeu_si128(dstPtr, _mm_adds_epu8(src, ScaleByInverseAlphaSSE2(_mm_loadu_si128(dstPtr), src)));
+		}
+		return index;
+	}
+
+	size_t BlendColorOverSSE2(uint32_t* dstArr, size_t count, uint32_t srcPixel)
+	{
+		const __m128i src		= _mm_set1_epi32((int)srcPixel);
+		const __m128i inverse	= _mm_set1_epi16((short)(255 - (srcPixel >> 24)));
+
+		size_t index{};
+		for (; index + 4 <= count; index += 4)
+		{
+			__m128i* dstPtr = reinterpret_cast<__m128i*>(dstArr + index);
+			_mm_storeu_si128(dstPtr, _mm_adds_epu8(src, ScaleSSE2(_mm_loadu_si128(dstPtr), inverse)));
+		}
+		return index;
+	}
+
+	//-------------------------------------------------------------
+	// AVX2, 8 pixels per step, unpack and pack stay within each 128 bit lane
+	// so the pixel order is the same as in the SSE2 versions
+	//-------------------------------------------------------------
+	TARGET_AVX2 inline __m256i Div255AVX2(__m256i value)
+	{
+		const __m256i one = _mm256_set1_epi16(1);
+		return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(value, one), _mm256_srli_epi16(value, 8)), 8);
+	}
+
+	TARGET_AVX2 inline __m256i ScaleAVX2(__m256i pixels, __m256i factor)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i lo = Div255AVX2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(pixels, zero), factor));
+		const __m256i hi = Div255AVX2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(pixels, zero), factor));
+		return _mm256_packus_epi16(lo, hi);
+	}
+
+	TARGET_AVX2 inline __m256i ScaleByInverseAlphaAVX2(__m256i dst, __m256i src)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		const __m256i full = _mm256_set1_epi16(255);
+
+		__m256i srcLo = _mm256_unpacklo_epi8(src, zero);
+		__m256i srcHi = _mm256_unpackhi_epi8(src, zero);
+		srcLo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(srcLo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+		srcHi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(srcHi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+		const __m256i lo = Div255AVX2(_mm256_mullo_epi16(_mm256_unpacklo_epi8(dst, zero), _mm256_sub_epi16(full, srcLo)));
+		const __m256i hi = Div255AVX2(_mm256_mullo_epi16(_mm256_unpackhi_epi8(dst, zero), _mm256_sub_epi16(full, srcHi)));
+		return _mm256_packus_epi16(lo, hi);
+	}
+
+	TARGET_AVX2 size_t PremultiplyByOpacityAVX2(uint32_t* pixelsArr, size_t count, uint8_t opacity)
+	{
+		const __m256i zero		= _mm256_setzero_si256();
+		const __m256i factor	= _mm256_set1_epi16(opacity);
+		const __m256i rgbMask	= _mm256_set1_epi32(0x00FFFFFF);
+		const __m256i alpha		= _mm256_set1_epi32((int)((uint32_t)opacity << 24));
+
+		size_t index{};
+		for (; index + 8 <= count; index += 8)
+		{
+			__m256i* ptr = reinterpret_cast<__m256i*>(pixelsArr + index);
+			const __m256i pixels = _mm256_loadu_si256(ptr);
+			const __m256i isZero = _mm256_cmpeq_epi32(pixels, zero);
+			const __m256i result = _mm256_or_si256(_mm256_and_si256(ScaleAVX2(pixels, factor), rgbMask), alpha);
+			_mm256_storeu_si256(ptr, _mm256_andnot_si256(isZero, result));
+		}
+		return index;
+	}
+
+	TARGET_AVX2 size_t SetAlphaAVX2(uint32_t* pixelsArr, size_t count, uint8_t alpha)
+	{
+		const __m256i rgbMask	= _mm256_set1_epi32(0x00FFFFFF);
+		const __m256i alphaBits	= _mm256_set1_epi32((int)((uint32_t)alpha << 24));
+
+		size_t index{};
+		for (; index + 8 <= count; index += 8)
+		{
+			__m256i* ptr = reinterpret_cast<__m256i*>(pixelsArr + index);
+			_mm256_storeu_si256(ptr, _mm256_or_si256(_mm256_and_si256(_mm256_loadu_si256(ptr), rgbMask), alphaBits));
+		}
+		return index;
+	}
+
+	TARGET_AVX2 size_t ColorKeyToZeroAVX2(uint32_t* dstArr, const uint32_t* srcArr, size_t count, uint32_t keyPixel)
+	{
+		const __m256i rgbMask	= _mm256_set1_epi32(0x00FFFFFF);
+		const __m256i key		= _mm256_set1_epi32((int)(keyPixel & 0x00FFFFFF));
+
+		size_t index{};
+		for (; index + 8 <= count; index += 8)
+		{
+			const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcArr + index));
+			const __m256i isKey = _mm256_cmpeq_epi32(_mm256_and_si256(pixels, rgbMask), key);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dstArr + index), _mm256_andnot_si256(isKey, pixels));
+		}
+		return index;
+	}
+
+	TARGET_AVX2 size_t BlendSourceOverAVX2(uint32_t* dstArr, const uint32_t* srcArr, size_t count)
+	{
+		size_t index{};
+		for (; index + 8 <= count; index += 8)
+		{
+			__m256i* dstPtr = reinterpret_cast<__m256i*>(dstArr + index);
+			const __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcArr + index));
+			_mm256_storeu_si256(dstPtr, _mm256_adds_epu8(src, ScaleByInverseAlphaAVX2(_mm256_loadu_si256(dstPtr), src)));
+		}
+		return index;
+	}
+
+	TARGET_AVX2 size_t BlendColorOverAVX2(uint32_t* dstArr, size_t count, uint32_t srcPixel)
+	{
+		const __m256i src		= _mm256_set1_epi32((int)srcPixel);
+		const __m256i inverse	= _mm256_set1_epi16((short)(255 - (srcPixel >> 24)));
+
+		size_t index{};
+		for (; index + 8 <= count; index += 8)
+		{
+			__m256i* dstPtr = reinterpret_cast<__m256i*>(dstArr + index);
+			_mm256_storeu_si256(dstPtr, _mm256_adds_epu8(src, ScaleAVX2(_mm256_loadu_si256(dstPtr), inverse)));
+		}
+		return index;
+	}
+#endif
+}
+
+//-----------------------------------------------------------------
+// PixelKernels Member Functions
+//-----------------------------------------------------------------
+// The vectorized loops return how many pixels they handled, the reference version finishes the tail
+
+void PixelKernels::PremultiplyByOpacity(uint32_t* pixelsArr, size_t count, uint8_t opacity)
+{
+	size_t done{};
+#if defined(CPU_FEATURES_X86)
+	if (g_Level == Level::AVX2) done = PremultiplyByOpacityAVX2(pixelsArr, count, opacity);
+	else if (g_Level == Level::SSE2) done = PremultiplyByOpacitySSE2(pixelsArr, count, opacity);
+#endif
+	Reference::PremultiplyByOpacity(pixelsArr + done, count - done, opacity);
+}
+
+void PixelKernels::SetAlpha(uint32_t* pixelsArr, size_t count, uint8_t alpha)
+{
+	size_t done{};
+#if defined(CPU_FEATURES_X86)
+	if (g_Level == Level::AVX2) done = SetAlphaAVX2(pixelsArr, count, alpha);
+	else if (g_Level == Level::SSE2) done = SetAlphaSSE2(pixelsArr, count, alpha);
+#endif
+	Reference::SetAlpha(pixelsArr + done, count - done, alpha);
+}
+
+void PixelKernels::ColorKeyToZero(uint32_t* dstArr, const uint32_t* srcArr, size_t count, uint32_t keyPixel)
+{
+	size_t done{};
+#if defined(CPU_FEATURES_X86)
+	if (g_Level == Level::AVX2) done = ColorKeyToZeroAVX2(dstArr, srcArr, count, keyPixel);
+	else if (g_Level == Level::SSE2) done = ColorKeyToZeroSSE2(dstArr, srcArr, count, keyPixel);
+#endif
+	Reference::ColorKeyToZero(dstArr + done, srcArr + done, count - done, keyPixel);
+}
+
+void PixelKernels::BlendSourceOver(uint32_t* dstArr, const uint32_t* srcArr, size_t count)
+{
+	size_t done{};
+#if defined(CPU_FEATURES_X86)
+	if (g_Level == Level::AVX2) done = BlendSourceOverAVX2(dstArr, srcArr, count);
+	else if (g_Level == Level::SSE2) done = BlendSourceOverSSE2(dstArr, srcArr, count);
+#endif
+	Reference::BlendSourceOver(dstArr + done, srcArr + done, count - done);
+}
+
+void PixelKernels::BlendColorOver(uint32_t* dstArr, size_t count, uint32_t srcPixel)
+{
+	size_t done{};
+#if defined(CPU_FEATURES_X86)
+	if (g_Level == Level::AVX2) done = BlendColorOverAVX2(dstArr, count, srcPixel);
+	else if (g_Level == Level::SSE2) done = BlendColorOverSSE2(dstArr, count, srcPixel);
+#endif
+	Reference::BlendColorOver(dstArr + done, count - done, srcPixel);
+}
+
+void PixelKernels::SetLevel(Level level)
+{
+	g_Level = std::min(level, GetSupportedLevel());
+}
+
+PixelKernels::Level PixelKernels::GetLevel()
+{
+	return g_Level;
+}
+
+PixelKernels::Level PixelKernels::GetSupportedLevel()
+{
+	if (CpuFeatures::HasAVX2()) return Level::AVX2;
+	if (CpuFeatures::HasSSE2()) return Level::SSE2;
+	return Level::Scalar;
+}
+
+//-----------------------------------------------------------------
+// PixelKernels::Reference Member Functions
+//-----------------------------------------------------------------
+void PixelKernels::Reference::PremultiplyByOpacity(uint32_t* pixelsArr, size_t count, uint8_t opacity)
+{
+	for (size_t index{}; index < count; ++index)
+	{
+		const uint32_t pixel{ pixelsArr[index] };
+		if (pixel == 0) continue;
+
+		uint32_t result{ (uint32_t)opacity << 24 };
+		for (int shift{}; shift < 24; shift += 8)
+		{
+			result |= Div255(((pixel >> shift) & 0xFF) * opacity) << shift;
+		}
+		pixelsArr[index] = result;
+	}
+}
+
+void PixelKernels::Reference::SetAlpha(uint32_t* pixelsArr, size_t count, uint8_t alpha)
+{
+	for (size_t index{}; index < count; ++index)
+	{
+		pixelsArr[index] = (pixelsArr[index] & 0x00FFFFFF) | ((uint32_t)alpha << 24);
+	}
+}
+
+void PixelKernels::Reference::ColorKeyToZero(uint32_t* dstArr, const uint32_t* srcArr, size_t count, uint32_t keyPixel)
+{
+	const uint32_t key{ keyPixel & 0x00FFFFFF };
+	for (size_t index{}; index < count; ++index)
+	{
+		dstArr[index] = (srcArr[index] & 0x00FFFFFF) == key ? 0 : srcArr[index];
+	}
+}
+
+void PixelKernels::Reference::BlendSourceOver(uint32_t* dstArr, const uint32_t* srcArr, size_t count)
+{
+	for (size_t index{}; index < count; ++index)
+	{
+		const uint32_t src{ srcArr[index] };
+		const uint32_t dst{ dstArr[index] };
+		const uint32_t inverse{ 255 - (src >> 24) };
+
+		uint32_t result{};
+		for (int shift{}; shift < 32; shift += 8)
+		{
+			const uint32_t channel{ ((src >> shift) & 0xFF) + Div255(((dst >> shift) & 0xFF) * inverse) };
+			result |= std::min<uint32_t>(channel, 255) << shift;
+		}
+		dstArr[index] = result;
+	}
+}
+
+void PixelKernels::Reference::BlendColorOver(uint32_t* dstArr, size_t count, uint32_t srcPixel)
+{
+	for (size_t index{}; index < count; ++index)
+	{
+		Reference::BlendSourceOver(dstArr + index, &srcPixel, 1);
+	}
+}
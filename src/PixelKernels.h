@@ -0,0 +1,50 @@
+//-----------------------------------------------------------------
+// Pixel Kernels
+// C++ Header - PixelKernels.h - version v8_01
+//
+// Loops over 32 bit DIB pixels (0xAARRGGBB, B G R A in memory) with
+// SSE2 and AVX2 versions picked at runtime. Every kernel gives the
+// same result, bit for bit, as its scalar Reference version.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+
+//-----------------------------------------------------------------
+// PixelKernels Class
+//-----------------------------------------------------------------
+class PixelKernels final
+{
+public:
+	enum class Level
+	{
+		Scalar, SSE2, AVX2
+	};
+
+	// Kernels, dispatched to the best supported level
+	static void		PremultiplyByOpacity	(uint32_t* pixelsArr, size_t count, uint8_t opacity);								// non zero pixels: rgb * opacity / 255, alpha = opacity
+	static void		SetAlpha				(uint32_t* pixelsArr, size_t count, uint8_t alpha);
+	static void		ColorKeyToZero			(uint32_t* dstArr, const uint32_t* srcArr, size_t count, uint32_t keyPixel);		// pixels with rgb == keyPixel rgb become 0
+	static void		BlendSourceOver			(uint32_t* dstArr, const uint32_t* srcArr, size_t count);							// premultiplied: dst = src + dst * (255 - srcAlpha) / 255
+	static void		BlendColorOver			(uint32_t* dstArr, size_t count, uint32_t srcPixel);								// BlendSourceOver with one premultiplied pixel
+
+	// Forces a lower level, e.g. to compare the timings, levels the CPU does not support are clamped
+	static void		SetLevel				(Level level);
+	static Level	GetLevel				();
+	static Level	GetSupportedLevel		();
+
+	// Scalar versions, the reference for the vectorized ones
+	class Reference final
+	{
+	public:
+		static void	PremultiplyByOpacity	(uint32_t* pixelsArr, size_t count, uint8_t opacity);
+		static void	SetAlpha				(uint32_t* pixelsArr, size_t count, uint8_t alpha);
+		static void	ColorKeyToZero			(uint32_t* dstArr, const uint32_t* srcArr, size_t count, uint32_t keyPixel);
+		static void	BlendSourceOver			(uint32_t* dstArr, const uint32_t* srcArr, size_t count);
+		static void	BlendColorOver			(uint32_t* dstArr, size_t count, uint32_t srcPixel);
+	};
+};
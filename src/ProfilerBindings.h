@@ -0,0 +1,44 @@
+#pragma once
+#include <sol/sol.hpp>
+#include "GameEngine.h"
+
+class ProfilerBindings{
+public:
+    // { frames = ..., frame = { p50 = ..., p99 = ..., max = ..., mean = ... }, update = { ... }, ... } times in ms
+    static sol::table GetStats(sol::this_state luaState){
+        sol::state_view lua{ luaState };
+        const FrameProfiler& profiler{ GAME_ENGINE->GetProfiler() };
+
+        sol::table stats = lua.create_table_with("frames", profiler.GetFrameCount());
+        for (int phase{}; phase < FrameProfiler::PHASE_COUNT; ++phase) {
+            const FrameProfiler::PhaseStats phaseStats{ profiler.GetPhaseStats((FrameProfiler::Phase)phase) };
+            stats[FrameProfiler::GetPhaseName((FrameProfiler::Phase)phase)] = lua.create_table_with(
+                "p50", phaseStats.p50Ms, "p99", phaseStats.p99Ms, "max", phaseStats.maxMs, "mean", phaseStats.meanMs);
+        }
+        return stats;
+    }
+    // { total = ..., line = ..., fillRect = ..., ... } for the last frame
+    static sol::table GetDrawCalls(sol::this_state luaState){
+        const FrameProfiler& profiler{ GAME_ENGINE->GetProfiler() };
+
+        sol::table drawCalls = sol::state_view{ luaState }.create_table_with("total", profiler.GetTotalDrawCalls());
+        for (int drawCall{}; drawCall < FrameProfiler::DRAW_CALL_COUNT; ++drawCall) {
+            drawCalls[FrameProfiler::GetDrawCallName((FrameProfiler::DrawCall)drawCall)] = profiler.GetDrawCalls((FrameProfiler::DrawCall)drawCall);
+        }
+        return drawCalls;
+    }
+    static void SetOverlay(bool show){GAME_ENGINE->SetProfilerOverlay(show);}
+    static bool IsOverlayShown(){return GAME_ENGINE->IsProfilerOverlayShown();}
+    static void Reset(){GAME_ENGINE->ResetProfiler();}
+    static void CreateBindings(sol::state& state){
+        state.new_usertype<ProfilerBindings>(
+            "Profiler",
+            "GetStats", &ProfilerBindings::GetStats,
+            "GetDrawCalls", &ProfilerBindings::GetDrawCalls,
+            "SetOverlay", &ProfilerBindings::SetOverlay,
+            "IsOverlayShown", &ProfilerBindings::IsOverlayShown,
+            "Reset", &ProfilerBindings::Reset,
+            "CreateBindings", &ProfilerBindings::CreateBindings
+        );
+    }
+};
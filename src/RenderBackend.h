@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------
+// Render Backend Interface
+// C++ Header - RenderBackend.h - version v8_01
+//
+// RenderBackend is the abstract class which declares the drawing
+// operations the game engine can route its Draw/Fill calls to instead
+// of GDI. It only uses portable types so it can be implemented without
+// any Win32 headers.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstdint>
+
+//-----------------------------------------------------------------
+// Render Types
+//-----------------------------------------------------------------
+struct RenderPoint
+{
+	int32_t x{};
+	int32_t y{};
+};
+
+// 32 bit pixels, laid out as a DIB section: 0xAARRGGBB in memory order B, G, R, A
+struct RenderImage
+{
+	const uint32_t*	pixelsPtr	{};
+	int				width		{};
+	int				height		{};
+};
+
+//-----------------------------------------------------------------
+// RenderBackend Class
+//-----------------------------------------------------------------
+class RenderBackend
+{
+public:
+	// Constructor(s) and destructor
+	RenderBackend()				= default;
+	virtual ~RenderBackend()	= default;
+
+	// Disabling copy/move constructors and assignment operators
+	RenderBackend(const RenderBackend& other)					= delete;
+	RenderBackend(RenderBackend&& other) noexcept				= delete;
+	RenderBackend& operator=(const RenderBackend& other)		= delete;
+	RenderBackend& operator=(RenderBackend&& other) noexcept	= delete;
+
+	// Colors are passed in COLORREF layout (0x00BBGGRR) so the engine can hand over m_ColDraw as is
+	virtual void		SetColor		(uint32_t colorRef)																		= 0;
+
+	// Rectangles follow the GDI conventions: right and bottom are exclusive
+	virtual void		DrawLine		(int x1, int y1, int x2, int y2)														= 0;
+	virtual void		DrawRect		(int left, int top, int right, int bottom)												= 0;
+	virtual void		FillRect		(int left, int top, int right, int bottom, int opacity)									= 0;	// opacity 0 - 255
+	virtual void		DrawRoundRect	(int left, int top, int right, int bottom, int radius)									= 0;
+	virtual void		FillRoundRect	(int left, int top, int right, int bottom, int radius)									= 0;
+	virtual void		DrawOval		(int left, int top, int right, int bottom)												= 0;
+	virtual void		FillOval		(int left, int top, int right, int bottom, int opacity)									= 0;	// opacity 0 - 255
+	virtual void		DrawArc			(int left, int top, int right, int bottom, int startDegree, int angle)					= 0;
+	virtual void		FillArc			(int left, int top, int right, int bottom, int startDegree, int angle)					= 0;
+	virtual void		DrawPolygon		(const RenderPoint ptsArr[], int count, bool close)										= 0;
+	virtual void		FillPolygon		(const RenderPoint ptsArr[], int count)													= 0;
+
+	// Source pixels are premultiplied, opacity 0 - 255 scales the whole image
+	virtual void		BlendImage		(const RenderImage& image, int left, int top, int srcLeft, int srcTop, int srcRight, int srcBottom, int opacity)		= 0;
+	// Source pixels matching the color key (COLORREF layout) are skipped
+	virtual void		KeyedImage		(const RenderImage& image, int left, int top, int srcLeft, int srcTop, int srcRight, int srcBottom, uint32_t colorKey)	= 0;
+
+	// The framebuffer the backend draws into, same layout as RenderImage
+	virtual const uint32_t*	GetFramebuffer	()		const	= 0;
+	virtual int				GetWidth		()		const	= 0;
+	virtual int				GetHeight		()		const	= 0;
+};
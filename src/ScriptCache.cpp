@@ -0,0 +1,184 @@
+//-----------------------------------------------------------------
+// Script Cache
+// C++ Source - ScriptCache.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "ScriptCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+extern "C"
+{
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+//-----------------------------------------------------------------
+// Cache File Layout
+//-----------------------------------------------------------------
+namespace
+{
+	// Followed by bytecodeSize bytes of lua_dump output
+	struct CacheHeader
+	{
+		uint32_t	magic			{};
+		uint32_t	luaVersion		{};		// LUA_VERSION_NUM, the bytecode format changes between versions
+		uint64_t	sourceHash		{};
+		uint64_t	bytecodeSize	{};
+	};
+
+	bool ReadFile(const std::filesystem::path& path, std::string& contents)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		if (!file) return false;
+
+		contents.assign(std::istreambuf_iterator<char>{ file }, std::istreambuf_iterator<char>{});
+		return !file.bad();
+	}
+
+	int AppendChunk(lua_State*, const void* dataPtr, size_t size, void* bytecodePtr)
+	{
+		static_cast<std::string*>(bytecodePtr)->append(static_cast<const char*>(dataPtr), size);
+		return 0;
+	}
+}
+
+//-----------------------------------------------------------------
+// ScriptCache Member Functions
+//-----------------------------------------------------------------
+int ScriptCache::LoadFile(lua_State* luaStatePtr, const std::filesystem::path& sourcePath)
+{
+	const std::string chunkName{ GetChunkName(sourcePath) };
+
+	std::string source{};
+	if (!ReadFile(sourcePath, source))
+	{
+		lua_pushfstring(luaStatePtr, "cannot open %s", sourcePath.string().c_str());
+		return LUA_ERRFILE;
+	}
+	const uint64_t sourceHash{ HashSource(source) };
+
+	// the cache only counts when it was compiled from exactly this source by this Lua version
+	const std::filesystem::path cachePath{ GetCachePath(sourcePath) };
+	std::string cache{};
+	if (ReadFile(cachePath, cache) && cache.size() >= sizeof(CacheHeader))
+	{
+		CacheHeader header{};
+		memcpy(&header, cache.data(), sizeof(CacheHeader));
+
+		if (header.magic == CACHE_MAGIC && header.luaVersion == LUA_VERSION_NUM && header.sourceHash == sourceHash
+			&& header.bytecodeSize == cache.size() - sizeof(CacheHeader))
+		{
+			// "b" refuses anything but bytecode, the bytecode header itself is checked by Lua as well
+			if (luaL_loadbufferx(luaStatePtr, cache.data() + sizeof(CacheHeader), (size_t)header.bytecodeSize, chunkName.c_str(), "b") == LUA_OK) return LUA_OK;
+			lua_pop(luaStatePtr, 1);
+		}
+	}
+
+	const int status{ LoadSource(luaStatePtr, source, chunkName) };
+	if (status != LUA_OK) return status;
+
+	// best effort, the scripts may live in a folder the game can not write to
+	WriteCache(luaStatePtr, cachePath, sourceHash);
+	return LUA_OK;
+}
+
+bool ScriptCache::Compile(lua_State* luaStatePtr, const std::filesystem::path& sourcePath, const std::filesystem::path& chunkPath, std::string& errorMessage)
+{
+	std::string source{};
+	if (!ReadFile(sourcePath, source))
+	{
+		errorMessage = "cannot open " + sourcePath.string();
+		return false;
+	}
+
+	if (LoadSource(luaStatePtr, source, GetChunkName(chunkPath)) != LUA_OK)
+	{
+		errorMessage = lua_tostring(luaStatePtr, -1);
+		lua_pop(luaStatePtr, 1);
+		return false;
+	}
+
+	const bool isWritten{ WriteCache(luaStatePtr, GetCachePath(sourcePath), HashSource(source)) };
+	lua_pop(luaStatePtr, 1);
+
+	if (!isWritten) errorMessage = "cannot write " + GetCachePath(sourcePath).string();
+	return isWritten;
+}
+
+std::filesystem::path ScriptCache::GetCachePath(const std::filesystem::path& sourcePath)
+{
+	std::filesystem::path cachePath{ sourcePath };
+	return cachePath.replace_extension(".luac");
+}
+
+void ScriptCache::CreateBindings(lua_State* luaStatePtr)
+{
+	lua_register(luaStatePtr, "dofile", &ScriptCache::DoFile);
+}
+
+int ScriptCache::LoadSource(lua_State* luaStatePtr, const std::string& source, const std::string& chunkName)
+{
+	return luaL_loadbufferx(luaStatePtr, source.data(), source.size(), chunkName.c_str(), "t");
+}
+
+bool ScriptCache::WriteCache(lua_State* luaStatePtr, const std::filesystem::path& cachePath, uint64_t sourceHash)
+{
+	// debug information is kept, error messages and the Lua profiler need the line numbers and names
+	std::string bytecode{};
+	if (lua_dump(luaStatePtr, &AppendChunk, &bytecode, 0) != 0) return false;
+
+	const CacheHeader header{ CACHE_MAGIC, LUA_VERSION_NUM, sourceHash, bytecode.size() };
+
+	// written next to the cache and renamed over it, so a reader never sees half a file
+	std::filesystem::path tempPath{ cachePath };
+	tempPath += ".tmp";
+	{
+		std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+		if (!file) return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(bytecode.data(), (std::streamsize)bytecode.size());
+		if (!file) return false;
+	}
+
+	std::error_code renameError{};
+	std::filesystem::rename(tempPath, cachePath, renameError);
+	if (renameError)
+	{
+		// a failed cleanup changes nothing about the result, the cache was not written either way
+		std::error_code removeError{};
+		std::filesystem::remove(tempPath, removeError);
+	}
+
+	return !renameError;
+}
+
+uint64_t ScriptCache::HashSource(const std::string& source)
+{
+	// FNV-1a, plenty to tell two versions of a script apart
+	uint64_t hash{ 14695981039346656037ull };
+	for (unsigned char character : source)
+	{
+		hash ^= character;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+int ScriptCache::DoFile(lua_State* luaStatePtr)
+{
+	const char* filenamePtr = luaL_checkstring(luaStatePtr, 1);
+	lua_settop(luaStatePtr, 1);
+
+	if (LoadFile(luaStatePtr, filenamePtr) != LUA_OK) return lua_error(luaStatePtr);
+
+	lua_call(luaStatePtr, 0, LUA_MULTRET);
+	return lua_gettop(luaStatePtr) - 1;
+}
@@ -0,0 +1,52 @@
+//-----------------------------------------------------------------
+// Script Cache
+// C++ Header - ScriptCache.h - version v8_01
+//
+// Loads Lua scripts from precompiled bytecode when it is up to date.
+// Next to every script.lua can be a script.luac holding the bytecode
+// of the script plus the hash of the source it was compiled from, so a
+// stale or foreign cache is never run. The ScriptCompiler tool writes
+// the caches at build time, a missing or stale cache is rewritten the
+// first time the script is loaded from source.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+struct lua_State;
+
+//-----------------------------------------------------------------
+// ScriptCache Class
+//-----------------------------------------------------------------
+class ScriptCache final
+{
+public:
+	ScriptCache() = delete;
+
+	// Same contract as luaL_loadfile: pushes the compiled chunk and returns LUA_OK, or pushes the error message
+	static int		LoadFile		(lua_State* luaStatePtr, const std::filesystem::path& sourcePath);
+
+	// Compiles the script and writes its cache, false with the reason in errorMessage when it has errors.
+	// chunkPath is the path the game loads the script by, the bytecode names its chunk after it,
+	// so error messages and the profiler show the same name whether a script came from the cache or not
+	static bool		Compile			(lua_State* luaStatePtr, const std::filesystem::path& sourcePath, const std::filesystem::path& chunkPath, std::string& errorMessage);
+
+	static std::filesystem::path	GetCachePath	(const std::filesystem::path& sourcePath);
+
+	// Replaces dofile, so the scripts the game script runs load from the cache too
+	static void		CreateBindings	(lua_State* luaStatePtr);
+
+private:
+	static std::string	GetChunkName	(const std::filesystem::path& chunkPath)	{ return "@" + chunkPath.generic_string(); }
+	static int		LoadSource		(lua_State* luaStatePtr, const std::string& source, const std::string& chunkName);
+	static bool		WriteCache		(lua_State* luaStatePtr, const std::filesystem::path& cachePath, uint64_t sourceHash);	// the chunk on top of the stack
+	static uint64_t	HashSource		(const std::string& source);
+	static int		DoFile			(lua_State* luaStatePtr);
+
+	static const uint32_t CACHE_MAGIC{ 0x4342'4C45 };	// "ELBC" in a little endian file
+};
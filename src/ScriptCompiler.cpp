@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------
+// Script Compiler
+// C++ Source - ScriptCompiler.cpp - version v8_01
+//
+// Build step: writes the bytecode cache of every .lua file in the
+// folders and files on the command line, see ScriptCache. The chunks
+// are named relative to the folder's parent, a script in <output>/lua
+// is named lua/script.lua like the game loads it, never by the path of
+// the build output.
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "ScriptCache.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+extern "C"
+{
+#include <lua.h>
+#include <lauxlib.h>
+}
+
+//-----------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------
+// "lua" for lua, lua/ and out/lua alike
+static std::filesystem::path FolderName(const std::filesystem::path& folderPath)
+{
+	std::filesystem::path normalPath{ std::filesystem::absolute(folderPath).lexically_normal() };
+	if (!normalPath.has_filename()) normalPath = normalPath.parent_path();
+	return normalPath.filename();
+}
+
+//-----------------------------------------------------------------
+// Compiler Entry Point
+//-----------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("usage: ScriptCompiler <folder or script.lua>...\n");
+		return 1;
+	}
+
+	lua_State* luaStatePtr = luaL_newstate();
+	int compiledCount{}, failedCount{};
+
+	auto compile = [&](const std::filesystem::path& sourcePath, const std::filesystem::path& chunkPath)
+	{
+		std::string errorMessage{};
+		if (ScriptCache::Compile(luaStatePtr, sourcePath, chunkPath, errorMessage)) ++compiledCount;
+		else
+		{
+			fprintf(stderr, "%s\n", errorMessage.c_str());
+			++failedCount;
+		}
+	};
+
+	for (int index{ 1 }; index < argc; ++index)
+	{
+		const std::filesystem::path path{ argv[index] };
+		if (!std::filesystem::is_directory(path))
+		{
+			compile(path, FolderName(path.parent_path()) / path.filename());
+			continue;
+		}
+
+		const std::filesystem::path folderName{ FolderName(path) };
+		for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator{ path })
+		{
+			if (entry.is_regular_file() && entry.path().extension() == ".lua") compile(entry.path(), folderName / entry.path().lexically_relative(path));
+		}
+	}
+
+	lua_close(luaStatePtr);
+
+	printf("ScriptCompiler: %d scripts compiled, %d failed\n", compiledCount, failedCount);
+	return failedCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------
+// Script Watcher
+// C++ Source - ScriptWatcher.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "ScriptWatcher.h"
+
+#include <system_error>
+
+//-----------------------------------------------------------------
+// ScriptWatcher Constructor(s) and Destructor
+//-----------------------------------------------------------------
+ScriptWatcher::~ScriptWatcher()
+{
+	Stop();
+}
+
+//-----------------------------------------------------------------
+// ScriptWatcher Member Functions
+//-----------------------------------------------------------------
+bool ScriptWatcher::Watch(const std::filesystem::path& scriptPath)
+{
+	Stop();
+
+	std::error_code error{};
+	m_ScriptPath = std::filesystem::absolute(scriptPath, error);
+	if (error) return false;
+
+	// editors either write the file in place or write a new one and rename it over the old one
+	m_hChange = FindFirstChangeNotificationW(m_ScriptPath.parent_path().c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+	m_ScriptTime = GetScriptTime();
+
+	return IsWatching();
+}
+
+void ScriptWatcher::Stop()
+{
+	if (!IsWatching()) return;
+
+	FindCloseChangeNotification(m_hChange);
+	m_hChange = INVALID_HANDLE_VALUE;
+}
+
+bool ScriptWatcher::HasChanged()
+{
+	if (!IsWatching() || WaitForSingleObject(m_hChange, 0) != WAIT_OBJECT_0) return false;
+
+	// rearm first, so a save that lands while the script is checked still signals the next call
+	FindNextChangeNotification(m_hChange);
+
+	// any file in the folder signals, only the script counts
+	const std::filesystem::file_time_type scriptTime{ GetScriptTime() };
+	if (scriptTime <= m_ScriptTime) return false;
+
+	m_ScriptTime = scriptTime;
+	return true;
+}
+
+std::filesystem::file_time_type ScriptWatcher::GetScriptTime() const
+{
+	// while an editor renames the new version into place the script may be missing for a moment, that is no change
+	std::error_code error{};
+	const std::filesystem::file_time_type writeTime{ std::filesystem::last_write_time(m_ScriptPath, error) };
+	return error ? std::filesystem::file_time_type{} : writeTime;
+}
@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------
+// Script Watcher
+// C++ Header - ScriptWatcher.h - version v8_01
+//
+// Notices when the game script is saved. Windows signals a change
+// notification handle for its folder, so checking costs one wait with
+// a zero timeout while nothing changed. Only a newer version of the
+// script itself counts as a change, other scripts and the bytecode
+// caches the game writes into the same folder do not: a reload only
+// runs the game script again.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <filesystem>
+
+//-----------------------------------------------------------------
+// ScriptWatcher Class
+//-----------------------------------------------------------------
+class ScriptWatcher final
+{
+public:
+	// Constructor(s) and destructor
+	ScriptWatcher()		= default;
+	~ScriptWatcher();
+
+	// Disabling copy/move constructors and assignment operators, the watcher owns the notification handle
+	ScriptWatcher(const ScriptWatcher& other)					= delete;
+	ScriptWatcher(ScriptWatcher&& other) noexcept				= delete;
+	ScriptWatcher& operator=(const ScriptWatcher& other)		= delete;
+	ScriptWatcher& operator=(ScriptWatcher&& other) noexcept	= delete;
+
+	// General Member Functions
+	bool		Watch			(const std::filesystem::path& scriptPath);		// false when the folder can not be watched
+	void		Stop			();
+	bool		IsWatching		()		const	{ return m_hChange != INVALID_HANDLE_VALUE; }
+
+	const std::filesystem::path&	GetScriptPath	()	const	{ return m_ScriptPath; }	// absolute
+
+	// True once per save of the script since the previous call
+	bool		HasChanged		();
+
+private:
+	// Private Member Functions
+	std::filesystem::file_time_type	GetScriptTime	()	const;
+
+	// Member Variables
+	HANDLE							m_hChange			{ INVALID_HANDLE_VALUE };
+	std::filesystem::path			m_ScriptPath		{};
+	std::filesystem::file_time_type	m_ScriptTime		{};
+};
@@ -0,0 +1,439 @@
+//-----------------------------------------------------------------
+// Software Renderer
+// C++ Source - SoftwareRenderer.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "SoftwareRenderer.h"
+#include "PixelKernels.h"
+
+#define _USE_MATH_DEFINES	// necessary for including (among other values) PI  - see math.h
+#include <math.h>
+
+#include <algorithm>
+#include <fstream>
+
+//-----------------------------------------------------------------
+// Pixel helpers
+//-----------------------------------------------------------------
+namespace
+{
+	// blends a premultiplied pixel over another one, result = src + dst * (255 - srcAlpha) / 255
+	uint32_t BlendPremultiplied(uint32_t dst, uint32_t src)
+	{
+		const uint32_t inverse = 255 - (src >> 24);
+		uint32_t result{};
+		for (int shift{}; shift < 32; shift += 8)
+		{
+			const uint32_t s = (src >> shift) & 0xFF;
+			const uint32_t d = (dst >> shift) & 0xFF;
+			result |= std::min<uint32_t>(s + d * inverse / 255, 255) << shift;
+		}
+		return result;
+	}
+
+	// scales all four channels of a premultiplied pixel by opacity / 255
+	uint32_t ScalePixel(uint32_t src, int opacity)
+	{
+		uint32_t result{};
+		for (int shift{}; shift < 32; shift += 8)
+		{
+			result |= (((src >> shift) & 0xFF) * opacity / 255) << shift;
+		}
+		return result;
+	}
+
+	void WriteLE(std::ofstream& stream, uint32_t value, int byteCount)
+	{
+		for (int count{}; count < byteCount; ++count)
+		{
+			stream.put(static_cast<char>((value >> (8 * count)) & 0xFF));
+		}
+	}
+}
+
+//-----------------------------------------------------------------
+// SoftwareRenderer Constructor(s)
+//-----------------------------------------------------------------
+SoftwareRenderer::SoftwareRenderer(int width, int height)
+{
+	Resize(width, height);
+}
+
+//-----------------------------------------------------------------
+// SoftwareRenderer Member Functions
+//-----------------------------------------------------------------
+void SoftwareRenderer::Resize(int width, int height)
+{
+	m_Width  = std::max(width, 0);
+	m_Height = std::max(height, 0);
+	m_Pixels.assign(static_cast<size_t>(m_Width) * m_Height, 0xFF000000);
+}
+
+uint32_t SoftwareRenderer::ColorRefToPixel(uint32_t colorRef)
+{
+	// COLORREF is 0x00BBGGRR, the framebuffer stores 0xAARRGGBB
+	return 0xFF000000 | ((colorRef & 0xFF) << 16) | (colorRef & 0xFF00) | ((colorRef >> 16) & 0xFF);
+}
+
+bool SoftwareRenderer::SaveToFile(const std::filesystem::path& filename) const
+{
+	std::ofstream file(filename, std::ios::binary);
+	if (!file.good()) return false;
+
+	const uint32_t imageSize{ static_cast<uint32_t>(m_Pixels.size() * sizeof(uint32_t)) };
+	const uint32_t offset{ 14 + 40 };
+
+	// BITMAPFILEHEADER
+	WriteLE(file, 'B' | ('M' << 8), 2);
+	WriteLE(file, offset + imageSize, 4);
+	WriteLE(file, 0, 4);
+	WriteLE(file, offset, 4);
+
+	// BITMAPINFOHEADER, negative height => top-down rows like the framebuffer
+	WriteLE(file, 40, 4);
+	WriteLE(file, static_cast<uint32_t>(m_Width), 4);
+	WriteLE(file, static_cast<uint32_t>(-m_Height), 4);
+	WriteLE(file, 1, 2);
+	WriteLE(file, 32, 2);
+	WriteLE(file, 0, 4);
+	WriteLE(file, imageSize, 4);
+	WriteLE(file, 0, 4);
+	WriteLE(file, 0, 4);
+	WriteLE(file, 0, 4);
+	WriteLE(file, 0, 4);
+
+	file.write(reinterpret_cast<const char*>(m_Pixels.data()), imageSize);
+
+	return file.good();
+}
+
+void SoftwareRenderer::SetColor(uint32_t colorRef)
+{
+	m_Color = ColorRefToPixel(colorRef);
+}
+
+void SoftwareRenderer::PlotPixel(int x, int y)
+{
+	if (x < 0 || y < 0 || x >= m_Width || y >= m_Height) return;
+
+	m_Pixels[static_cast<size_t>(y) * m_Width + x] = m_Color;
+}
+
+void SoftwareRenderer::FillSpan(int y, int x0, int x1, int opacity)
+{
+	if (y < 0 || y >= m_Height) return;
+
+	x0 = std::max(x0, 0);
+	x1 = std::min(x1, m_Width - 1);
+	if (x0 > x1 || opacity <= 0) return;
+
+	uint32_t* rowPtr = m_Pixels.data() + static_cast<size_t>(y) * m_Width;
+
+	if (opacity >= 255) std::fill(rowPtr + x0, rowPtr + x1 + 1, m_Color);
+	else
+	{
+		uint32_t color{ m_Color };
+		PixelKernels::PremultiplyByOpacity(&color, 1, static_cast<uint8_t>(opacity));
+		PixelKernels::BlendColorOver(rowPtr + x0, static_cast<size_t>(x1 - x0 + 1), color);
+	}
+}
+
+void SoftwareRenderer::FillSpans(int top, const std::vector<Span>& spans, int opacity)
+{
+	for (int row{}; row < (int)spans.size(); ++row)
+	{
+		FillSpan(top + row, spans[row].x0, spans[row].x1, opacity);
+	}
+}
+
+void SoftwareRenderer::OutlineSpans(int top, const std::vector<Span>& spans)
+{
+	// a pixel belongs to the outline when it is at the end of its span or not covered by the row above or below
+	const Span empty{};
+
+	for (int row{}; row < (int)spans.size(); ++row)
+	{
+		const Span& span = spans[row];
+		if (span.x0 > span.x1) continue;
+
+		const Span& above = row > 0 ? spans[row - 1] : empty;
+		const Span& below = row + 1 < (int)spans.size() ? spans[row + 1] : empty;
+
+		const int inner0{ std::max({ span.x0 + 1, above.x0, below.x0 }) };
+		const int inner1{ std::min({ span.x1 - 1, above.x1, below.x1 }) };
+
+		if (above.x0 > above.x1 || below.x0 > below.x1 || inner0 > inner1)
+		{
+			FillSpan(top + row, span.x0, span.x1, 255);
+		}
+		else
+		{
+			FillSpan(top + row, span.x0, inner0 - 1, 255);
+			FillSpan(top + row, inner1 + 1, span.x1, 255);
+		}
+	}
+}
+
+void SoftwareRenderer::PlotLine(int x1, int y1, int x2, int y2, bool includeLast)
+{
+	// Bresenham, GDI leaves out the last point of a line
+	const int dx{ abs(x2 - x1) }, sx{ x1 < x2 ? 1 : -1 };
+	const int dy{ -abs(y2 - y1) }, sy{ y1 < y2 ? 1 : -1 };
+	int error{ dx + dy };
+
+	while (x1 != x2 || y1 != y2)
+	{
+		PlotPixel(x1, y1);
+
+		const int doubleError{ 2 * error };
+		if (doubleError >= dy) { error += dy; x1 += sx; }
+		if (doubleError <= dx) { error += dx; y1 += sy; }
+	}
+
+	if (includeLast) PlotPixel(x2, y2);
+}
+
+int SoftwareRenderer::RoundRectSpans(int left, int top, int right, int bottom, int cornerWidth, int cornerHeight)
+{
+	// fills m_SpanBuffer with one span per row of [top, bottom), corners are quarters of a cornerWidth x cornerHeight ellipse
+	const int width { right - left };
+	const int height{ bottom - top };
+
+	// only the rows on the framebuffer plus one on either side, so an outline still sees its neighbours at the edges
+	const int firstY{ std::max(top, -1) };
+	const int endY	{ std::min(bottom, m_Height + 1) };
+
+	m_SpanBuffer.assign(std::max(endY - firstY, 0), Span{});
+	if (width <= 0 || height <= 0) return firstY;
+
+	const double radiusX{ std::min(cornerWidth,  width)  / 2.0 };
+	const double radiusY{ std::min(cornerHeight, height) / 2.0 };
+
+	for (int y{ firstY }; y < endY; ++y)
+	{
+		const int row{ y - top };
+		double inset{};
+
+		if (radiusX > 0 && radiusY > 0)
+		{
+			const double centerY{ row + 0.5 };
+			double distance{};
+			if		(centerY < radiusY)				distance = radiusY - centerY;
+			else if (centerY > height - radiusY)	distance = centerY - (height - radiusY);
+
+			const double ratio{ distance / radiusY };
+			inset = radiusX - radiusX * sqrt(std::max(1.0 - ratio * ratio, 0.0));
+		}
+
+		// pixel centers that lie within [inset, width - inset]
+		m_SpanBuffer[y - firstY].x0 = left + (int)ceil(inset - 0.5);
+		m_SpanBuffer[y - firstY].x1 = left + (int)floor(width - inset - 0.5);
+	}
+
+	return firstY;
+}
+
+void SoftwareRenderer::PlotArcSpans(int left, int top, int right, int bottom, int startDegree, int angle, bool filled)
+{
+	const int firstY{ RoundRectSpans(left, top, right, bottom, right - left, bottom - top) };
+
+	// normalise to a counterclockwise sweep of [startDegree, startDegree + angle] with startDegree in [0, 360)
+	if (angle < 0)
+	{
+		startDegree += angle;
+		angle = -angle;
+	}
+	startDegree %= 360;
+	if (startDegree < 0) startDegree += 360;
+
+	const double centerX{ (left + right) / 2.0 };
+	const double centerY{ (top + bottom) / 2.0 };
+	const Span empty{};
+
+	for (int row{}; row < (int)m_SpanBuffer.size(); ++row)
+	{
+		const Span& span = m_SpanBuffer[row];
+		const Span& above = row > 0 ? m_SpanBuffer[row - 1] : empty;
+		const Span& below = row + 1 < (int)m_SpanBuffer.size() ? m_SpanBuffer[row + 1] : empty;
+		const int y{ firstY + row };
+
+		// the ends of the span still count as outline when they are off the framebuffer
+		for (int x{ std::max(span.x0, -1) }; x <= std::min(span.x1, m_Width); ++x)
+		{
+			if (!filled && above.x0 <= x && x <= above.x1 && below.x0 <= x && x <= below.x1 && x != span.x0 && x != span.x1) continue;
+
+			// inverted y-axis: angles go counterclockwise on screen
+			double degrees{ atan2(centerY - (y + 0.5), (x + 0.5) - centerX) * 180.0 / M_PI - startDegree };
+			while (degrees < 0) degrees += 360.0;
+
+			if (angle >= 360 || degrees <= angle) PlotPixel(x, y);
+		}
+	}
+}
+
+void SoftwareRenderer::DrawLine(int x1, int y1, int x2, int y2)
+{
+	PlotLine(x1, y1, x2, y2, false);
+}
+
+void SoftwareRenderer::DrawRect(int left, int top, int right, int bottom)
+{
+	const int firstY{ RoundRectSpans(left, top, right, bottom, 0, 0) };
+	OutlineSpans(firstY, m_SpanBuffer);
+}
+
+void SoftwareRenderer::FillRect(int left, int top, int right, int bottom, int opacity)
+{
+	const int y0{ std::max(top, 0) };
+	const int y1{ std::min(bottom, m_Height) };
+
+	for (int y{ y0 }; y < y1; ++y) FillSpan(y, left, right - 1, opacity);
+}
+
+void SoftwareRenderer::DrawRoundRect(int left, int top, int right, int bottom, int radius)
+{
+	const int firstY{ RoundRectSpans(left, top, right, bottom, radius, radius) };
+	OutlineSpans(firstY, m_SpanBuffer);
+}
+
+void SoftwareRenderer::FillRoundRect(int left, int top, int right, int bottom, int radius)
+{
+	const int firstY{ RoundRectSpans(left, top, right, bottom, radius, radius) };
+	FillSpans(firstY, m_SpanBuffer, 255);
+}
+
+void SoftwareRenderer::DrawOval(int left, int top, int right, int bottom)
+{
+	const int firstY{ RoundRectSpans(left, top, right, bottom, right - left, bottom - top) };
+	OutlineSpans(firstY, m_SpanBuffer);
+}
+
+void SoftwareRenderer::FillOval(int left, int top, int right, int bottom, int opacity)
+{
+	const int firstY{ RoundRectSpans(left, top, right, bottom, right - left, bottom - top) };
+	FillSpans(firstY, m_SpanBuffer, opacity);
+}
+
+void SoftwareRenderer::DrawArc(int left, int top, int right, int bottom, int startDegree, int angle)
+{
+	PlotArcSpans(left, top, right, bottom, startDegree, angle, false);
+}
+
+void SoftwareRenderer::FillArc(int left, int top, int right, int bottom, int startDegree, int angle)
+{
+	PlotArcSpans(left, top, right, bottom, startDegree, angle, true);
+}
+
+void SoftwareRenderer::DrawPolygon(const RenderPoint ptsArr[], int count, bool close)
+{
+	for (int index{ 1 }; index < count; ++index)
+	{
+		PlotLine(ptsArr[index - 1].x, ptsArr[index - 1].y, ptsArr[index].x, ptsArr[index].y, false);
+	}
+
+	if (close && count > 1) PlotLine(ptsArr[count - 1].x, ptsArr[count - 1].y, ptsArr[0].x, ptsArr[0].y, false);
+}
+
+void SoftwareRenderer::FillPolygon(const RenderPoint ptsArr[], int count)
+{
+	if (count < 3) return;
+
+	int minY{ ptsArr[0].y }, maxY{ ptsArr[0].y };
+	for (int index{ 1 }; index < count; ++index)
+	{
+		minY = std::min<int>(minY, ptsArr[index].y);
+		maxY = std::max<int>(maxY, ptsArr[index].y);
+	}
+	minY = std::max(minY, 0);
+	maxY = std::min(maxY, m_Height - 1);
+
+	// even-odd scanline fill at pixel centers, the same rule as GDI's default ALTERNATE fill mode
+	for (int y{ minY }; y <= maxY; ++y)
+	{
+		const float centerY{ y + 0.5f };
+		m_CrossBuffer.clear();
+
+		for (int index{}; index < count; ++index)
+		{
+			const RenderPoint& p1 = ptsArr[index];
+			const RenderPoint& p2 = ptsArr[(index + 1) % count];
+
+			if ((p1.y <= centerY && centerY < p2.y) || (p2.y <= centerY && centerY < p1.y))
+			{
+				m_CrossBuffer.push_back(p1.x + (centerY - p1.y) * (p2.x - p1.x) / (p2.y - p1.y));
+			}
+		}
+
+		std::sort(m_CrossBuffer.begin(), m_CrossBuffer.end());
+
+		for (size_t index{ 1 }; index < m_CrossBuffer.size(); index += 2)
+		{
+			FillSpan(y, (int)ceil(m_CrossBuffer[index - 1] - 0.5f), (int)ceil(m_CrossBuffer[index] - 0.5f) - 1, 255);
+		}
+	}
+
+	// StrokeAndFillPath closes the figure and strokes it with the pen
+	DrawPolygon(ptsArr, count, true);
+}
+
+void SoftwareRenderer::BlendImage(const RenderImage& image, int left, int top, int srcLeft, int srcTop, int srcRight, int srcBottom, int opacity)
+{
+	if (opacity <= 0) return;
+
+	// clip the source rectangle to the image and the destination to the framebuffer
+	srcRight  = std::min(srcRight,  image.width);
+	srcBottom = std::min(srcBottom, image.height);
+	if (srcLeft < 0) { left -= srcLeft; srcLeft = 0; }
+	if (srcTop  < 0) { top  -= srcTop;  srcTop  = 0; }
+	if (left < 0) { srcLeft -= left; left = 0; }
+	if (top  < 0) { srcTop  -= top;  top  = 0; }
+
+	const int width { std::min(srcRight  - srcLeft, m_Width  - left) };
+	const int height{ std::min(srcBottom - srcTop,  m_Height - top)  };
+
+	for (int row{}; row < height; ++row)
+	{
+		const uint32_t* srcPtr = image.pixelsPtr + static_cast<size_t>(srcTop + row) * image.width + srcLeft;
+		uint32_t* dstPtr = m_Pixels.data() + static_cast<size_t>(top + row) * m_Width + left;
+
+		if (opacity >= 255)
+		{
+			PixelKernels::BlendSourceOver(dstPtr, srcPtr, static_cast<size_t>(std::max(width, 0)));
+			continue;
+		}
+
+		for (int column{}; column < width; ++column)
+		{
+			dstPtr[column] = BlendPremultiplied(dstPtr[column], ScalePixel(srcPtr[column], opacity));
+		}
+	}
+}
+
+void SoftwareRenderer::KeyedImage(const RenderImage& image, int left, int top, int srcLeft, int srcTop, int srcRight, int srcBottom, uint32_t colorKey)
+{
+	const uint32_t key{ ColorRefToPixel(colorKey) & 0x00FFFFFF };
+
+	srcRight  = std::min(srcRight,  image.width);
+	srcBottom = std::min(srcBottom, image.height);
+	if (srcLeft < 0) { left -= srcLeft; srcLeft = 0; }
+	if (srcTop  < 0) { top  -= srcTop;  srcTop  = 0; }
+	if (left < 0) { srcLeft -= left; left = 0; }
+	if (top  < 0) { srcTop  -= top;  top  = 0; }
+
+	const int width { std::min(srcRight  - srcLeft, m_Width  - left) };
+	const int height{ std::min(srcBottom - srcTop,  m_Height - top)  };
+
+	for (int row{}; row < height; ++row)
+	{
+		const uint32_t* srcPtr = image.pixelsPtr + static_cast<size_t>(srcTop + row) * image.width + srcLeft;
+		uint32_t* dstPtr = m_Pixels.data() + static_cast<size_t>(top + row) * m_Width + left;
+
+		for (int column{}; column < width; ++column)
+		{
+			if ((srcPtr[column] & 0x00FFFFFF) != key) dstPtr[column] = srcPtr[column] | 0xFF000000;
+		}
+	}
+}
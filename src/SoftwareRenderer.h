@@ -0,0 +1,87 @@
+//-----------------------------------------------------------------
+// Software Renderer
+// C++ Header - SoftwareRenderer.h - version v8_01
+//
+// Portable rasterizer that implements the RenderBackend interface
+// on a 32 bit framebuffer, used for headless runs and profiling
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "RenderBackend.h"
+
+#include <vector>
+#include <filesystem>
+
+//-----------------------------------------------------------------
+// SoftwareRenderer Class
+//-----------------------------------------------------------------
+class SoftwareRenderer final : public RenderBackend
+{
+public:
+	// Constructor(s) and destructor
+	SoftwareRenderer(int width, int height);
+	virtual ~SoftwareRenderer() override = default;
+
+	// Disabling copy/move constructors and assignment operators
+	SoftwareRenderer(const SoftwareRenderer& other)					= delete;
+	SoftwareRenderer(SoftwareRenderer&& other) noexcept				= delete;
+	SoftwareRenderer& operator=(const SoftwareRenderer& other)		= delete;
+	SoftwareRenderer& operator=(SoftwareRenderer&& other) noexcept	= delete;
+
+	// General Member Functions
+	void			Resize			(int width, int height);
+	bool			SaveToFile		(const std::filesystem::path& filename)			const;	// writes the framebuffer as a 32 bit .bmp
+
+	// RenderBackend Member Functions
+	void			SetColor		(uint32_t colorRef)																		override;
+
+	void			DrawLine		(int x1, int y1, int x2, int y2)														override;
+	void			DrawRect		(int left, int top, int right, int bottom)												override;
+	void			FillRect		(int left, int top, int right, int bottom, int opacity)									override;
+	void			DrawRoundRect	(int left, int top, int right, int bottom, int radius)									override;
+	void			FillRoundRect	(int left, int top, int right, int bottom, int radius)									override;
+	void			DrawOval		(int left, int top, int right, int bottom)												override;
+	void			FillOval		(int left, int top, int right, int bottom, int opacity)									override;
+	void			DrawArc			(int left, int top, int right, int bottom, int startDegree, int angle)					override;
+	void			FillArc			(int left, int top, int right, int bottom, int startDegree, int angle)					override;
+	void			DrawPolygon		(const RenderPoint ptsArr[], int count, bool close)										override;
+	void			FillPolygon		(const RenderPoint ptsArr[], int count)													override;
+
+	void			BlendImage		(const RenderImage& image, int left, int top, int srcLeft, int srcTop, int srcRight, int srcBottom, int opacity)		override;
+	void			KeyedImage		(const RenderImage& image, int left, int top, int srcLeft, int srcTop, int srcRight, int srcBottom, uint32_t colorKey)	override;
+
+	const uint32_t*	GetFramebuffer	()		const	override	{ return m_Pixels.data(); }
+	int				GetWidth		()		const	override	{ return m_Width; }
+	int				GetHeight		()		const	override	{ return m_Height; }
+
+	static uint32_t	ColorRefToPixel	(uint32_t colorRef);
+
+private:
+	// A horizontal run of pixels [x0, x1] on one row, empty when x0 > x1
+	struct Span
+	{
+		int x0{ 1 };
+		int x1{ 0 };
+	};
+
+	// Private Member Functions
+	void			PlotPixel		(int x, int y);
+	void			FillSpan		(int y, int x0, int x1, int opacity);
+	void			FillSpans		(int top, const std::vector<Span>& spans, int opacity);
+	void			OutlineSpans	(int top, const std::vector<Span>& spans);
+	void			PlotLine		(int x1, int y1, int x2, int y2, bool includeLast);
+
+	int				RoundRectSpans	(int left, int top, int right, int bottom, int cornerWidth, int cornerHeight);		// returns the row of the first span, clipped to the framebuffer
+	void			PlotArcSpans	(int left, int top, int right, int bottom, int startDegree, int angle, bool filled);
+
+	// Member Variables
+	std::vector<uint32_t>	m_Pixels		{};
+	std::vector<Span>		m_SpanBuffer	{};		// reused by the shape rasterizers to avoid per call allocations
+	std::vector<float>		m_CrossBuffer	{};		// reused by the polygon scanline fill
+	int						m_Width			{};
+	int						m_Height		{};
+	uint32_t				m_Color			{ 0xFF000000 };
+};
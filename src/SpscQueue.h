@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------
+// SPSC Queue
+// C++ Header - SpscQueue.h - version v8_01
+//
+// Bounded ring that passes values from one producer thread to one
+// consumer thread without locks. Each side owns one index and only
+// reads the other's, kept on separate cache lines so the two threads
+// do not keep stealing the line from each other. A full queue refuses
+// the push, the producer decides what to drop.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+//-----------------------------------------------------------------
+// SpscQueue Class
+//-----------------------------------------------------------------
+template <typename T>
+class SpscQueue final
+{
+public:
+	// Constructor(s) and destructor, the capacity is rounded up to a power of two
+	explicit SpscQueue(size_t capacity)
+	{
+		size_t slotCount{ 2 };
+		while (slotCount < capacity) slotCount *= 2;
+		m_Slots.resize(slotCount);
+		m_Mask = slotCount - 1;
+	}
+	~SpscQueue() = default;
+
+	// Disabling copy/move constructors and assignment operators, the threads hold references to the slots
+	SpscQueue(const SpscQueue& other)					= delete;
+	SpscQueue(SpscQueue&& other) noexcept				= delete;
+	SpscQueue& operator=(const SpscQueue& other)		= delete;
+	SpscQueue& operator=(SpscQueue&& other) noexcept	= delete;
+
+	// Producer side
+	bool		TryPush		(const T& value)
+	{
+		const size_t tail{ m_Tail.load(std::memory_order_relaxed) };
+
+		// the consumer's index is only reloaded when the cached one says the queue is full
+		if (tail - m_CachedHead > m_Mask)
+		{
+			m_CachedHead = m_Head.load(std::memory_order_acquire);
+			if (tail - m_CachedHead > m_Mask) return false;
+		}
+
+		m_Slots[tail & m_Mask] = value;
+		m_Tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side
+	bool		TryPop		(T& value)
+	{
+		const size_t head{ m_Head.load(std::memory_order_relaxed) };
+
+		if (head == m_CachedTail)
+		{
+			m_CachedTail = m_Tail.load(std::memory_order_acquire);
+			if (head == m_CachedTail) return false;
+		}
+
+		value = m_Slots[head & m_Mask];
+		m_Head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Either side, only a snapshot while the other side is running
+	bool		IsEmpty		()		const	{ return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire); }
+	size_t		GetCapacity	()		const	{ return m_Slots.size(); }
+
+private:
+	static const size_t CACHE_LINE_SIZE{ 64 };
+
+	// Member Variables
+	std::vector<T>						m_Slots			{};
+	size_t								m_Mask			{};
+
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t>	m_Head			{};		// next slot to pop, written by the consumer
+	size_t											m_CachedTail	{};		// consumer only
+
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t>	m_Tail			{};		// next slot to push, written by the producer
+	size_t											m_CachedHead	{};		// producer only
+};
@@ -0,0 +1,149 @@
+//-----------------------------------------------------------------
+// Thread Pool
+// C++ Source - ThreadPool.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------
+// ThreadPool Constructor(s) and Destructor
+//-----------------------------------------------------------------
+ThreadPool::ThreadPool(int workerCount)
+{
+	workerCount = std::max(workerCount, 0);
+
+	for (int index{}; index < workerCount; ++index) m_Queues.push_back(std::make_unique<WorkerQueue>());
+	for (int index{}; index < workerCount; ++index) m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, index);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_SleepMutex };
+		m_Stop = true;
+	}
+	m_WakeUp.notify_all();
+
+	for (std::thread& thread : m_Threads) thread.join();
+}
+
+//-----------------------------------------------------------------
+// ThreadPool Member Functions
+//-----------------------------------------------------------------
+int ThreadPool::GetDefaultWorkerCount()
+{
+	return std::max((int)std::thread::hardware_concurrency() - 1, 0);
+}
+
+void ThreadPool::ParallelFor(int taskCount, const std::function<void(int)>& task)
+{
+	if (taskCount <= 0) return;
+
+	if (m_Threads.empty() || taskCount == 1)
+	{
+		// the same contract as with workers: every task runs, then the first exception is rethrown
+		std::exception_ptr error{};
+		for (int index{}; index < taskCount; ++index)
+		{
+			try
+			{
+				task(index);
+			}
+			catch (...)
+			{
+				if (!error) error = std::current_exception();
+			}
+		}
+		if (error) std::rethrow_exception(error);
+		return;
+	}
+
+	// deal the jobs out round robin, uneven jobs get evened out by the stealing
+	Batch batch{};
+	batch.taskPtr = &task;
+	batch.remaining.store(taskCount, std::memory_order_relaxed);
+	for (int index{}; index < taskCount; ++index)
+	{
+		WorkerQueue& queue = *m_Queues[index % m_Queues.size()];
+		std::lock_guard<std::mutex> lock{ queue.mutex };
+		queue.jobs.push_back(Job{ &batch, index });
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{ m_SleepMutex };
+		m_QueuedJobs += taskCount;
+	}
+	m_WakeUp.notify_all();
+
+	// the calling thread steals until the queues are empty, then waits for the jobs still running
+	int nextQueue{};
+	while (batch.remaining.load(std::memory_order_acquire) > 0)
+	{
+		if (!RunJob(nextQueue, false)) std::this_thread::yield();
+		nextQueue = (nextQueue + 1) % (int)m_Queues.size();
+	}
+
+	if (batch.error) std::rethrow_exception(batch.error);
+}
+
+void ThreadPool::WorkerLoop(int workerIndex)
+{
+	for (;;)
+	{
+		if (RunJob(workerIndex, true)) continue;
+
+		std::unique_lock<std::mutex> lock{ m_SleepMutex };
+		m_WakeUp.wait(lock, [this] { return m_Stop || m_QueuedJobs.load() > 0; });
+		if (m_Stop && m_QueuedJobs.load() == 0) return;
+	}
+}
+
+bool ThreadPool::RunJob(int firstQueue, bool fromFront)
+{
+	const int queueCount{ (int)m_Queues.size() };
+
+	for (int offset{}; offset < queueCount; ++offset)
+	{
+		WorkerQueue& queue = *m_Queues[(firstQueue + offset) % queueCount];
+
+		Job job{};
+		{
+			std::lock_guard<std::mutex> lock{ queue.mutex };
+			if (queue.jobs.empty()) continue;
+
+			// a worker works through its own queue in order, thieves take from the other end
+			if (fromFront && offset == 0)
+			{
+				job = queue.jobs.front();
+				queue.jobs.pop_front();
+			}
+			else
+			{
+				job = queue.jobs.back();
+				queue.jobs.pop_back();
+			}
+		}
+		--m_QueuedJobs;
+
+		// a throwing task still counts as done, or the calling thread would wait for it forever
+		Batch& batch = *job.batchPtr;
+		try
+		{
+			(*batch.taskPtr)(job.index);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock{ batch.errorMutex };
+			if (!batch.error) batch.error = std::current_exception();
+		}
+		batch.remaining.fetch_sub(1, std::memory_order_release);
+		return true;
+	}
+
+	return false;
+}
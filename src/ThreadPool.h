@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------
+// Thread Pool
+// C++ Header - ThreadPool.h - version v8_01
+//
+// Fixed set of worker threads with one job queue each. A worker takes
+// jobs from the front of its own queue and steals from the back of the
+// others when it runs dry, the thread that submits helps out as well.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------
+// ThreadPool Class
+//-----------------------------------------------------------------
+class ThreadPool final
+{
+public:
+	// Constructor(s) and destructor
+	explicit ThreadPool(int workerCount);		// 0 workers runs every job on the calling thread
+	~ThreadPool();
+
+	// Disabling copy/move constructors and assignment operators
+	ThreadPool(const ThreadPool& other)					= delete;
+	ThreadPool(ThreadPool&& other) noexcept				= delete;
+	ThreadPool& operator=(const ThreadPool& other)		= delete;
+	ThreadPool& operator=(ThreadPool&& other) noexcept	= delete;
+
+	// General Member Functions
+	// Runs task(0) .. task(taskCount - 1) and returns when all are done,
+	// an exception thrown by a task is rethrown here once every task has finished
+	void		ParallelFor			(int taskCount, const std::function<void(int)>& task);
+
+	int			GetWorkerCount		()		const	{ return (int)m_Threads.size(); }
+	int			GetThreadCount		()		const	{ return GetWorkerCount() + 1; }		// the workers plus the calling thread
+
+	static int	GetDefaultWorkerCount();		// one per hardware thread next to the game thread
+
+private:
+	// One ParallelFor call, lives on the stack of the calling thread
+	struct Batch
+	{
+		const std::function<void(int)>*	taskPtr			{};
+		std::atomic<int>				remaining		{};
+		std::mutex						errorMutex		{};
+		std::exception_ptr				error			{};		// the first exception a task threw, guarded by errorMutex
+	};
+
+	struct Job
+	{
+		Batch*							batchPtr		{};
+		int								index			{};
+	};
+
+	struct WorkerQueue
+	{
+		std::mutex			mutex	{};
+		std::deque<Job>		jobs	{};
+	};
+
+	// Private Member Functions
+	void		WorkerLoop			(int workerIndex);
+	bool		RunJob				(int firstQueue, bool fromFront);	// takes one job from the first non empty queue, starting at firstQueue
+
+	// Member Variables
+	std::vector<std::unique_ptr<WorkerQueue>>	m_Queues		{};
+	std::vector<std::thread>					m_Threads		{};
+
+	std::mutex									m_SleepMutex	{};
+	std::condition_variable						m_WakeUp		{};
+	std::atomic<int>							m_QueuedJobs	{};
+	bool										m_Stop			{};		// guarded by m_SleepMutex
+};
@@ -0,0 +1,227 @@
+//-----------------------------------------------------------------
+// Timer Wheel
+// C++ Source - TimerWheel.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "TimerWheel.h"
+
+//-----------------------------------------------------------------
+// TimerWheel::Entry Member Functions
+//-----------------------------------------------------------------
+TimerWheel::Entry::~Entry()
+{
+	Cancel();
+	WaitForAsyncCalls();
+}
+
+void TimerWheel::Entry::Cancel()
+{
+	if (m_WheelPtr != nullptr) m_WheelPtr->Cancel(this);
+}
+
+void TimerWheel::Entry::WaitForAsyncCalls()
+{
+	// the worker touches nothing of the entry after the decrement, so spinning on it is safe where a wait/notify pair is not
+	while (m_PendingCalls.load(std::memory_order_acquire) > 0) std::this_thread::yield();
+}
+
+//-----------------------------------------------------------------
+// TimerWheel Constructor(s) and Destructor
+//-----------------------------------------------------------------
+TimerWheel::TimerWheel()
+{
+	// nothing to create, the slots link to themselves and the worker starts with the first async entry
+}
+
+TimerWheel::~TimerWheel()
+{
+	// the worker drains the queue before it stops, nobody waiting in WaitForAsyncCalls is left hanging
+	if (m_AsyncThread.joinable())
+	{
+		m_StopAsync.store(true, std::memory_order_release);
+		m_AsyncSignal.fetch_add(1, std::memory_order_release);
+		m_AsyncSignal.notify_one();
+		m_AsyncThread.join();
+	}
+
+	// entries that outlive the wheel are left unscheduled
+	for (int level{}; level < LEVEL_COUNT; ++level)
+	{
+		for (Link& slot : m_Slots[level])
+		{
+			while (!slot.IsEmpty())
+			{
+				Entry* entryPtr = static_cast<Entry*>(slot.nextPtr);
+				Unlink(entryPtr);
+				entryPtr->m_WheelPtr = nullptr;
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------
+// TimerWheel Member Functions
+//-----------------------------------------------------------------
+void TimerWheel::Schedule(Entry* entryPtr, uint32_t delayMs)
+{
+	Cancel(entryPtr);
+
+	entryPtr->m_WheelPtr	= this;
+	entryPtr->m_ExpiryTick	= m_Now + (delayMs > 0 ? delayMs : 1);
+	++m_ScheduledCount;
+	Insert(entryPtr);
+}
+
+void TimerWheel::Cancel(Entry* entryPtr)
+{
+	if (entryPtr->m_WheelPtr != this) return;
+
+	Unlink(entryPtr);
+	entryPtr->m_WheelPtr = nullptr;
+	--m_ScheduledCount;
+}
+
+void TimerWheel::Advance(double seconds)
+{
+	m_Remainder += seconds * 1000.0;
+	if (m_Remainder < 1.0) return;
+
+	const uint64_t tickCount{ static_cast<uint64_t>(m_Remainder) };
+	m_Remainder -= static_cast<double>(tickCount);
+
+	bool hasPosted{};
+	for (uint64_t tick{}; tick < tickCount; ++tick)
+	{
+		// with nothing scheduled the rest of the time passes in one step
+		if (m_ScheduledCount == 0)
+		{
+			m_Now += tickCount - tick;
+			break;
+		}
+
+		++m_Now;
+
+		// a coarser slot comes round when the finer index wraps, its entries move down before this tick expires
+		int cascadeLevel{};
+		while (cascadeLevel < LEVEL_COUNT - 1 && ((m_Now >> (SLOT_BITS * cascadeLevel)) & SLOT_MASK) == 0) ++cascadeLevel;
+		for (int level{ cascadeLevel }; level > 0; --level) Cascade(level);
+
+		Link& slot = m_Slots[0][m_Now & SLOT_MASK];
+		if (slot.IsEmpty()) continue;
+
+		// moved to a list of its own, so entries that are rescheduled or cancelled meanwhile do not disturb the loop
+		Link dueList{};
+		dueList.nextPtr				= slot.nextPtr;
+		dueList.prevPtr				= slot.prevPtr;
+		dueList.nextPtr->prevPtr	= &dueList;
+		dueList.prevPtr->nextPtr	= &dueList;
+		slot.nextPtr = slot.prevPtr	= &slot;
+
+		while (!dueList.IsEmpty())
+		{
+			Entry* entryPtr = static_cast<Entry*>(dueList.nextPtr);
+			Unlink(entryPtr);
+
+			hasPosted |= entryPtr->m_IsAsync;
+			Expire(entryPtr);
+		}
+	}
+
+	// one wake up for everything this advance posted
+	if (hasPosted)
+	{
+		m_AsyncSignal.fetch_add(1, std::memory_order_release);
+		m_AsyncSignal.notify_one();
+	}
+}
+
+void TimerWheel::Insert(Entry* entryPtr)
+{
+	// the finest level whose range holds the delay, level 0 slots are single ms
+	const uint64_t delta{ entryPtr->m_ExpiryTick - m_Now };
+	int level{};
+	while (level < LEVEL_COUNT - 1 && (delta >> (SLOT_BITS * (level + 1))) != 0) ++level;
+
+	// appended, entries that expire in the same ms run in the order they reached the slot
+	Link& slot = m_Slots[level][(entryPtr->m_ExpiryTick >> (SLOT_BITS * level)) & SLOT_MASK];
+	Link* linkPtr = entryPtr;
+	linkPtr->prevPtr		= slot.prevPtr;
+	linkPtr->nextPtr		= &slot;
+	slot.prevPtr->nextPtr	= linkPtr;
+	slot.prevPtr			= linkPtr;
+}
+
+void TimerWheel::Unlink(Entry* entryPtr)
+{
+	Link* linkPtr = entryPtr;
+	linkPtr->prevPtr->nextPtr	= linkPtr->nextPtr;
+	linkPtr->nextPtr->prevPtr	= linkPtr->prevPtr;
+	linkPtr->prevPtr = linkPtr->nextPtr = linkPtr;
+}
+
+void TimerWheel::Cascade(int level)
+{
+	Link& slot = m_Slots[level][(m_Now >> (SLOT_BITS * level)) & SLOT_MASK];
+
+	// every entry of the slot is due within the range of the level below now
+	while (!slot.IsEmpty())
+	{
+		Entry* entryPtr = static_cast<Entry*>(slot.nextPtr);
+		Unlink(entryPtr);
+		Insert(entryPtr);
+	}
+}
+
+void TimerWheel::Expire(Entry* entryPtr)
+{
+	// rescheduled before it runs, so OnExpire may stop, restart or delete the entry
+	if (entryPtr->m_PeriodMs > 0)
+	{
+		entryPtr->m_ExpiryTick += entryPtr->m_PeriodMs;
+		Insert(entryPtr);
+	}
+	else
+	{
+		entryPtr->m_WheelPtr = nullptr;
+		--m_ScheduledCount;
+	}
+
+	if (entryPtr->m_IsAsync) Post(entryPtr);
+	else entryPtr->OnExpire();
+}
+
+void TimerWheel::Post(Entry* entryPtr)
+{
+	if (!m_AsyncThread.joinable()) m_AsyncThread = std::thread{ &TimerWheel::AsyncLoop, this };
+
+	// an entry whose previous expiries are still queued is posted again, the worker runs them one after the other
+	entryPtr->m_PendingCalls.fetch_add(1, std::memory_order_relaxed);
+	if (!m_AsyncQueue.TryPush(entryPtr))
+	{
+		entryPtr->m_PendingCalls.fetch_sub(1, std::memory_order_relaxed);
+		++m_DroppedAsyncCount;
+	}
+}
+
+void TimerWheel::AsyncLoop()
+{
+	while (true)
+	{
+		// read before draining, a post that lands after the drain changes it and the wait returns at once
+		const uint32_t signal{ m_AsyncSignal.load(std::memory_order_acquire) };
+
+		Entry* entryPtr{};
+		while (m_AsyncQueue.TryPop(entryPtr))
+		{
+			entryPtr->OnExpire();
+			entryPtr->m_PendingCalls.fetch_sub(1, std::memory_order_release);
+		}
+
+		if (m_StopAsync.load(std::memory_order_acquire)) return;
+
+		m_AsyncSignal.wait(signal, std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,126 @@
+//-----------------------------------------------------------------
+// Timer Wheel
+// C++ Header - TimerWheel.h - version v8_01
+//
+// Hierarchical timing wheel with 1 ms resolution, advanced from the
+// game loop. Four levels of 256 slots cover 2^32 ms: an entry goes in
+// the slot of the finest level its delay fits and moves down a level
+// when the coarser slot comes round, so starting, stopping and firing
+// an entry are O(1) and a tick only looks at one slot. Entries expire
+// on the thread that calls Advance, async entries are handed to a
+// worker thread through a lock-free queue instead.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include "SpscQueue.h"
+
+//-----------------------------------------------------------------
+// TimerWheel Class
+//-----------------------------------------------------------------
+class TimerWheel final
+{
+	// Slot lists are circular with the slot itself as the sentinel
+	struct Link
+	{
+		Link*		prevPtr		{ this };
+		Link*		nextPtr		{ this };
+
+		bool		IsEmpty		()		const	{ return nextPtr == this; }
+	};
+
+public:
+	//-------------------------------------------------------------
+	// Something that can be scheduled, OnExpire runs when it is due
+	//-------------------------------------------------------------
+	class Entry : private Link
+	{
+	public:
+		// Disabling copy/move constructors and assignment operators, the wheel links the entries
+		Entry(const Entry& other)					= delete;
+		Entry(Entry&& other) noexcept				= delete;
+		Entry& operator=(const Entry& other)		= delete;
+		Entry& operator=(Entry&& other) noexcept	= delete;
+
+		bool		IsScheduled		()		const	{ return m_WheelPtr != nullptr; }
+		bool		IsAsync			()		const	{ return m_IsAsync; }
+
+	protected:
+		Entry()				= default;
+		virtual ~Entry();
+
+		// Repeats every periodMs after expiring, 0 expires once
+		void		SetPeriod		(uint32_t periodMs)		{ m_PeriodMs = periodMs; }
+		// OnExpire runs on the wheel's worker thread instead of the thread that advances the wheel
+		void		SetAsync		(bool isAsync)			{ m_IsAsync = isAsync; }
+
+		void		Cancel			();
+
+		// A derived class calls this first in its destructor, OnExpire must not run on a half destroyed object
+		void		WaitForAsyncCalls	();
+
+		virtual void	OnExpire	() = 0;
+
+	private:
+		friend class TimerWheel;
+
+		TimerWheel*				m_WheelPtr		{};		// set while scheduled
+		uint64_t				m_ExpiryTick	{};
+		uint32_t				m_PeriodMs		{};
+		bool					m_IsAsync		{};
+		std::atomic<int>		m_PendingCalls	{};		// async expiries queued or running
+	};
+
+	// Constructor(s) and destructor
+	TimerWheel();
+	~TimerWheel();
+
+	// Disabling copy/move constructors and assignment operators, the entries point to the wheel
+	TimerWheel(const TimerWheel& other)					= delete;
+	TimerWheel(TimerWheel&& other) noexcept				= delete;
+	TimerWheel& operator=(const TimerWheel& other)		= delete;
+	TimerWheel& operator=(TimerWheel&& other) noexcept	= delete;
+
+	// General Member Functions, on the thread that advances the wheel
+	void		Schedule		(Entry* entryPtr, uint32_t delayMs);	// starts over when already scheduled, at least 1 ms
+	void		Cancel			(Entry* entryPtr);
+	void		Advance			(double seconds);						// expires everything that came due
+
+	uint64_t	GetTime			()		const	{ return m_Now; }		// ms advanced in total
+	size_t		GetScheduledCount	()	const	{ return m_ScheduledCount; }
+	uint64_t	GetDroppedAsyncCount()	const	{ return m_DroppedAsyncCount; }
+
+private:
+	static const int		LEVEL_COUNT		{ 4 };
+	static const int		SLOT_BITS		{ 8 };
+	static const uint64_t	SLOT_COUNT		{ 1 << SLOT_BITS };
+	static const uint64_t	SLOT_MASK		{ SLOT_COUNT - 1 };
+	static const size_t		ASYNC_CAPACITY	{ 1 << 16 };
+
+	// Private Member Functions
+	void		Insert			(Entry* entryPtr);
+	static void	Unlink			(Entry* entryPtr);
+	void		Cascade			(int level);
+	void		Expire			(Entry* entryPtr);
+	void		Post			(Entry* entryPtr);
+	void		AsyncLoop		();
+
+	// Member Variables
+	Link						m_Slots[LEVEL_COUNT][SLOT_COUNT]	{};
+	uint64_t					m_Now				{};
+	double						m_Remainder			{};		// ms not advanced yet
+	size_t						m_ScheduledCount	{};
+
+	// Async entries, the advancing thread produces and the worker consumes
+	SpscQueue<Entry*>			m_AsyncQueue		{ ASYNC_CAPACITY };
+	std::thread					m_AsyncThread		{};
+	std::atomic<uint32_t>		m_AsyncSignal		{};		// bumped to wake the worker
+	std::atomic<bool>			m_StopAsync			{};
+	uint64_t					m_DroppedAsyncCount	{};		// expiries lost to a full queue
+};
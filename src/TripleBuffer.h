@@ -0,0 +1,64 @@
+//-----------------------------------------------------------------
+// Triple Buffer
+// C++ Header - TripleBuffer.h - version v8_01
+//
+// Hands whole values from one producer thread to one consumer thread
+// without locks. The producer fills the back slot and publishes it,
+// the consumer picks up the newest published slot whenever it wants.
+// Neither side ever waits for the other, frames the consumer did not
+// get to are overwritten.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <atomic>
+#include <cstdint>
+
+//-----------------------------------------------------------------
+// TripleBuffer Class
+//-----------------------------------------------------------------
+template <typename T>
+class TripleBuffer final
+{
+public:
+	// Constructor(s) and destructor
+	TripleBuffer()	= default;
+	~TripleBuffer()	= default;
+
+	// Disabling copy/move constructors and assignment operators, the threads hold references to the slots
+	TripleBuffer(const TripleBuffer& other)					= delete;
+	TripleBuffer(TripleBuffer&& other) noexcept				= delete;
+	TripleBuffer& operator=(const TripleBuffer& other)		= delete;
+	TripleBuffer& operator=(TripleBuffer&& other) noexcept	= delete;
+
+	// Producer side: fill GetBack, then Publish swaps it with the middle slot
+	T&			GetBack		()			{ return m_Slots[m_BackIndex]; }
+	void		Publish		()
+	{
+		const uint8_t oldMiddle{ m_Middle.exchange(uint8_t(m_BackIndex | NEW_BIT), std::memory_order_acq_rel) };
+		m_BackIndex = oldMiddle & INDEX_MASK;
+	}
+
+	// Consumer side: Acquire swaps the front slot with the middle one when that holds a newer value
+	bool		Acquire		()
+	{
+		if ((m_Middle.load(std::memory_order_relaxed) & NEW_BIT) == 0) return false;
+
+		const uint8_t oldMiddle{ m_Middle.exchange(uint8_t(m_FrontIndex), std::memory_order_acq_rel) };
+		m_FrontIndex = oldMiddle & INDEX_MASK;
+		return true;
+	}
+	T&			GetFront	()			{ return m_Slots[m_FrontIndex]; }
+
+private:
+	static const uint8_t INDEX_MASK	{ 0x3 };
+	static const uint8_t NEW_BIT	{ 0x4 };		// the middle slot was published and not acquired yet
+
+	// Member Variables
+	T						m_Slots[3]		{};
+	uint8_t					m_BackIndex		{ 0 };		// producer only
+	uint8_t					m_FrontIndex	{ 1 };		// consumer only
+	std::atomic<uint8_t>	m_Middle		{ 2 };
+};
@@ -8,10 +8,13 @@
 class UtilsBindings{
 public:
     static void SetTitle(const tstring& title){GAME_ENGINE->SetTitle(title);}
-	static void SetWindowPosition(Vector2f pos){
+	static void SetWindowPosition(const Vector2f& pos){
         GAME_ENGINE->SetWindowPosition(static_cast<int>(pos.x),static_cast<int>(pos.y));
     }
 	static void SetFrameRate(int frameRate){GAME_ENGINE->SetFrameRate(frameRate);}
+	static void SetFixedTimestep(int tickRate){GAME_ENGINE->SetFixedTimestep(tickRate);}
+	static void SetMaxCatchUpTicks(int maxTicks){GAME_ENGINE->SetMaxCatchUpTicks(maxTicks);}
+	static void SetThreaded(bool enable){GAME_ENGINE->SetThreaded(enable);}
 	static void SetWidth(int width){GAME_ENGINE->SetWidth(width);}
 	static void SetHeight(int height){GAME_ENGINE->SetHeight(height);}
     static bool GoFullscreen(){return GAME_ENGINE->GoFullscreen();}		
@@ -25,12 +28,35 @@ public:
     static int GetHeight(){return GAME_ENGINE->GetHeight();}
     static int GetFrameRate(){return GAME_ENGINE->GetFrameRate();}
     static int GetFrameDelay(){return GAME_ENGINE->GetFrameDelay();}
+    static bool IsThreaded(){return GAME_ENGINE->IsThreaded();}
+    static int GetTickRate(){return GAME_ENGINE->GetTickRate();}
+    static double GetDeltaTime(){return GAME_ENGINE->GetDeltaTime();}
+    static double GetFrameTime(){return GAME_ENGINE->GetFrameTime();}
+    static double GetInterpolationAlpha(){return GAME_ENGINE->GetInterpolationAlpha();}
+    // { frames = ..., mean = ..., stdDev = ..., min = ..., max = ..., late = ... } over the last few seconds, times in ms
+    static sol::table GetFrameStats(sol::this_state luaState){
+        const FramePacer::JitterStats stats{ GAME_ENGINE->GetFrameStats() };
+        return sol::state_view{ luaState }.create_table_with(
+            "frames", stats.frameCount, "mean", stats.meanMs, "stdDev", stats.stdDevMs,
+            "min", stats.minMs, "max", stats.maxMs, "late", stats.lateFrames);
+    }
+    static void ResetFrameStats(){GAME_ENGINE->ResetFrameStats();}
+    // Seconds on the performance counter, only differences between two calls mean anything
+    static double GetTime(){
+        static const double secondsPerTick{ [] { LARGE_INTEGER frequency{}; QueryPerformanceFrequency(&frequency); return 1.0 / frequency.QuadPart; }() };
+        LARGE_INTEGER tick{};
+        QueryPerformanceCounter(&tick);
+        return tick.QuadPart * secondsPerTick;
+    }
     static void CreateBindings(sol::state& state){
         state.new_usertype<UtilsBindings>(
             "Utils",
             "SetTitle", &UtilsBindings::SetTitle,
             "SetWindowPos", &UtilsBindings::SetWindowPosition,
             "SetFrameRate", &UtilsBindings::SetFrameRate,
+            "SetFixedTimestep", &UtilsBindings::SetFixedTimestep,
+            "SetMaxCatchUpTicks", &UtilsBindings::SetMaxCatchUpTicks,
+            "SetThreaded", &UtilsBindings::SetThreaded,
             "SetWidth", &UtilsBindings::SetWidth,
             "SetHeight", &UtilsBindings::SetHeight,
             "GoFullscreen", &UtilsBindings::GoFullscreen,
@@ -44,6 +70,14 @@ public:
             "GetHeight", &UtilsBindings::GetHeight,
             "GetFrameRate", &UtilsBindings::GetFrameRate,
             "GetFrameDelay", &UtilsBindings::GetFrameDelay,
+            "IsThreaded", &UtilsBindings::IsThreaded,
+            "GetTickRate", &UtilsBindings::GetTickRate,
+            "GetDeltaTime", &UtilsBindings::GetDeltaTime,
+            "GetFrameTime", &UtilsBindings::GetFrameTime,
+            "GetInterpolationAlpha", &UtilsBindings::GetInterpolationAlpha,
+            "GetFrameStats", &UtilsBindings::GetFrameStats,
+            "ResetFrameStats", &UtilsBindings::ResetFrameStats,
+            "GetTime", &UtilsBindings::GetTime,
             "CreateBindings", &UtilsBindings::CreateBindings
         );
     }
@@ -8,7 +8,12 @@ struct Vector2{
     T y{};
     Vector2(){}
     Vector2(T x, T y) : x{x}, y{y} {}
-    double DistSq(Vector2 other){
+    // Lets a script keep a few vectors around and refill them instead of making new userdata every call
+    void Set(T newX, T newY){
+        x = newX;
+        y = newY;
+    }
+    double DistSq(const Vector2& other) const {
         T subX = std::abs(x-other.x);
         T subY = std::abs(y-other.y);
         return subX * subX + subY * subY;
@@ -23,6 +28,7 @@ struct Vector2{
             "x", &Vector2<T>::x,
             "y", &Vector2<T>::y,
             "print", &Vector2<T>::Print,
+            "Set", &Vector2<T>::Set,
             "DistSq", &Vector2<T>::DistSq
 	    );
     }
@@ -0,0 +1,98 @@
+--measures how fast Lua can call into the Draw bindings
+--run with: --script lua/BindingBenchmark.lua (add --headless 3 to run it without a window)
+deltaTime = 0
+local BackGroundColor = Color.new(10, 10, 10)
+local DrawColor = Color.new(200, 100, 100)
+local callCount = 200000
+local hasRun = false
+
+function Init()
+    Utils.SetFrameRate(60)
+    Utils.SetHeight(256)
+    Utils.SetWidth(256)
+end
+
+function Start()
+end
+
+function End()
+end
+
+function Update(deltaT)
+    deltaTime = deltaT
+end
+
+-- times callCount calls of drawCall, and how much garbage they leave behind
+local function Measure(name, drawCall)
+    collectgarbage("collect")
+    collectgarbage("stop")
+    local memoryBefore = collectgarbage("count")
+    local startTime = Utils.GetTime()
+
+    for i = 1, callCount do
+        drawCall(i)
+    end
+
+    local seconds = Utils.GetTime() - startTime
+    local garbageKB = collectgarbage("count") - memoryBefore
+    collectgarbage("restart")
+
+    local callsPerSecond = callCount / seconds
+    callsPerSecond = callsPerSecond - callsPerSecond % 1
+    garbageKB = garbageKB - garbageKB % 1
+    print(name .. ": " .. callsPerSecond .. " calls per second, " .. garbageKB .. " KB garbage")
+end
+
+local function RunBenchmark()
+    print("Draw binding benchmark, " .. callCount .. " one pixel FillRect calls per run")
+
+    Measure("new Vector2f per call", function(i)
+        Draw.FillRect(Vector2f.new(i % 8, 0), Vector2f.new(i % 8 + 1, 1), 255)
+    end)
+
+    local p1 = Vector2f.new()
+    local p2 = Vector2f.new()
+    Measure("reused Vector2f", function(i)
+        p1:Set(i % 8, 0)
+        p2:Set(i % 8 + 1, 1)
+        Draw.FillRect(p1, p2, 255)
+    end)
+
+    Measure("FillRectXY", function(i)
+        Draw.FillRectXY(i % 8, 0, i % 8 + 1, 1, 255)
+    end)
+
+    -- the same rects from a buffer in one call, counted as callCount calls
+    local rects = FloatBuffer.new(callCount * 4)
+    for i = 1, callCount do
+        rects:Push(i % 8, 0, i % 8 + 1, 1)
+    end
+    local isDrawn = false
+    Measure("FillRects from a FloatBuffer", function(i)
+        if not isDrawn then
+            isDrawn = true
+            Draw.FillRects(rects)
+        end
+    end)
+end
+
+function DrawFunc()
+    Draw.FillWindowRect(BackGroundColor) -- clear display
+    Draw.SetColor(DrawColor)
+    if not hasRun then
+        hasRun = true
+        RunBenchmark()
+    end
+end
+
+function MouseButtonAction(isLeft, isDown, pos)
+end
+
+function MouseWheelAction(pos, amount)
+end
+
+function MouseMove(pos)
+end
+
+function CheckKeyboard()
+end
@@ -1,64 +1,84 @@
 deltaTime = 0
-local updateCountdown = 0
-local maxUpdateCountDown = 0.3
+local stepDelay = 0.3
+local stepTask
 local BackGroundColor = Color.new(10, 10, 10)
 local gridLineColor = Color.new(100, 100, 100)
 local successColor = Color.new(200,100,100)
 local grid
 local gridSize = 100
+local useHashLife = false -- HashLife has no edges, patterns keep going past the visible board
 local cellSize = 10
 local buttonUpColor = Color.new(128, 128, 128)
 local buttonDownColor = Color.new(80,80,80)
 local buttonPos = { x = 10, y = 10, size = 100 }
 local isRunning = false
+local cellRects = FloatBuffer.new()
+local gridLines = FloatBuffer.new()
 
 function Init()
     Utils.SetFrameRate(60)
     Utils.SetTitle("Conway's game of life")
     Utils.SetHeight(gridSize * cellSize)
     Utils.SetWidth(gridSize * cellSize)
-    grid = {}
-    for i = 1, gridSize do
-        grid[i] = {}
-        for j = 1, gridSize do
-            --grid[i][j] = math.random(0,1)
-            grid[i][j] = 0
-        end
+    Draw.SetBuffered(true)
+    Draw.SetDamageTracking(true)
+    -- both have the same grid interface, the HashLife shows a gridSize x gridSize window of its plane
+    if useHashLife then
+        grid = HashLife.new(gridSize, gridSize)
+    else
+        grid = LifeGrid.new(gridSize, gridSize)
     end
+    grid:SetSparse(true)
+    BuildGridLines()
 end
 
 function Start()
     print("Game of Life started")
-    updateCountdown = maxUpdateCountDown
+    stepTask = Engine.spawn(StepWhileRunning)
 end
 
 function End()
 end
 
+-- saving this file reloads it into the running game, the locals of the old version are handed over here
+function GetReloadState()
+    return { grid = grid, isRunning = isRunning, stepTask = stepTask }
+end
+
+function OnReload(saved)
+    grid = saved.grid
+    isRunning = saved.isRunning
+    -- the old task still sees the old locals
+    if saved.stepTask then Engine.cancel(saved.stepTask) end
+    stepTask = Engine.spawn(StepWhileRunning)
+    BuildGridLines()
+end
+
+-- a task, sleeps between the steps instead of counting down in Update
+function StepWhileRunning()
+    while true do
+        wait(stepDelay)
+        if isRunning then
+            UpdateGrid()
+        end
+    end
+end
+
 function Update(deltaT)
     deltaTime = deltaT
-    if updateCountdown < 0.0 then
-        UpdateGrid()
-        updateCountdown = maxUpdateCountDown
-    elseif isRunning then
-        updateCountdown = updateCountdown - deltaTime
-    end
+    -- anything not invalidated this frame keeps its pixels
+    Draw.SetFrameUnchanged()
 end
 
 function DrawFunc()
     Draw.FillWindowRect(BackGroundColor) -- clear display
     Draw.SetColor(successColor)
-    for i = 1, gridSize do
-        for j = 1, gridSize do  
-            if grid[i][j] == 1 then
-                
-                local p1 = Vector2f.new((i - 1) * cellSize, (j - 1) * cellSize)
-                local p2 = Vector2f.new(i * cellSize, j * cellSize)
-                Draw.FillRect(p1, p2, 255)
-            end
-        end
-    end
-    DrawGridLines()
+    cellRects:Clear()
+    grid:GetCellRects(cellRects, cellSize)
+    Draw.FillRects(cellRects)
+
+    Draw.SetColor(gridLineColor)
+    Draw.DrawLines(gridLines)
     
     -- Draw the button
     if isRunning then
@@ -66,10 +86,7 @@ function DrawFunc()
     else 
         Draw.SetColor(buttonUpColor)
     end
-    local p1 = Vector2f.new(buttonPos.x, buttonPos.y)
-    local p2 = Vector2f.new(buttonPos.x + buttonPos.size, buttonPos.y + buttonPos.size)
-    
-    Draw.FillRect(p1, p2, 255)
+    Draw.FillRectXY(buttonPos.x, buttonPos.y, buttonPos.x + buttonPos.size, buttonPos.y + buttonPos.size, 255)
     
 end
 
@@ -81,13 +98,15 @@ function MouseButtonAction(isLeft, isDown, pos)
            pos.y >= buttonPos.y and pos.y <= buttonPos.y + buttonPos.size then
             isRunning = not isRunning
             print("Game " .. (isRunning and "started" or "paused"))
+            Draw.InvalidateXY(buttonPos.x, buttonPos.y, buttonPos.x + buttonPos.size, buttonPos.y + buttonPos.size)
            elseif not isRunning then
             local gridX = (pos.x / cellSize) + 1
             local gridY = (pos.y / cellSize) + 1
             gridX = gridX - (gridX%1)
             gridY = gridY - (gridY%1)
             if gridX > 0 and gridX <= gridSize and gridY > 0 and gridY <= gridSize then
-                grid[gridX][gridY] = 1 - grid[gridX][gridY]
+                grid:Toggle(gridX - 1, gridY - 1)
+                InvalidateCells(gridX - 1, gridY - 1, gridX, gridY)
             end
         end
     end
@@ -103,57 +122,23 @@ function CheckKeyboard()
 end
 
 function UpdateGrid()
-    local newGrid = {}
-    for i = 1, gridSize do
-        newGrid[i] = {}
-        for j = 1, gridSize do
-            local aliveNeighbors = CountAliveNeighbors(i, j)
-            if grid[i][j] == 1 then
-                if aliveNeighbors < 2 or aliveNeighbors > 3 then
-                    newGrid[i][j] = 0
-                else
-                    newGrid[i][j] = 1
-                end
-            else
-                if aliveNeighbors == 3 then
-                    newGrid[i][j] = 1
-                else
-                    newGrid[i][j] = 0
-                end
-            end
-        end
+    grid:Step()
+    local rects = grid:GetChangedTiles()
+    for k = 1, #rects, 4 do
+        InvalidateCells(rects[k], rects[k + 1], rects[k + 2], rects[k + 3])
     end
-    grid = newGrid
 end
 
-function CountAliveNeighbors(x, y)
-    local count = 0
-    for i = -1, 1 do
-        for j = -1, 1 do
-            if not (i == 0 and j == 0) then
-                local ni = x + i
-                local nj = y + j
-                if ni > 0 and ni <= gridSize and nj > 0 and nj <= gridSize then
-                    count = count + grid[ni][nj]
-                end
-            end
-        end
-    end
-    return count
+-- cell rectangle in 0 based grid coordinates, right and bottom exclusive
+function InvalidateCells(left, top, right, bottom)
+    Draw.InvalidateXY(left * cellSize, top * cellSize, right * cellSize + 1, bottom * cellSize + 1)
 end
 
-function DrawGridLines()
-    Draw.SetColor(gridLineColor) -- Set grid line color
+-- the grid never changes, so its lines are built once and drawn with a single call
+function BuildGridLines()
+    local size = gridSize * cellSize
     for i = 0, gridSize do
-        local x = i * cellSize
-        local y1 = 0
-        local y2 = gridSize * cellSize
-        Draw.DrawLine(Vector2f.new(x, y1), Vector2f.new(x, y2))
+        gridLines:Push(i * cellSize, 0, i * cellSize, size)
+        gridLines:Push(0, i * cellSize, size, i * cellSize)
     end
-    for j = 0, gridSize do
-        local y = j * cellSize
-        local x1 = 0
-        local x2 = gridSize * cellSize
-        Draw.DrawLine(Vector2f.new(x1, y), Vector2f.new(x2, y))
-    end
-end
\ No newline at end of file
+end
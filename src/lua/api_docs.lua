@@ -23,6 +23,34 @@ Color = {}
 ---@return Color Color Constructed color
 function Color.new(r, g, b) end
 
+---array of numbers kept on the C++ side, filled once and handed to the bulk Draw calls
+---indices are 1 based like a Lua array
+---@class FloatBuffer
+FloatBuffer = {}
+
+---make a new, empty buffer
+---@param capacity? integer number of values to reserve room for
+---@return FloatBuffer buffer
+function FloatBuffer.new(capacity) end
+
+---removes all values, the memory is kept for the next fill
+function FloatBuffer:Clear() end
+
+---appends all given values
+---@param ... number
+function FloatBuffer:Push(...) end
+
+---@param index integer
+---@return number value 0 outside the buffer
+function FloatBuffer:Get(index) end
+
+---@param index integer at most one past the last value
+---@param value number
+function FloatBuffer:Set(index, value) end
+
+---@return integer size number of values
+function FloatBuffer:GetSize() end
+
 ---basic vector container
 ---@class Vector2f
 ---@field x number x component
@@ -40,6 +68,202 @@ function Vector2f.new(x, y) end
 ---@return number DistanceSquared the squared distance between this and other
 function Vector2f.DistSq(other) end
 
+---overwrite both components, reusing a vector avoids making a new one for every draw call
+---@param x number x component
+---@param y number y component
+function Vector2f:Set(x, y) end
+
+---Game of Life board stored natively, one bit per cell
+---cells outside the board are dead, coordinates are 0 based
+---boards step on all engine threads, with the same result as on one thread
+---@class LifeGrid
+LifeGrid = {}
+
+---make a new board with all cells dead
+---@param width integer number of columns
+---@param height integer number of rows
+---@return LifeGrid grid Constructed board
+function LifeGrid.new(width, height) end
+
+---@param x integer column
+---@param y integer row
+---@return boolean alive false for cells outside the board
+function LifeGrid:Get(x, y) end
+
+---@param x integer column
+---@param y integer row
+---@param alive boolean
+function LifeGrid:Set(x, y, alive) end
+
+---flips a cell between dead and alive
+---@param x integer column
+---@param y integer row
+function LifeGrid:Toggle(x, y) end
+
+---kills every cell and resets the generation count
+function LifeGrid:Clear() end
+
+---fills the board with random cells
+---@param density number chance of a cell being alive, 0 to 1
+---@param seed integer seed for the random generator
+function LifeGrid:Randomize(density, seed) end
+
+---advances the board
+---@param generations? integer number of generations, 1 when left out
+function LifeGrid:Step(generations) end
+
+---@return integer width
+function LifeGrid:GetWidth() end
+
+---@return integer height
+function LifeGrid:GetHeight() end
+
+---@return integer generation generations stepped since the last Clear or Randomize
+function LifeGrid:GetGeneration() end
+
+---@return integer population number of alive cells
+function LifeGrid:GetPopulation() end
+
+---steps a random size x size board with every stepping kernel the CPU supports
+---each entry is { name = "Scalar"|"SWAR"|"AVX2", cellsPerSecond = number, matches = boolean }
+---matches is false when a kernel ended on a different board than the scalar one
+---@param size integer board width and height
+---@param generations integer generations per kernel
+---@return table results from the slowest to the fastest kernel
+function LifeGrid.Benchmark(size, generations) end
+
+---steps a random size x size board on 1 up to all engine threads
+---each entry is { threads = integer, cellsPerSecond = number, matches = boolean }
+---matches is false when the board differs from the single threaded run
+---@param size integer board width and height
+---@param generations integer generations per thread count
+---@return table results from 1 thread to the engine's thread count
+function LifeGrid.BenchmarkThreads(size, generations) end
+
+---only evaluate the 64 x 64 tiles that changed in the last step and the tiles around them
+---still lifes and dead space then cost nothing, off by default
+---@param isSparse boolean
+function LifeGrid:SetSparse(isSparse) end
+
+---@return boolean isSparse
+function LifeGrid:IsSparse() end
+
+---@return integer count tiles the last sparse step evaluated
+function LifeGrid:GetActiveTileCount() end
+
+---cells rectangles of the tiles that changed in the last step, or were edited since
+---flat list: left1, top1, right1, bottom1, left2, ... with right and bottom exclusive
+---@return integer[] rects
+function LifeGrid:GetChangedTiles() end
+
+---appends a rect for every horizontal run of alive cells, ready for Draw.FillRects
+---@param buffer FloatBuffer receives left, top, right, bottom per run
+---@param cellSize number size of a cell in pixels
+function LifeGrid:GetCellRects(buffer, cellSize) end
+
+---dense against sparse stepping on a size x size board with a glider gun per 1024 x 1024 block
+---each entry is { name = "Dense"|"Sparse", cellsPerSecond = number, matches = boolean }
+---@param size integer board width and height
+---@param generations integer generations per mode
+---@return table results
+function LifeGrid.BenchmarkSparse(size, generations) end
+
+---Game of Life on an unbounded plane, same cell interface as LifeGrid
+---identical regions are stored once and their future is remembered,
+---so big jumps of generations are cheap on patterns with structure
+---@class HashLife
+HashLife = {}
+
+---make a new plane with all cells dead
+---with a size it stands in for a LifeGrid of that size: the viewport is set to (0, 0, width, height)
+---@param width? integer viewport width
+---@param height? integer viewport height
+---@return HashLife life
+function HashLife.new(width, height) end
+
+---@param x integer column, may be negative
+---@param y integer row, may be negative
+---@return boolean alive
+function HashLife:Get(x, y) end
+
+---@param x integer column, may be negative
+---@param y integer row, may be negative
+---@param alive boolean
+function HashLife:Set(x, y, alive) end
+
+---flips a cell between dead and alive
+---@param x integer column
+---@param y integer row
+function HashLife:Toggle(x, y) end
+
+---kills every cell and resets the generation count
+function HashLife:Clear() end
+
+---advances any number of generations, done as power of two jumps
+---@param generations? integer number of generations, 1 when left out
+---@return boolean stepped false when the pattern reached the edge of the 64 bit plane and stopped
+function HashLife:Step(generations) end
+
+---advances 2^log2Generations generations in one jump
+---@param log2Generations integer
+---@return boolean stepped false when the pattern reached the edge of the 64 bit plane and stayed as it was
+function HashLife:StepPow2(log2Generations) end
+
+---@return integer generation
+function HashLife:GetGeneration() end
+
+---@return integer population number of alive cells, known without visiting them
+function HashLife:GetPopulation() end
+
+---smallest rectangle holding every alive cell, inclusive
+---@return boolean hasCells false when everything is dead
+---@return integer left
+---@return integer top
+---@return integer right
+---@return integer bottom
+function HashLife:GetBoundingBox() end
+
+---limits the memory, unused nodes are collected before a jump once there are more
+---@param maxNodes integer default 4000000, roughly 200 bytes each
+function HashLife:SetMaxNodes(maxNodes) end
+
+---@return integer nodeCount nodes currently stored
+function HashLife:GetNodeCount() end
+
+---the window of the plane that GetWidth, GetHeight, GetCellRects and GetChangedTiles refer to
+---@param left integer
+---@param top integer
+---@param width integer
+---@param height integer
+function HashLife:SetViewport(left, top, width, height) end
+
+---@return integer width viewport width
+function HashLife:GetWidth() end
+
+---@return integer height viewport height
+function HashLife:GetHeight() end
+
+---accepted for the LifeGrid interface, a HashLife only ever works on the regions that change
+---@param isSparse boolean
+function HashLife:SetSparse(isSparse) end
+
+---@return boolean isSparse always true
+function HashLife:IsSparse() end
+
+---cell rectangles of the 64 x 64 tiles in the viewport that changed in the last step, or were edited since
+---relative to the viewport's top left, flat list: left1, top1, right1, bottom1, left2, ... with right and bottom exclusive
+---@return integer[] rects
+function HashLife:GetChangedTiles() end
+
+---appends a rect for every horizontal run of alive cells in the viewport, ready for Draw.FillRects
+---relative to the viewport's top left
+---@param buffer FloatBuffer receives left, top, right, bottom per run
+---@param cellSize number size of a cell in pixels
+function HashLife:GetCellRects(buffer, cellSize) end
+
+---frees every node the current pattern does not use
+function HashLife:CollectGarbage() end
+
 --- a ref to a bitmap object doesnt actually hold data
 --- @class Bitmap
 Bitmap = {}
@@ -161,6 +385,64 @@ function Draw.DrawString(text, p) end
 ---@return boolean succeeded
 function Draw.DrawStretchedString(text, p1,p2) end
 
+--the XY versions take plain numbers, they make no Vector2f so they leave no garbage behind
+
+---@param x1 integer
+---@param y1 integer
+---@param x2 integer
+---@param y2 integer
+---@return boolean succeeded
+function Draw.DrawLineXY(x1, y1, x2, y2) end
+
+---@param left integer
+---@param top integer
+---@param right integer
+---@param bottom integer
+---@return boolean succeeded
+function Draw.DrawRectXY(left, top, right, bottom) end
+
+---@param left integer
+---@param top integer
+---@param right integer
+---@param bottom integer
+---@param opacity integer how much the rect is filled
+---@return boolean succeeded
+function Draw.FillRectXY(left, top, right, bottom, opacity) end
+
+---@param left integer
+---@param top integer
+---@param right integer
+---@param bottom integer
+---@return boolean succeeded
+function Draw.DrawOvalXY(left, top, right, bottom) end
+
+---@param left integer
+---@param top integer
+---@param right integer
+---@param bottom integer
+---@param opacity integer how much the oval is filled
+---@return boolean succeeded
+function Draw.FillOvalXY(left, top, right, bottom, opacity) end
+
+---@param text string what you will be printing
+---@param left integer
+---@param top integer
+---@return boolean succeeded
+function Draw.DrawStringXY(text, left, top) end
+
+---draws many lines in one call
+---@param coords FloatBuffer|number[] x1, y1, x2, y2 per line
+---@param count? integer number of lines, all of them when left out
+---@return boolean succeeded
+function Draw.DrawLines(coords, count) end
+
+---fills many rects in one call
+---@param coords FloatBuffer|number[] left, top, right, bottom per rect
+---@param count? integer number of rects, all of them when left out
+---@param opacity? integer how much the rects are filled, 255 when left out
+---@return boolean succeeded
+function Draw.FillRects(coords, count, opacity) end
+
 ---return the current used color
 ---@return Color
 function Draw.GetDrawColor() end
@@ -168,6 +450,49 @@ function Draw.GetDrawColor() end
 ---Redraw the screen (should be in the beginning of your draw, doesnt happen in very specific situations)
 function Draw.Redraw() end
 
+---record the following draw calls and submit them in batches at the end of the frame
+---text, bitmaps and polygons are still drawn right away, after everything recorded before them
+---@param enable boolean
+function Draw.SetBuffered(enable) end
+
+---get the pen/brush cache statistics, every SetColor is one lookup
+---@return integer hits
+---@return integer misses
+function Draw.GetCacheStats() end
+
+---damage tracking, when on a frame only redraws what the script invalidated
+---frames without Invalidate or SetFrameUnchanged calls are still drawn in full
+---@param enable boolean
+function Draw.SetDamageTracking(enable) end
+
+---marks an area that has to be redrawn in the next frame,
+---draw calls completely outside the invalidated areas are skipped
+---@param p1 Vector2f one corner
+---@param p2 Vector2f the opposite corner
+function Draw.Invalidate(p1, p2) end
+
+---Invalidate with plain numbers
+---@param left integer
+---@param top integer
+---@param right integer
+---@param bottom integer
+function Draw.InvalidateXY(left, top, right, bottom) end
+
+---the next frame is drawn in full
+function Draw.InvalidateAll() end
+
+---nothing changed, the next frame is not drawn at all unless something gets invalidated
+function Draw.SetFrameUnchanged() end
+
+---while drawing: false when the area lies completely outside the invalidated areas
+---@param p1 Vector2f one corner
+---@param p2 Vector2f the opposite corner
+---@return boolean needsRedraw
+function Draw.NeedsRedraw(p1, p2) end
+
+---@return integer skippedFrames frames that were not drawn because nothing changed
+function Draw.GetSkippedFrames() end
+
 ---Draw a bitmap at a given position and scale
 ---@param bitmap Bitmap
 ---@param pos Vector2f
@@ -190,6 +515,21 @@ function Utils.SetWindowPosition(pos) end
 ---@param frameRate integer The frame rate to set.
 function Utils.SetFrameRate(frameRate) end
 
+---Run Update at a fixed rate of game time, independent of the frame rate.
+---Frames are painted in between ticks, DrawFunc gets how far (0 to 1) as its argument.
+---@param tickRate integer ticks per second, 0 goes back to one Update per frame with the measured frame time
+function Utils.SetFixedTimestep(tickRate) end
+
+---Most ticks run for one frame, a game that falls further behind slows down instead of stalling.
+---@param maxTicks integer 5 by default
+function Utils.SetMaxCatchUpTicks(maxTicks) end
+
+---Run the game on its own thread, only takes effect when called in Init.
+---Update, DrawFunc and the mouse callbacks then run there while the window thread shows the
+---newest finished frame. Polygons are not drawn in this mode, bitmaps have to stay alive while shown.
+---@param enable boolean
+function Utils.SetThreaded(enable) end
+
 ---Set the width of the game window.
 ---@param width integer The width to set.
 function Utils.SetWidth(width) end
@@ -241,3 +581,211 @@ function Utils.GetFrameRate() end
 ---Get the frame delay of the game.
 ---@return integer
 function Utils.GetFrameDelay() end
+
+---@return boolean threaded the game runs on its own thread, see Utils.SetThreaded
+function Utils.IsThreaded() end
+
+---@return integer tickRate the fixed timestep rate, 0 when Update runs once per frame
+function Utils.GetTickRate() end
+
+---@return number seconds the game time the current Update covers
+function Utils.GetDeltaTime() end
+
+---@return number seconds measured between the last two frames
+function Utils.GetFrameTime() end
+
+---@return number alpha where the painted frame lies between the last tick (0) and the next (1)
+function Utils.GetInterpolationAlpha() end
+
+---Frame time statistics over the last 240 frames, the frames are paced by sleeping between them
+---@return { frames: integer, mean: number, stdDev: number, min: number, max: number, late: integer } stats times in milliseconds, late frames took over 1.5 frame periods
+function Utils.GetFrameStats() end
+
+---Start the frame time statistics over
+function Utils.ResetFrameStats() end
+
+---high resolution clock, only the difference between two calls means anything
+---@return number seconds
+function Utils.GetTime() end
+
+--frame profiler
+--- Static object with the engine's frame timing and draw call counts
+---@class Profiler
+Profiler = {}
+
+---@alias PhaseStats { p50: number, p99: number, max: number, mean: number }
+
+---Times of every frame phase over the last 240 frames, in milliseconds.
+---The phases are frame (the whole frame), pump (window messages), update (ticks, timers and mouse callbacks), draw,
+---flush (drawing the buffered draw calls), present (copying to the window), checkKeyboard and monitorKeyboard.
+---A phase that runs inside another one, like a paint while handling a message, only counts for the inner phase.
+---@return { frames: integer, frame: PhaseStats, pump: PhaseStats, update: PhaseStats, draw: PhaseStats, flush: PhaseStats, present: PhaseStats, checkKeyboard: PhaseStats, monitorKeyboard: PhaseStats }
+function Profiler.GetStats() end
+
+---Draw calls the last frame made, per kind: line, rect, fillRect, roundRect, fillRoundRect, oval,
+---fillOval, arc, fillArc, polygon, fillPolygon, string and bitmap, plus the total
+---@return table<string, integer>
+function Profiler.GetDrawCalls() end
+
+---Show the profiler numbers in the top left corner of every frame
+---@param show boolean
+function Profiler.SetOverlay(show) end
+
+---@return boolean
+function Profiler.IsOverlayShown() end
+
+---Start the statistics over
+function Profiler.Reset() end
+
+--input events
+--- Static object with the input the window got since the previous tick, in the order it came in.
+--- Runs of mouse moves are merged into their last one. MouseButtonAction, MouseWheelAction and MouseMove
+--- are called with the same events at the start of the tick, a script can use either.
+---@class Input
+Input = {}
+
+---@alias InputEvent { type: "MouseMove"|"MouseButton"|"MouseWheel"|"KeyDown"|"KeyUp"|"FocusGained"|"FocusLost", x: integer?, y: integer?, isLeft: boolean?, isDown: boolean?, distance: integer?, key: integer?, isRepeat: boolean? }
+
+---All events of this tick. x and y for the mouse events, isLeft and isDown for MouseButton,
+---distance for MouseWheel (120 per notch), key (virtual key code) for KeyDown and KeyUp, isRepeat for KeyDown.
+---@return InputEvent[] events
+function Input.GetEvents() end
+
+---Iterator over the events of this tick: for event in Input.PollEvents() do ... end
+---@return fun(): InputEvent|nil
+function Input.PollEvents() end
+
+---@return integer count events lost because the game fell thousands of events behind
+function Input.GetDroppedCount() end
+
+--Lua sampling profiler
+--- Static object for the sampling profiler of the script, F9 in the game window starts and stops it as well,
+--- stopping it with F9 prints the profile and writes lua_profile.folded
+---@class LuaProfiler
+LuaProfiler = {}
+
+---Start taking samples of the Lua call stack while the engine runs the script, costs nothing while stopped
+---@param intervalMs number|nil time between samples, 1 by default, the system timer resolution may make it longer
+function LuaProfiler.Start(intervalMs) end
+
+function LuaProfiler.Stop() end
+
+---@return boolean
+function LuaProfiler.IsRunning() end
+
+---Throw away the samples taken so far
+function LuaProfiler.Reset() end
+
+---@return integer
+function LuaProfiler.GetSampleCount() end
+
+---Flat profile, most self samples first. Self counts the samples the function was running in,
+---total the samples it was anywhere on the call stack.
+---@return { name: string, self: integer, total: integer }[]
+function LuaProfiler.GetProfile() end
+
+---Write the samples as collapsed stacks, one "outer;inner count" line per stack, for flamegraph.pl or speedscope
+---@param filename string
+---@return boolean succeeded
+function LuaProfiler.Save(filename) end
+
+---Print the flat profile to the console
+---@param maxFunctions integer|nil 20 by default
+function LuaProfiler.Print(maxFunctions) end
+
+--Lua memory
+--- Static object with the statistics of the pooled allocator behind the Lua state and the garbage collector mode
+---@class Memory
+Memory = {}
+
+---Bytes as Lua requested them, blocks up to 512 bytes come from per size pools.
+---classes holds one entry per pool size, peak is the most blocks that were in use at once.
+---@return { inUse: integer, peak: integer, largeInUse: integer, largePeak: integer, pooledAllocations: integer, largeAllocations: integer, mallocCalls: integer, slabBytes: integer, classes: { size: integer, inUse: integer, peak: integer, allocations: integer, slabs: integer }[] }
+function Memory.GetStats() end
+
+---Print the statistics per pool size to the console
+function Memory.PrintReport() end
+
+---Start the high-water marks over from the current use
+function Memory.ResetPeaks() end
+
+---Switch the garbage collector to generational mode, which suits many short lived tables.
+---0 or nil keeps the current value of a parameter.
+---@param minorMultiplier integer|nil percent the memory may grow between minor collections
+---@param majorMultiplier integer|nil percent the memory may grow before a major collection
+function Memory.SetGenerationalGC(minorMultiplier, majorMultiplier) end
+
+---Switch the garbage collector to incremental mode, the Lua default.
+---0 or nil keeps the current value of a parameter.
+---@param pause integer|nil percent the memory may grow before a new cycle starts
+---@param stepMultiplier integer|nil how much work each step does
+---@param stepSize integer|nil log2 of the bytes allocated between steps
+function Memory.SetIncrementalGC(pause, stepMultiplier, stepSize) end
+
+--hot reload
+--- Saving the game script runs it again in the running game. A build watches the script in src/lua, not the copy next to
+--- the executable, and copies it over that copy before the reload. Saving another script does not reload anything.
+--- Init and Start are not called again. Globals survive the reload, locals of the old version do not,
+--- so the old version can hand them to the new one. A script with errors is reported and the game keeps running the old version.
+
+---Optional, called on the old version of the script right before the reload
+---@return any state passed to OnReload
+function GetReloadState() end
+
+---Optional, called on the new version of the script right after the reload
+---@param state any what GetReloadState returned, nil when there is no GetReloadState
+function OnReload(state) end
+
+--script callbacks
+--- Static object with the statistics of the global functions the engine calls: Init, Update, DrawFunc, Start, End,
+--- MouseButtonAction, MouseWheelAction, MouseMove and CheckKeyboard.
+--- An error in one of them is printed, at most once a second per function, and the game keeps running.
+---@class Callbacks
+Callbacks = {}
+
+---Keyed by function name, bound is false when the script does not define it. Times in ms,
+---they only cover the calls made while Callbacks.SetTiming is on, meanMs is over those calls.
+---@return table<string, { bound: boolean, calls: integer, errors: integer, totalMs: number, meanMs: number, maxMs: number }>
+function Callbacks.GetStats() end
+
+---Start the call counts and times over
+function Callbacks.ResetStats() end
+
+---Time every call from now on, off by default since it reads the clock twice per call
+---@param isTiming boolean
+function Callbacks.SetTiming(isTiming) end
+
+---@return boolean isTiming
+function Callbacks.IsTiming() end
+
+--tasks
+--- Functions that run over several ticks. A task runs until it calls one of the wait functions, the
+--- engine resumes it after Update once the wait is over. Sleeping tasks cost nothing while they sleep,
+--- only tasks in waitUntil are checked every tick. An error ends the task and is printed.
+--- Tasks keep running the functions they started with when the script is reloaded.
+---@class Engine
+Engine = {}
+
+---Start a task on the next tick
+---@param fn function the body of the task
+---@param ... any passed to fn
+---@return integer taskId
+function Engine.spawn(fn, ...) end
+
+---Stop a task, a task that cancels itself stops at its next wait
+---@param taskId integer what Engine.spawn returned
+---@return boolean cancelled false when the task already ended
+function Engine.cancel(taskId) end
+
+---Suspend the current task, only in a task started with Engine.spawn
+---@param seconds number game time, the deltaTime of Update added up, negative waits until the next tick, NaN and infinity are an error
+function wait(seconds) end
+
+---Suspend the current task for a number of ticks, only in a task started with Engine.spawn
+---@param frames? integer 1 when left out
+function waitFrames(frames) end
+
+---Suspend the current task until predicate returns true, only in a task started with Engine.spawn
+---The predicate is called once now and then once every tick, it must not wait itself
+---@param predicate fun(): boolean
+function waitUntil(predicate) end
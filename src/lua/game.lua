@@ -14,12 +14,22 @@ end
 function End()
 end
 
+-- optional: saving the script reloads it into the running game without Init and Start,
+-- GetReloadState of the old version returns what OnReload of the new version gets
+function GetReloadState()
+    return {}
+end
+
+function OnReload(saved)
+end
+
 function Update(deltaT)
     deltaTime = deltaT
 
 end
 
-function DrawFunc()
+-- alpha is where this frame lies between two fixed timestep ticks, always 1 without Utils.SetFixedTimestep
+function DrawFunc(alpha)
     Draw.FillWindowRect(BackGroundColor) --clear display
 
 end
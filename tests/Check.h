@@ -0,0 +1,37 @@
+//-----------------------------------------------------------------
+// Check
+// C++ Header - Check.h - version v8_01
+//
+// Minimal assertion helper for the test executables. CHECK prints the
+// failing expression and keeps going, main returns TestResult() so
+// CTest sees a failure when any check failed.
+//-----------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include <cstdio>
+
+inline int& FailedCheckCount()
+{
+	static int failedCount{};
+	return failedCount;
+}
+
+#define CHECK(condition)																\
+	do																					\
+	{																					\
+		if (!(condition))																\
+		{																				\
+			printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);		\
+			++FailedCheckCount();														\
+		}																				\
+	} while (false)
+
+inline int TestResult()
+{
+	if (FailedCheckCount() > 0) printf("%d checks failed\n", FailedCheckCount());
+	else printf("all checks passed\n");
+	return FailedCheckCount() > 0 ? 1 : 0;
+}
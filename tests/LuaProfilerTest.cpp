@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------
+// Lua Profiler Test
+// C++ Source - LuaProfilerTest.cpp - version v8_01
+//
+// Samples a script that spends its time once inside a task of the
+// coroutine scheduler and once in a plain call on the main state.
+// Samples taken while the task runs have to show the task's stack,
+// none may be charged to the call that runs after it.
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "LuaProfiler.h"
+#include "CoroutineScheduler.h"
+#include "Check.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+extern "C"
+{
+#include <lua.h>
+#include <lualib.h>
+#include <lauxlib.h>
+}
+
+//-----------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------
+static const char* g_ScriptPtr = R"(
+local function Spin(seconds)
+	local endTime = os.clock() + seconds
+	local count = 0
+	while os.clock() < endTime do count = count + 1 end
+	return count
+end
+
+function TaskWork() return Spin(0.3) end
+function MainWork() return Spin(0.3) end
+
+function StartTask()
+	Engine.spawn(function() TaskWork() end)
+end
+)";
+
+static bool CallGlobal(lua_State* luaStatePtr, const char* namePtr)
+{
+	lua_getglobal(luaStatePtr, namePtr);
+	if (lua_pcall(luaStatePtr, 0, 0, 0) == LUA_OK) return true;
+
+	printf("%s failed: %s\n", namePtr, lua_tostring(luaStatePtr, -1));
+	lua_pop(luaStatePtr, 1);
+	return false;
+}
+
+//-----------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------
+static void TestTaskSamplesAreChargedToTheTask()
+{
+	lua_State* luaStatePtr = luaL_newstate();
+	luaL_openlibs(luaStatePtr);
+	{
+		LuaProfiler profiler{ luaStatePtr };
+		CoroutineScheduler scheduler{ luaStatePtr, &profiler };
+		CoroutineScheduler::CreateBindings(luaStatePtr, &scheduler);
+
+		CHECK(luaL_loadbuffer(luaStatePtr, g_ScriptPtr, std::strlen(g_ScriptPtr), "=test") == LUA_OK && lua_pcall(luaStatePtr, 0, 0, 0) == LUA_OK);
+
+		// like a frame of the game: Update spawns the task, the scheduler runs it, then more script runs on the main state
+		profiler.Start(1.0);
+		{
+			LuaProfiler::ScriptScope scriptScope{ profiler };
+			CHECK(CallGlobal(luaStatePtr, "StartTask"));
+			scheduler.Tick(0.0);
+			CHECK(CallGlobal(luaStatePtr, "MainWork"));
+		}
+		profiler.Stop();
+		CHECK(scheduler.GetTaskCount() == 0);
+
+		// collapsed stacks, root first: "outer;inner count"
+		CHECK(profiler.SaveCollapsedStacks("LuaProfilerTest.folded"));
+		std::ifstream file{ "LuaProfilerTest.folded" };
+
+		int taskSamples{}, mainSamples{}, mixedSamples{};
+		std::string line{};
+		while (std::getline(file, line))
+		{
+			const size_t countStart{ line.rfind(' ') };
+			if (countStart == std::string::npos) continue;
+
+			const std::string stack{ line.substr(0, countStart) };
+			const int samples{ std::stoi(line.substr(countStart + 1)) };
+			const bool isTask{ stack.find("TaskWork") != std::string::npos };
+			const bool isMain{ stack.find("MainWork") != std::string::npos || stack.find("StartTask") != std::string::npos };
+
+			if (isTask && isMain) mixedSamples += samples;
+			else if (isTask) taskSamples += samples;
+			else if (isMain) mainSamples += samples;
+		}
+		printf("%d samples: %d in the task, %d on the main state\n", profiler.GetSampleCount(), taskSamples, mainSamples);
+
+		// a task stack starts at the task's function, never under the main state call that happened to run next
+		CHECK(mixedSamples == 0);
+		CHECK(taskSamples > 0);
+		CHECK(mainSamples > 0);
+
+		// both spin for the same time, even a coarse system timer gives each a fair share
+		CHECK(taskSamples * 4 > profiler.GetSampleCount());
+		CHECK(mainSamples * 4 > profiler.GetSampleCount());
+	}
+	lua_close(luaStatePtr);
+}
+
+int main()
+{
+	TestTaskSamplesAreChargedToTheTask();
+
+	return TestResult();
+}
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------
+// Pixel Kernels Test
+// C++ Source - PixelKernelsTest.cpp - version v8_01
+//
+// Runs every kernel at every level the CPU supports on randomized
+// buffers and compares the result bit for bit with the Reference
+// version. Counts go from 0 to well past two AVX2 steps, and the
+// buffers start at every offset within a vector, so the vector loops,
+// their tails and unaligned loads all get covered.
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "PixelKernels.h"
+#include "Check.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------
+static std::mt19937 g_Random{ 1234 };
+
+// random pixels with the cases the kernels treat specially mixed in: zero, fully opaque and transparent, the color key
+static std::vector<uint32_t> RandomPixels(size_t count, uint32_t keyPixel)
+{
+	std::vector<uint32_t> pixels(count);
+	for (uint32_t& pixel : pixels)
+	{
+		switch (g_Random() % 8)
+		{
+			case 0:		pixel = 0;													break;
+			case 1:		pixel = g_Random() | 0xFF000000;							break;
+			case 2:		pixel = g_Random() & 0x00FFFFFF;							break;
+			case 3:		pixel = (keyPixel & 0x00FFFFFF) | (g_Random() << 24);		break;
+			default:	pixel = g_Random();											break;
+		}
+	}
+	return pixels;
+}
+
+static const char* LevelName(PixelKernels::Level level)
+{
+	switch (level)
+	{
+		case PixelKernels::Level::AVX2:		return "AVX2";
+		case PixelKernels::Level::SSE2:		return "SSE2";
+		default:							return "Scalar";
+	}
+}
+
+//-----------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------
+static void TestLevel(PixelKernels::Level level)
+{
+	PixelKernels::SetLevel(level);
+	CHECK(PixelKernels::GetLevel() == level);
+
+	const size_t maxOffset{ 8 };
+	int mismatchCount{};
+	for (size_t count{}; count <= 67; ++count)
+	{
+		for (size_t offset{}; offset < maxOffset; ++offset)
+		{
+			const uint32_t keyPixel{ (uint32_t)g_Random() };
+			const uint8_t value{ (uint8_t)(g_Random() % 4 == 0 ? (g_Random() % 2) * 255 : g_Random()) };		// 0 and 255 are edge cases too
+			const uint32_t colorPixel{ (uint32_t)g_Random() };
+
+			const std::vector<uint32_t> dstPixels{ RandomPixels(count + maxOffset, keyPixel) };
+			const std::vector<uint32_t> srcPixels{ RandomPixels(count + maxOffset, keyPixel) };
+
+			// pixels outside [offset, offset + count) must stay untouched, the whole buffers are compared
+			auto compare = [&](auto&& kernel, auto&& reference)
+			{
+				std::vector<uint32_t> expected{ dstPixels };
+				std::vector<uint32_t> actual{ dstPixels };
+				reference(expected.data() + offset);
+				kernel(actual.data() + offset);
+				if (expected != actual) ++mismatchCount;
+			};
+
+			compare([&](uint32_t* dstPtr) { PixelKernels::PremultiplyByOpacity(dstPtr, count, value); },
+					[&](uint32_t* dstPtr) { PixelKernels::Reference::PremultiplyByOpacity(dstPtr, count, value); });
+			compare([&](uint32_t* dstPtr) { PixelKernels::SetAlpha(dstPtr, count, value); },
+					[&](uint32_t* dstPtr) { PixelKernels::Reference::SetAlpha(dstPtr, count, value); });
+			compare([&](uint32_t* dstPtr) { PixelKernels::ColorKeyToZero(dstPtr, srcPixels.data() + offset, count, keyPixel); },
+					[&](uint32_t* dstPtr) { PixelKernels::Reference::ColorKeyToZero(dstPtr, srcPixels.data() + offset, count, keyPixel); });
+			compare([&](uint32_t* dstPtr) { PixelKernels::BlendSourceOver(dstPtr, srcPixels.data() + offset, count); },
+					[&](uint32_t* dstPtr) { PixelKernels::Reference::BlendSourceOver(dstPtr, srcPixels.data() + offset, count); });
+			compare([&](uint32_t* dstPtr) { PixelKernels::BlendColorOver(dstPtr, count, colorPixel); },
+					[&](uint32_t* dstPtr) { PixelKernels::Reference::BlendColorOver(dstPtr, count, colorPixel); });
+		}
+	}
+
+	// one long odd row, the size of a window line
+	const uint32_t keyPixel{ (uint32_t)g_Random() };
+	const std::vector<uint32_t> srcPixels{ RandomPixels(1921, keyPixel) };
+	std::vector<uint32_t> expected{ RandomPixels(1921, keyPixel) };
+	std::vector<uint32_t> actual{ expected };
+	PixelKernels::Reference::BlendSourceOver(expected.data(), srcPixels.data(), expected.size());
+	PixelKernels::BlendSourceOver(actual.data(), srcPixels.data(), actual.size());
+	if (expected != actual) ++mismatchCount;
+
+	if (mismatchCount > 0) std::printf("%s: %d mismatches\n", LevelName(level), mismatchCount);
+	CHECK(mismatchCount == 0);
+}
+
+int main()
+{
+	const PixelKernels::Level supportedLevel{ PixelKernels::GetSupportedLevel() };
+	std::printf("supported level: %s\n", LevelName(supportedLevel));
+
+	for (PixelKernels::Level level : { PixelKernels::Level::Scalar, PixelKernels::Level::SSE2, PixelKernels::Level::AVX2 })
+	{
+		if (level <= supportedLevel) TestLevel(level);
+	}
+
+	return TestResult();
+}
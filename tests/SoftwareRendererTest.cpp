@@ -0,0 +1,234 @@
+//-----------------------------------------------------------------
+// Software Renderer Test
+// C++ Source - SoftwareRendererTest.cpp - version v8_01
+//
+// Headless image diff for the software rasterizer. A fixed scene
+// with every shape, both image blits and partly offscreen shapes is
+// rendered and compared pixel for pixel with reference/Scene.bmp.
+// On a mismatch the rendered image and a diff image (changed pixels
+// in red) are written next to the test executable. Run the test with
+// --update to write a new reference after an intended change.
+//
+// Shapes that stick out of the framebuffer are also rendered inside
+// a larger framebuffer and cropped, both have to match.
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "SoftwareRenderer.h"
+#include "Check.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Helpers
+//-----------------------------------------------------------------
+struct Image
+{
+	std::vector<uint32_t>	pixels	{};
+	int						width	{};
+	int						height	{};
+};
+
+// reads the top-down 32 bit files SoftwareRenderer::SaveToFile writes
+static bool LoadBmp(const std::filesystem::path& filename, Image& image)
+{
+	std::ifstream file(filename, std::ios::binary);
+	if (!file.good()) return false;
+
+	uint8_t header[54]{};
+	if (!file.read(reinterpret_cast<char*>(header), sizeof(header))) return false;
+
+	auto readLE = [&header](int offset) { uint32_t value; std::memcpy(&value, header + offset, sizeof(value)); return value; };
+	if (header[0] != 'B' || header[1] != 'M' || (readLE(28) & 0xFFFF) != 32) return false;
+
+	image.width		= (int)readLE(18);
+	image.height	= -(int)readLE(22);
+	if (image.width <= 0 || image.height <= 0) return false;
+
+	image.pixels.resize((size_t)image.width * image.height);
+	file.seekg(readLE(10));
+	return (bool)file.read(reinterpret_cast<char*>(image.pixels.data()), image.pixels.size() * sizeof(uint32_t));
+}
+
+// same size and pixels, or the number of differing pixels with the diff image written
+static int Compare(const SoftwareRenderer& renderer, const Image& reference, const std::filesystem::path& diffFilename)
+{
+	if (renderer.GetWidth() != reference.width || renderer.GetHeight() != reference.height) return -1;
+
+	SoftwareRenderer diff{ reference.width, reference.height };
+	int diffCount{};
+	for (int y{}; y < reference.height; ++y)
+	{
+		for (int x{}; x < reference.width; ++x)
+		{
+			const size_t index{ (size_t)y * reference.width + x };
+			const bool isSame{ renderer.GetFramebuffer()[index] == reference.pixels[index] };
+			diffCount += !isSame;
+
+			diff.SetColor(isSame ? 0x00404040 : 0x000000FF);
+			diff.FillRect(x, y, x + 1, y + 1, 255);
+		}
+	}
+	if (diffCount > 0) diff.SaveToFile(diffFilename);
+	return diffCount;
+}
+
+// a checkerboard with a transparent hole, premultiplied like the bitmaps the engine loads
+static std::vector<uint32_t> CreateSprite(int size)
+{
+	std::vector<uint32_t> pixels((size_t)size * size);
+	for (int y{}; y < size; ++y)
+	{
+		for (int x{}; x < size; ++x)
+		{
+			const int distanceX{ 2 * x - size + 1 }, distanceY{ 2 * y - size + 1 };
+			const bool isHole{ distanceX * distanceX + distanceY * distanceY < size * size / 4 };
+			pixels[(size_t)y * size + x] = isHole ? 0x00000000 : ((x / 4 + y / 4) % 2 ? 0xFF20A0E0 : 0x80400000);
+		}
+	}
+	return pixels;
+}
+
+static void DrawScene(SoftwareRenderer& renderer, int offsetX, int offsetY)
+{
+	auto color = [&renderer](uint8_t red, uint8_t green, uint8_t blue) { renderer.SetColor(red | (green << 8) | (blue << 16)); };
+	const int x{ offsetX }, y{ offsetY };
+
+	color(30, 30, 40);
+	renderer.FillRect(x, y, x + 128, y + 96, 255);
+
+	color(220, 60, 60);
+	renderer.FillRect(x + 4, y + 4, x + 40, y + 30, 255);
+	color(60, 220, 60);
+	renderer.FillRect(x + 20, y + 16, x + 60, y + 40, 128);
+	color(255, 255, 255);
+	renderer.DrawRect(x + 2, y + 2, x + 62, y + 42);
+
+	color(240, 200, 40);
+	renderer.FillRoundRect(x + 68, y + 4, x + 124, y + 30, 12);
+	color(40, 40, 200);
+	renderer.DrawRoundRect(x + 66, y + 2, x + 126, y + 32, 16);
+
+	color(200, 80, 200);
+	renderer.FillOval(x + 6, y + 48, x + 45, y + 90, 255);
+	color(80, 200, 200);
+	renderer.FillOval(x + 30, y + 50, x + 70, y + 80, 100);
+	color(255, 255, 255);
+	renderer.DrawOval(x + 4, y + 46, x + 47, y + 92);
+
+	color(255, 140, 0);
+	renderer.FillArc(x + 72, y + 40, x + 120, y + 88, 30, 120);
+	color(0, 255, 140);
+	renderer.DrawArc(x + 72, y + 40, x + 120, y + 88, 200, -150);
+
+	const RenderPoint triangle[]{ { x + 50, y + 60 }, { x + 70, y + 94 }, { x + 30, y + 94 } };
+	color(255, 255, 0);
+	renderer.FillPolygon(triangle, 3);
+	const RenderPoint zigzag[]{ { x + 64, y + 36 }, { x + 80, y + 44 }, { x + 96, y + 36 }, { x + 112, y + 44 } };
+	color(255, 0, 255);
+	renderer.DrawPolygon(zigzag, 4, false);
+	color(0, 0, 0);
+	renderer.DrawLine(x + 0, y + 95, x + 127, y + 0);
+
+	static const std::vector<uint32_t> sprite{ CreateSprite(16) };
+	const RenderImage image{ sprite.data(), 16, 16 };
+	renderer.BlendImage(image, x + 100, y + 70, 0, 0, 16, 16, 255);
+	renderer.BlendImage(image, x + 108, y + 78, 0, 0, 16, 16, 96);
+	renderer.KeyedImage(image, x + 84, y + 74, 2, 2, 14, 14, 0x00000000);
+
+	// partly outside of a 128 x 96 framebuffer on every side
+	color(120, 160, 255);
+	renderer.FillOval(x - 20, y - 16, x + 24, y + 20, 200);
+	renderer.DrawRoundRect(x + 100, y - 10, x + 140, y + 20, 14);
+	renderer.FillRoundRect(x + 110, y + 84, x + 150, y + 110, 18);
+	renderer.DrawOval(x - 30, y + 70, x + 20, y + 120);
+	renderer.FillArc(x + 40, y - 30, x + 90, y + 20, 180, 180);
+}
+
+//-----------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------
+static void TestSceneAgainstReference(bool isUpdate)
+{
+	const std::filesystem::path referenceFilename{ std::filesystem::path{ TEST_REFERENCE_DIR } / "Scene.bmp" };
+
+	SoftwareRenderer renderer{ 128, 96 };
+	DrawScene(renderer, 0, 0);
+
+	if (isUpdate)
+	{
+		CHECK(renderer.SaveToFile(referenceFilename));
+		printf("wrote %s\n", referenceFilename.string().c_str());
+		return;
+	}
+
+	Image reference{};
+	CHECK(LoadBmp(referenceFilename, reference));
+
+	const int diffCount{ Compare(renderer, reference, "Scene_diff.bmp") };
+	if (diffCount != 0)
+	{
+		renderer.SaveToFile("Scene_actual.bmp");
+		printf("%d pixels differ from %s, see Scene_actual.bmp and Scene_diff.bmp\n", diffCount, referenceFilename.string().c_str());
+	}
+	CHECK(diffCount == 0);
+}
+
+static void TestClippedMatchesCropped()
+{
+	// the scene once in its own framebuffer and once in the middle of a larger one
+	const int border{ 64 };
+	SoftwareRenderer clipped{ 128, 96 };
+	SoftwareRenderer large{ 128 + 2 * border, 96 + 2 * border };
+	DrawScene(clipped, 0, 0);
+	DrawScene(large, border, border);
+
+	int diffCount{};
+	for (int y{}; y < clipped.GetHeight(); ++y)
+	{
+		for (int x{}; x < clipped.GetWidth(); ++x)
+		{
+			diffCount += clipped.GetFramebuffer()[(size_t)y * clipped.GetWidth() + x] != large.GetFramebuffer()[(size_t)(y + border) * large.GetWidth() + x + border];
+		}
+	}
+	CHECK(diffCount == 0);
+}
+
+static void TestHugeShapes()
+{
+	// a shape far larger than the framebuffer only costs the rows that are visible
+	SoftwareRenderer renderer{ 64, 48 };
+	renderer.SetColor(0x00FFFFFF);
+
+	const auto start = std::chrono::steady_clock::now();
+	renderer.FillOval(-500'000'000, -500'000'000, 500'000'000, 500'000'000, 255);
+	renderer.DrawRoundRect(-400'000'000, -400'000'000, 400'000'000, 400'000'000, 1000);
+	renderer.DrawOval(-400'000'000, 10, 400'000'000, 20);
+	const double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+	bool isFilled{ true };
+	for (int index{}; index < renderer.GetWidth() * renderer.GetHeight(); ++index) isFilled &= renderer.GetFramebuffer()[index] == 0xFFFFFFFF;
+	CHECK(isFilled);
+	CHECK(seconds < 1.0);
+}
+
+int main(int argc, char* argv[])
+{
+	const bool isUpdate{ argc > 1 && std::strcmp(argv[1], "--update") == 0 };
+
+	TestSceneAgainstReference(isUpdate);
+	if (isUpdate) return TestResult();
+
+	TestClippedMatchesCropped();
+	TestHugeShapes();
+
+	return TestResult();
+}
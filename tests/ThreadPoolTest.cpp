@@ -0,0 +1,68 @@
+//-----------------------------------------------------------------
+// Thread Pool Test
+// C++ Source - ThreadPoolTest.cpp - version v8_01
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "ThreadPool.h"
+#include "Check.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------
+static void TestRunsEveryTaskOnce(ThreadPool& pool)
+{
+	std::vector<std::atomic<int>> runCounts(1000);
+	pool.ParallelFor((int)runCounts.size(), [&runCounts](int index) { ++runCounts[index]; });
+
+	bool isEveryTaskRunOnce{ true };
+	for (const std::atomic<int>& runCount : runCounts) isEveryTaskRunOnce &= runCount.load() == 1;
+	CHECK(isEveryTaskRunOnce);
+}
+
+static void TestRethrowsTaskException(ThreadPool& pool)
+{
+	// the throwing task must not leave ParallelFor waiting, and the other tasks still run
+	std::atomic<int> finishedCount{};
+	bool isRethrown{};
+	try
+	{
+		pool.ParallelFor(64, [&finishedCount](int index)
+		{
+			if (index == 17) throw std::runtime_error{ "task 17" };
+			++finishedCount;
+		});
+	}
+	catch (const std::runtime_error& error)
+	{
+		isRethrown = std::string{ error.what() } == "task 17";
+	}
+
+	CHECK(isRethrown);
+	CHECK(finishedCount.load() == 63);
+
+	// the pool is still usable afterwards
+	std::atomic<int> runCount{};
+	pool.ParallelFor(8, [&runCount](int) { ++runCount; });
+	CHECK(runCount.load() == 8);
+}
+
+int main()
+{
+	ThreadPool pool{ 3 };
+	TestRunsEveryTaskOnce(pool);
+	TestRethrowsTaskException(pool);
+
+	// without workers every task runs on the calling thread and the exception passes straight through
+	ThreadPool inlinePool{ 0 };
+	TestRethrowsTaskException(inlinePool);
+
+	return TestResult();
+}
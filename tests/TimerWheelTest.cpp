@@ -0,0 +1,247 @@
+//-----------------------------------------------------------------
+// Timer Wheel Test
+// C++ Source - TimerWheelTest.cpp - version v8_01
+//
+// Schedules entries with delays on every level of the wheel and checks
+// every expiry against the deadline it was scheduled for: nothing early,
+// nothing late, nothing twice, and in deadline order. Entries cancel and
+// delete other entries from inside OnExpire, repeating entries check
+// every period.
+//-----------------------------------------------------------------
+
+//-----------------------------------------------------------------
+// Include Files
+//-----------------------------------------------------------------
+#include "TimerWheel.h"
+#include "Check.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+//-----------------------------------------------------------------
+// TestEntry Class
+//-----------------------------------------------------------------
+struct Expiry
+{
+	int			id		{};
+	uint64_t	time	{};
+};
+
+class TestEntry final : public TimerWheel::Entry
+{
+public:
+	TestEntry(int id, TimerWheel& wheel, std::vector<Expiry>& expiries) : m_Id{ id }, m_Wheel{ wheel }, m_Expiries{ expiries } {}
+	~TestEntry() override { WaitForAsyncCalls(); }
+
+	void		Start			(uint32_t delayMs, uint32_t periodMs)
+	{
+		SetPeriod(periodMs);
+		m_PeriodMs	= periodMs;
+		m_Deadline	= m_Wheel.GetTime() + (delayMs > 0 ? delayMs : 1);
+		m_Wheel.Schedule(this, delayMs);
+	}
+	void		Stop			()				{ Cancel(); }
+
+	uint64_t	GetDeadline		()		const	{ return m_Deadline; }
+	uint32_t	GetPeriod		()		const	{ return m_PeriodMs; }
+
+	// What OnExpire does to another entry, the victim is cancelled or destroyed
+	TestEntry*					victimPtr		{};
+	std::unique_ptr<TestEntry>*	ownedVictimPtr	{};
+
+private:
+	void		OnExpire		() override
+	{
+		// fired late or early
+		CHECK(m_Wheel.GetTime() == m_Deadline);
+		m_Expiries.push_back(Expiry{ m_Id, m_Wheel.GetTime() });
+		if (m_PeriodMs > 0) m_Deadline += m_PeriodMs;
+
+		if (victimPtr != nullptr) victimPtr->Stop();
+		if (ownedVictimPtr != nullptr) ownedVictimPtr->reset();
+		victimPtr		= nullptr;
+		ownedVictimPtr	= nullptr;
+	}
+
+	int						m_Id		{};
+	TimerWheel&				m_Wheel;
+	std::vector<Expiry>&	m_Expiries;
+	uint64_t				m_Deadline	{};
+	uint32_t				m_PeriodMs	{};
+};
+
+//-----------------------------------------------------------------
+// Tests
+//-----------------------------------------------------------------
+static void TestAgainstDeadlines()
+{
+	const int entryCount{ 5000 };
+	const uint64_t endTime{ uint64_t{ 1 } << 25 };		// past the first level 3 cascade at 2^24
+
+	std::mt19937_64 random{ 42 };
+	TimerWheel wheel{};
+	std::vector<Expiry> expiries{};
+	std::vector<std::unique_ptr<TestEntry>> entries{};
+
+	// delays on every level and right at the level boundaries
+	const uint32_t boundaryDelays[]{ 0, 1, 255, 256, 257, 65535, 65536, 65537, (1u << 24) - 1, 1u << 24, (1u << 24) + 1 };
+	std::vector<uint64_t> deadlines(entryCount);
+	std::vector<uint32_t> periods(entryCount);
+	for (int id{}; id < entryCount; ++id)
+	{
+		uint32_t delay{};
+		switch (id % 5)
+		{
+			case 0:		delay = boundaryDelays[(id / 5) % std::size(boundaryDelays)];		break;
+			case 1:		delay = (uint32_t)(random() % 256);									break;
+			case 2:		delay = (uint32_t)(random() % 65536);								break;
+			case 3:		delay = (uint32_t)(random() % (1u << 24));							break;
+			default:	delay = (uint32_t)(random() % (uint64_t{ 1 } << 26));				break;
+		}
+		const uint32_t period{ id % 7 == 0 ? 1 + (uint32_t)(random() % 300000) : 0 };
+
+		entries.push_back(std::make_unique<TestEntry>(id, wheel, expiries));
+		entries.back()->Start(delay, period);
+		deadlines[id]	= entries.back()->GetDeadline();
+		periods[id]		= period;
+	}
+
+	// every 10th entry cancels one victim and deletes another when it fires, victims are taken from the entries that never repeat
+	std::vector<int> cancelledBy(entryCount, -1);
+	std::vector<int> deletedBy(entryCount, -1);
+	for (int id{}; id < entryCount; id += 10)
+	{
+		const int cancelVictim{ (int)(random() % entryCount) };
+		const int deleteVictim{ (int)(random() % entryCount) };
+		if (cancelVictim == id || deleteVictim == id || cancelVictim == deleteVictim) continue;
+		if (periods[cancelVictim] > 0 || periods[deleteVictim] > 0) continue;
+		if (cancelledBy[cancelVictim] >= 0 || deletedBy[deleteVictim] >= 0 || deletedBy[cancelVictim] >= 0 || cancelledBy[deleteVictim] >= 0) continue;
+
+		entries[id]->victimPtr		= entries[cancelVictim].get();
+		entries[id]->ownedVictimPtr	= &entries[deleteVictim];
+		cancelledBy[cancelVictim]	= id;
+		deletedBy[deleteVictim]		= id;
+	}
+	// frame sized steps with the odd long stall
+	while (wheel.GetTime() < endTime)
+	{
+		const double seconds{ random() % 100 == 0 ? (double)(random() % 2000000) / 1000.0 : (double)(random() % 40) / 1000.0 };
+		wheel.Advance(seconds);
+	}
+	const uint64_t now{ wheel.GetTime() };
+
+	// in deadline order
+	bool isInOrder{ true };
+	for (size_t index{ 1 }; index < expiries.size(); ++index) isInOrder &= expiries[index - 1].time <= expiries[index].time;
+	CHECK(isInOrder);
+
+	// where in the log each entry fired
+	std::vector<std::vector<size_t>> firedAt(entryCount);
+	for (size_t index{}; index < expiries.size(); ++index) firedAt[expiries[index].id].push_back(index);
+
+	int wrongCount{};
+	for (int id{}; id < entryCount; ++id)
+	{
+		const std::vector<size_t>& fired = firedAt[id];
+		const int killerId{ cancelledBy[id] >= 0 ? cancelledBy[id] : deletedBy[id] };
+
+		// stopped by another entry: at most once, and only when it came first in the same ms or earlier
+		if (killerId >= 0 && !firedAt[killerId].empty())
+		{
+			const size_t killerIndex{ firedAt[killerId].front() };
+			const bool isValid{ fired.empty() || (fired.size() == 1 && fired.front() < killerIndex) };
+			if (!isValid) ++wrongCount;
+			continue;
+		}
+
+		// on time every period up to now, also when its killer was deleted before it could fire
+		size_t expectedCount{};
+		if (deadlines[id] <= now) expectedCount = periods[id] > 0 ? 1 + (size_t)((now - deadlines[id]) / periods[id]) : 1;
+		if (fired.size() != expectedCount) ++wrongCount;
+	}
+	CHECK(wrongCount == 0);
+
+	// the wheel still holds exactly the entries that are due later
+	size_t scheduledCount{};
+	for (const std::unique_ptr<TestEntry>& entryPtr : entries) scheduledCount += entryPtr && entryPtr->IsScheduled();
+	CHECK(wheel.GetScheduledCount() == scheduledCount);
+}
+
+static void TestRestartFromOnExpire()
+{
+	// an entry that restarts itself while it fires, and one that is stopped by the entry before it in the same ms
+	class RestartEntry final : public TimerWheel::Entry
+	{
+	public:
+		RestartEntry(TimerWheel& wheel) : m_Wheel{ wheel } {}
+		void	Start		(uint32_t delayMs)		{ m_Wheel.Schedule(this, delayMs); }
+		void	Stop		()						{ Cancel(); }
+		int		fireCount	{};
+		RestartEntry*	victimPtr	{};
+	private:
+		void	OnExpire	() override
+		{
+			++fireCount;
+			if (victimPtr != nullptr) victimPtr->Stop();
+			if (fireCount < 3) Start(10);
+		}
+		TimerWheel&	m_Wheel;
+	};
+
+	TimerWheel wheel{};
+	RestartEntry first{ wheel };
+	RestartEntry second{ wheel };
+	first.victimPtr = &second;
+	first.Start(300);
+	second.Start(300);
+
+	for (int step{}; step < 1000; ++step) wheel.Advance(0.001);
+
+	CHECK(first.fireCount == 3);
+	CHECK(second.fireCount == 0);
+	CHECK(wheel.GetScheduledCount() == 0);
+}
+
+static void TestAsyncEntries()
+{
+	class AsyncEntry final : public TimerWheel::Entry
+	{
+	public:
+		AsyncEntry() { SetAsync(true); SetPeriod(5); }
+		~AsyncEntry() override { WaitForAsyncCalls(); }
+		std::atomic<int>	fireCount	{};
+	private:
+		void	OnExpire	() override { ++fireCount; }
+	};
+
+	TimerWheel wheel{};
+	std::vector<std::unique_ptr<AsyncEntry>> entries(100);
+	for (std::unique_ptr<AsyncEntry>& entryPtr : entries)
+	{
+		entryPtr = std::make_unique<AsyncEntry>();
+		wheel.Schedule(entryPtr.get(), 5);
+	}
+
+	// 1 s of 5 ms periods, at most 200 expiries each
+	for (int step{}; step < 100; ++step) wheel.Advance(0.010);
+	entries.resize(50);		// destroying waits for calls still queued
+
+	int fireCount{};
+	for (const std::unique_ptr<AsyncEntry>& entryPtr : entries) fireCount += entryPtr->fireCount.load();
+	CHECK(wheel.GetDroppedAsyncCount() == 0);
+	CHECK(fireCount <= 50 * 200);
+	CHECK(fireCount > 0);
+}
+
+int main()
+{
+	TestAgainstDeadlines();
+	TestRestartFromOnExpire();
+	TestAsyncEntries();
+
+	return TestResult();
+}